@@ -154,6 +154,15 @@ void Signal_receiver::block_for_signal()
 }
 
 
+void Signal_receiver::discard_wakeup()
+{
+	/*
+	 * Signals retrieved via 'pending_signal' are acknowledged at the kernel
+	 * and do not wake up 'block_for_signal' anymore.
+	 */
+}
+
+
 Signal Signal_receiver::pending_signal()
 {
 	Mutex::Guard contexts_guard(_contexts_mutex);
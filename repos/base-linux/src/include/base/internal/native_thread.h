@@ -108,6 +108,52 @@ class Genode::Native_thread
 
 		} epoll { };
 
+		/**
+		 * Socket pair for receiving the replies to the RPC calls of the
+		 * thread
+		 *
+		 * The socket pair is created at the first call and reused for all
+		 * subsequent calls. With each call, the remote end is passed to the
+		 * server.
+		 */
+		class Reply_channel
+		{
+			private:
+
+				/*
+				 * Noncopyable
+				 */
+				Reply_channel(Reply_channel const &);
+				Reply_channel &operator = (Reply_channel const &);
+
+				Lx_sd _local  { -1 };
+				Lx_sd _remote { -1 };
+
+			public:
+
+				Reply_channel() { }
+
+				~Reply_channel() { discard(); }
+
+				/**
+				 * Create socket pair unless already present
+				 */
+				void create();
+
+				Lx_sd local()  const { return _local; }
+				Lx_sd remote() const { return _remote; }
+
+				/**
+				 * Close socket pair
+				 *
+				 * Called if the reply to a call may still arrive, e.g., after
+				 * the call got canceled. Otherwise, the late reply would be
+				 * taken for the reply of the next call.
+				 */
+				void discard();
+
+		} reply_channel { };
+
 		Native_thread() { }
 };
 
@@ -300,23 +300,25 @@ Rpc_exception_code Genode::ipc_call(Native_capability dst,
 	                sizeof(Protocol_header) + snd_msgbuf.data_size());
 
 	/*
-	 * Create reply channel
+	 * Obtain reply channel
 	 *
-	 * The reply channel will be closed when leaving the scope of 'lx_call'.
+	 * Threads reuse their reply channel for all calls. The main thread,
+	 * which lacks a 'Thread' object, uses a reply channel that is closed
+	 * when leaving the scope of 'ipc_call'.
 	 */
-	struct Reply_channel : Lx_socketpair
-	{
-		~Reply_channel()
-		{
-			if (local.value  != -1) lx_close(local.value);
-			if (remote.value != -1) lx_close(remote.value);
-		}
-	} reply_channel;
+	Thread * const myself_ptr = Thread::myself();
+
+	Native_thread::Reply_channel  main_reply_channel;
+	Native_thread::Reply_channel &reply_channel = myself_ptr
+	                                            ? myself_ptr->native_thread().reply_channel
+	                                            : main_reply_channel;
+
+	reply_channel.create();
 
 	/* assemble message */
 
 	/* marshal reply capability */
-	snd_msg.marshal_socket(reply_channel.remote);
+	snd_msg.marshal_socket(reply_channel.remote());
 
 	/* marshal capabilities contained in 'snd_msgbuf' */
 	insert_sds_into_message(snd_msg, snd_header, snd_msgbuf);
@@ -339,11 +341,13 @@ Rpc_exception_code Genode::ipc_call(Native_capability dst,
 	rcv_msg.accept_sockets(Message::MAX_SDS_PER_MSG);
 
 	rcv_msgbuf.reset();
-	int const recv_ret = lx_recvmsg(reply_channel.local, rcv_msg.msg(), 0);
+	int const recv_ret = lx_recvmsg(reply_channel.local(), rcv_msg.msg(), 0);
 
-	/* system call got interrupted by a signal */
-	if (recv_ret == -LX_EINTR)
+	/* system call got interrupted by a signal, the reply may arrive later */
+	if (recv_ret == -LX_EINTR) {
+		reply_channel.discard();
 		throw Genode::Blocking_canceled();
+	}
 
 	if (recv_ret < 0) {
 		error(lx_getpid(), ":", lx_gettid(), " ipc_call failed to receive result (", recv_ret, ")");
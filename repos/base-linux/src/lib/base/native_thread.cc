@@ -72,6 +72,28 @@ void Native_thread::Epoll::_remove(Lx_sd sd)
 }
 
 
+void Native_thread::Reply_channel::create()
+{
+	if (_local.valid())
+		return;
+
+	Lx_socketpair const sockets;
+
+	_local  = sockets.local;
+	_remote = sockets.remote;
+}
+
+
+void Native_thread::Reply_channel::discard()
+{
+	if (_local.valid())  lx_close(_local.value);
+	if (_remote.valid()) lx_close(_remote.value);
+
+	_local  = Lx_sd::invalid();
+	_remote = Lx_sd::invalid();
+}
+
+
 Lx_sd Native_thread::Epoll::poll()
 {
 	for (;;) {
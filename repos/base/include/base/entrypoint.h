@@ -105,6 +105,8 @@ class Genode::Entrypoint : Noncopyable
 		bool          _signal_proxy_delivers_signal { false };
 		Genode::Mutex _block_for_signal_mutex       { };
 
+		unsigned _signal_batch_limit { 1 };
+
 		Io_progress_handler *_io_progress_handler { nullptr };
 
 		void _handle_io_progress()
@@ -227,6 +229,19 @@ class Genode::Entrypoint : Noncopyable
 		 */
 		void schedule_suspend(void (*suspended)(), void (*resumed)());
 
+		/**
+		 * Set maximum number of signals dispatched per wakeup
+		 *
+		 * By default, the entrypoint dispatches one signal per wakeup to
+		 * ensure fairness between RPC requests and signals. A component
+		 * that receives signals from many sources may raise the limit to
+		 * dispatch all signals pending at once in one batch.
+		 */
+		void signal_batch_limit(unsigned limit)
+		{
+			_signal_batch_limit = max(limit, 1u);
+		}
+
 		/**
 		 * Register hook functor to be called after I/O signals are dispatched
 		 */
@@ -0,0 +1,165 @@
+/*
+ * \brief  Pool of entrypoints for serving RPC requests on multiple CPUs
+ * \author Stefan Kalkowski
+ * \date   2022-08-02
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__BASE__ENTRYPOINT_POOL_H_
+#define _INCLUDE__BASE__ENTRYPOINT_POOL_H_
+
+#include <util/noncopyable.h>
+#include <base/allocator.h>
+#include <base/entrypoint.h>
+#include <base/env.h>
+#include <base/mutex.h>
+#include <base/registry.h>
+
+namespace Genode { class Entrypoint_pool; }
+
+
+/**
+ * Pool of entrypoints, each pinned to a distinct CPU
+ *
+ * An entrypoint serializes all RPC requests and signals it dispatches.
+ * Hence, a server that hands out independent sessions to multiple clients
+ * may spread the sessions over the entrypoints of a pool to serve them in
+ * parallel.
+ *
+ * RPC objects and signal handlers that share state not protected otherwise
+ * must be dispatched by one and the same entrypoint. This is expressed by
+ * assigning them to the same 'Domain'. Objects not assigned to any domain
+ * stay at the initial entrypoint of the component, which keeps servers that
+ * are unaware of the pool correct.
+ */
+class Genode::Entrypoint_pool : Noncopyable
+{
+	public:
+
+		class Domain;
+
+	private:
+
+		struct Worker : Noncopyable
+		{
+			Thread::Name const name;
+
+			Entrypoint ep;
+
+			unsigned domains { 0 };
+
+			Worker(Env &env, size_t stack_size, Thread::Name const &name,
+			       Affinity::Location location)
+			:
+				name(name), ep(env, stack_size, name.string(), location)
+			{ }
+
+			virtual ~Worker() { }
+		};
+
+		Allocator &_alloc;
+
+		Mutex                         _mutex   { };
+		Registry<Registered<Worker> > _workers { };
+
+		unsigned _count { 0 };
+
+		/**
+		 * Select worker serving the least number of domains
+		 */
+		Worker &_acquire()
+		{
+			Mutex::Guard guard(_mutex);
+
+			Worker *selected = nullptr;
+			_workers.for_each([&] (Worker &worker) {
+				if (!selected || worker.domains < selected->domains)
+					selected = &worker; });
+
+			selected->domains++;
+			return *selected;
+		}
+
+		void _release(Worker &worker)
+		{
+			Mutex::Guard guard(_mutex);
+			worker.domains--;
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param alloc       allocator used for the entrypoints
+		 * \param count       number of entrypoints, limited to the number of
+		 *                    CPUs of the affinity space of the component
+		 * \param stack_size  stack size of each entrypoint
+		 * \param name        name prefix of the entrypoint threads
+		 */
+		Entrypoint_pool(Env &env, Allocator &alloc, unsigned count,
+		                size_t stack_size, char const *name)
+		:
+			_alloc(alloc)
+		{
+			Affinity::Space const space = env.cpu().affinity_space();
+
+			_count = max(1u, min(count, (unsigned)space.total()));
+
+			for (unsigned i = 0; i < _count; i++)
+				new (alloc)
+					Registered<Worker>(_workers, env, stack_size,
+					                   Thread::Name(name, "_", i),
+					                   space.location_of_index(i));
+		}
+
+		~Entrypoint_pool()
+		{
+			_workers.for_each([&] (Registered<Worker> &worker) {
+				destroy(_alloc, &worker); });
+		}
+
+		/**
+		 * Number of entrypoints of the pool
+		 */
+		unsigned count() const { return _count; }
+};
+
+
+/**
+ * Set of RPC objects and signal handlers dispatched by the same entrypoint
+ *
+ * On construction, the domain is assigned to the entrypoint of the pool
+ * with the least number of domains. All objects of the domain must be
+ * dissolved before the domain is destructed.
+ */
+class Genode::Entrypoint_pool::Domain : Noncopyable
+{
+	private:
+
+		Entrypoint_pool &_pool;
+		Worker          &_worker;
+
+	public:
+
+		Domain(Entrypoint_pool &pool)
+		:
+			_pool(pool), _worker(pool._acquire())
+		{ }
+
+		~Domain() { _pool._release(_worker); }
+
+		/**
+		 * Entrypoint to be used for the RPC objects and signal handlers
+		 * of the domain
+		 */
+		Entrypoint &ep() { return _worker.ep; }
+};
+
+#endif /* _INCLUDE__BASE__ENTRYPOINT_POOL_H_ */
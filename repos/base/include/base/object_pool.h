@@ -7,7 +7,7 @@
  */
 
 /*
- * Copyright (C) 2006-2017 Genode Labs GmbH
+ * Copyright (C) 2006-2022 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -16,10 +16,10 @@
 #ifndef _INCLUDE__BASE__OBJECT_POOL_H_
 #define _INCLUDE__BASE__OBJECT_POOL_H_
 
-#include <util/avl_tree.h>
 #include <util/noncopyable.h>
 #include <base/capability.h>
 #include <base/mutex.h>
+#include <base/semaphore.h>
 #include <base/weak_ptr.h>
 
 namespace Genode { template <typename> class Object_pool; }
@@ -32,19 +32,30 @@ namespace Genode { template <typename> class Object_pool; }
  *
  * The local names of a capabilities are used to differentiate multiple server
  * objects managed by one and the same object pool.
+ *
+ * The entries are hashed by the local names of their capabilities. Lookups
+ * traverse the hash buckets without taking the mutex that serializes the
+ * modifications of the pool. Instead, a lookup registers itself at the
+ * reader counter of the current epoch. After unlinking an entry, 'remove'
+ * advances the epoch and waits until all lookups of the former epoch are
+ * finished. So once 'remove' returns, no lookup refers to the entry anymore.
  */
 template <typename OBJ_TYPE>
 class Genode::Object_pool : Interface, Noncopyable
 {
 	public:
 
-		class Entry : Avl_node<Entry>
+		class Entry
 		{
 			private:
 
 				friend class Object_pool;
-				friend class Avl_tree<Entry>;
-				friend class Avl_node<Entry>;
+
+				/*
+				 * Noncopyable
+				 */
+				Entry(Entry const &);
+				Entry &operator = (Entry const &);
 
 				struct Entry_lock : Weak_object<Entry_lock>, Noncopyable
 				{
@@ -55,8 +66,9 @@ class Genode::Object_pool : Interface, Noncopyable
 						Weak_object<Entry_lock>::lock_for_destruction(); }
 				};
 
-				Untyped_capability _cap  { };
-				Entry_lock         _lock { *this };
+				Untyped_capability _cap       { };
+				Entry_lock         _lock      { *this };
+				Entry             *_pool_next { nullptr };
 
 				inline unsigned long _obj_id() { return _cap.local_name(); }
 
@@ -67,24 +79,6 @@ class Genode::Object_pool : Interface, Noncopyable
 
 				virtual ~Entry() { }
 
-				/**
-				 * Avl_node interface
-				 */
-				bool higher(Entry *e) { return e->_obj_id() > _obj_id(); }
-				void recompute() { }  /* for gcc-3.4 compatibility */
-
-				/**
-				 * Support for object pool
-				 */
-				Entry *find_by_obj_id(unsigned long obj_id)
-				{
-					if (obj_id == _obj_id()) return this;
-
-					Entry *obj = this->child(obj_id > _obj_id());
-
-					return obj ? obj->find_by_obj_id(obj_id) : 0;
-				}
-
 				/**
 				 * Assign capability to object pool entry
 				 */
@@ -95,15 +89,110 @@ class Genode::Object_pool : Interface, Noncopyable
 
 	private:
 
-		Avl_tree<Entry> _tree { };
-		Mutex           _mutex { };
+		enum { BUCKETS_LOG2 = 9, BUCKETS = 1 << BUCKETS_LOG2 };
+
+		Entry        *_buckets[BUCKETS] { };
+		unsigned long _count            { 0 };
+		Mutex         _mutex            { };  /* serializes modifications */
+
+		/*
+		 * State of lock-free lookups
+		 */
+		unsigned  _epoch      { 0 };
+		unsigned  _readers[2] { 0, 0 };
+		bool      _waiting    { false };
+		Semaphore _grace      { };
+
+		static unsigned _index(unsigned long obj_id)
+		{
+			/* Fibonacci hashing */
+			uint64_t const value = obj_id;
+			return (unsigned)((value * 0x9e3779b97f4a7c15ULL) >> (64 - BUCKETS_LOG2));
+		}
+
+		/**
+		 * Register lookup at the reader counter of the current epoch
+		 *
+		 * \return  index of the reader counter, to be passed to '_leave'
+		 */
+		unsigned _enter()
+		{
+			for (;;) {
+				unsigned const epoch = __atomic_load_n(&_epoch, __ATOMIC_SEQ_CST);
+				__atomic_add_fetch(&_readers[epoch & 1], 1, __ATOMIC_SEQ_CST);
+
+				/* the counter must belong to the epoch still */
+				if (__atomic_load_n(&_epoch, __ATOMIC_SEQ_CST) == epoch)
+					return epoch & 1;
+
+				_leave(epoch & 1);
+			}
+		}
+
+		void _leave(unsigned index)
+		{
+			if (__atomic_sub_fetch(&_readers[index], 1, __ATOMIC_SEQ_CST) == 0
+			 && __atomic_load_n(&_waiting, __ATOMIC_SEQ_CST))
+				_grace.up();
+		}
+
+		/**
+		 * Wait until all lookups started before are finished
+		 *
+		 * Must be called with '_mutex' acquired.
+		 */
+		void _synchronize()
+		{
+			unsigned const index = _epoch & 1;
+
+			__atomic_store_n(&_waiting, true, __ATOMIC_SEQ_CST);
+			__atomic_add_fetch(&_epoch, 1, __ATOMIC_SEQ_CST);
+
+			while (__atomic_load_n(&_readers[index], __ATOMIC_SEQ_CST))
+				_grace.down();
+
+			__atomic_store_n(&_waiting, false, __ATOMIC_SEQ_CST);
+
+			/* drop wakeups not consumed by the loop above */
+			while (_grace.try_down());
+		}
+
+		Entry *_lookup(unsigned long obj_id)
+		{
+			Entry *e = __atomic_load_n(&_buckets[_index(obj_id)], __ATOMIC_ACQUIRE);
+			for (; e; e = __atomic_load_n(&e->_pool_next, __ATOMIC_ACQUIRE))
+				if (e->_obj_id() == obj_id)
+					return e;
+
+			return nullptr;
+		}
+
+		/**
+		 * Unlink entry, must be called with '_mutex' acquired
+		 *
+		 * \return  true if the entry was part of the pool
+		 */
+		bool _unlink(Entry &entry)
+		{
+			Entry **link = &_buckets[_index(entry._obj_id())];
+			for (; *link; link = &(*link)->_pool_next) {
+				if (*link != &entry)
+					continue;
+
+				/* lookups in progress may still follow 'entry._pool_next' */
+				__atomic_store_n(link, entry._pool_next, __ATOMIC_RELEASE);
+				_count--;
+				return true;
+			}
+			return false;
+		}
 
 	protected:
 
 		bool empty()
 		{
 			Mutex::Guard lock_guard(_mutex);
-			return _tree.first() == nullptr;
+			return _count == 0;
 		}
 
 	public:
@@ -111,13 +200,21 @@ class Genode::Object_pool : Interface, Noncopyable
 		void insert(OBJ_TYPE *obj)
 		{
 			Mutex::Guard lock_guard(_mutex);
-			_tree.insert(obj);
+
+			Entry &entry = *obj;
+			Entry *&head = _buckets[_index(entry._obj_id())];
+
+			entry._pool_next = head;
+			__atomic_store_n(&head, &entry, __ATOMIC_RELEASE);
+			_count++;
 		}
 
 		void remove(OBJ_TYPE *obj)
 		{
 			Mutex::Guard lock_guard(_mutex);
-			_tree.remove(obj);
+
+			if (_unlink(*obj))
+				_synchronize();
 		}
 
 		template <typename FUNC>
@@ -132,12 +229,13 @@ class Genode::Object_pool : Interface, Noncopyable
 			Weak_ptr ptr;
 
 			{
-				Mutex::Guard lock_guard(_mutex);
+				unsigned const reader = _enter();
 
-				Entry * entry = _tree.first() ?
-					_tree.first()->find_by_obj_id(capid) : nullptr;
+				Entry * entry = _lookup(capid);
 
 				if (entry) ptr = entry->_lock.weak_ptr();
+
+				_leave(reader);
 			}
 
 			{
@@ -162,20 +260,25 @@ class Genode::Object_pool : Interface, Noncopyable
 			using Locked_ptr = Locked_ptr<typename Entry::Entry_lock>;
 
 			for (;;) {
-				OBJ_TYPE * obj;
+				OBJ_TYPE * obj = nullptr;
 
 				{
 					Mutex::Guard lock_guard(_mutex);
 
-					if (!((obj = (OBJ_TYPE*) _tree.first()))) return;
+					for (unsigned i = 0; i < BUCKETS && !obj; i++)
+						obj = static_cast<OBJ_TYPE *>(_buckets[i]);
+
+					if (!obj) return;
 
 					Weak_ptr ptr = obj->_lock.weak_ptr();
 					{
 						Locked_ptr lock_ptr(ptr);
 						if (!lock_ptr.valid()) return;
 
-						_tree.remove(obj);
+						_unlink(*obj);
 					}
+
+					_synchronize();
 				}
 
 				func(obj);
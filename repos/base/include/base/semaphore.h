@@ -105,6 +105,22 @@ class Genode::Semaphore
 			}
 		}
 
+		/**
+		 * Decrement semaphore counter if this does not block
+		 *
+		 * \return  true if the counter got decremented
+		 */
+		bool try_down()
+		{
+			Mutex::Guard guard(_meta_lock);
+
+			if (_cnt <= 0)
+				return false;
+
+			_cnt--;
+			return true;
+		}
+
 		/**
 		 * Return current semaphore counter
 		 */
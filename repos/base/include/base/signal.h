@@ -412,6 +412,16 @@ class Genode::Signal_receiver : Noncopyable
 		 */
 		Signal pending_signal();
 
+		/**
+		 * Drop the wakeup of a signal retrieved via 'pending_signal'
+		 * without blocking for it
+		 *
+		 * If the wakeup was consumed already, the call has no effect.
+		 *
+		 * \noapi
+		 */
+		void discard_wakeup();
+
 		/**
 		 * Locally submit signal to the receiver
 		 *
@@ -10,7 +10,7 @@
  */
 
 /*
- * Copyright (C) 2016-2017 Genode Labs GmbH
+ * Copyright (C) 2016-2022 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -32,6 +32,7 @@ namespace Genode {
 	class Time_source;
 	class Timeout;
 	class Timeout_handler;
+	class Timeout_wheel;
 	class Timeout_scheduler;
 }
 
@@ -85,10 +86,10 @@ struct Genode::Time_source : Interface
  * example, in a Timer-session server. If this is not the case, the classes
  * Periodic_timeout and One_shot_timeout are the better choice.
  */
-class Genode::Timeout : private Noncopyable,
-                        public Genode::List<Timeout>::Element
+class Genode::Timeout : private Noncopyable
 {
 	friend class Timeout_scheduler;
+	friend class Timeout_wheel;
 
 	private:
 
@@ -101,6 +102,10 @@ class Genode::Timeout : private Noncopyable,
 		Timeout_handler       *_handler             { nullptr };
 		bool                   _in_discard_blockade { false };
 		Blockade               _discard_blockade    { };
+		Timeout               *_wheel_prev          { nullptr };
+		Timeout               *_wheel_next          { nullptr };
+		unsigned               _wheel_slot          { 0 };
+		bool                   _in_wheel            { false };
 
 		Timeout(Timeout const &);
 
@@ -126,6 +131,74 @@ class Genode::Timeout : private Noncopyable,
 };
 
 
+/**
+ * Hierarchical timing wheel holding the scheduled timeouts
+ *
+ * Each level of the wheel consists of 'SLOTS' slots. A slot of level 'l'
+ * covers 'SLOTS^l' microseconds. A timeout is put into the lowest level at
+ * which its deadline lies within the same slot of the next level as the
+ * time of the wheel. Hence, inserting and removing a timeout takes constant
+ * time. When the time of the wheel reaches a slot of a level above zero, the
+ * timeouts of the slot are redistributed to the lower levels. Deadlines
+ * beyond the range of the highest level are kept in an overflow list.
+ */
+class Genode::Timeout_wheel : private Noncopyable
+{
+	private:
+
+		enum {
+			SLOT_BITS = 5,
+			SLOTS     = 1 << SLOT_BITS,
+			LEVELS    = 7,               /* range of 2^35 us, about 9.5 h */
+			OVERFLOW  = LEVELS * SLOTS,  /* index of the overflow list */
+		};
+
+		Timeout  *_heads[OVERFLOW + 1] { };
+		uint32_t  _occupied[LEVELS]    { };  /* one bit per non-empty slot */
+		uint64_t  _time                { 0 };
+
+		static unsigned _shift(unsigned level) { return level * SLOT_BITS; }
+
+		void _link(Timeout &timeout, unsigned slot);
+
+		/**
+		 * Find the slot that holds the earliest deadlines
+		 *
+		 * \param start  time at which the wheel reaches the slot
+		 *
+		 * \return  false if the wheel is empty
+		 */
+		bool _earliest(unsigned &slot, uint64_t &start) const;
+
+	public:
+
+		void insert(Timeout &timeout);
+
+		/**
+		 * Remove timeout, has no effect if the timeout is not in the wheel
+		 */
+		void remove(Timeout &timeout);
+
+		/**
+		 * Return any timeout in the wheel, or nullptr if the wheel is empty
+		 */
+		Timeout *any() const;
+
+		/**
+		 * Advance time of the wheel
+		 *
+		 * All timeouts with a deadline not later than 'now_us' are removed
+		 * from the wheel and inserted into 'expired'.
+		 */
+		void advance(uint64_t now_us, List<List_element<Timeout> > &expired);
+
+		/**
+		 * Return earliest deadline, or ~0 if the wheel is empty
+		 */
+		uint64_t next_deadline() const;
+};
+
+
 /**
  * Multiplexes one time source amongst different timeouts
  */
@@ -143,14 +216,13 @@ class Genode::Timeout_scheduler : private Noncopyable,
 		Mutex               _mutex              { };
 		Time_source        &_time_source;
 		Microseconds const  _max_sleep_time     { min(_time_source.max_timeout().value, max_sleep_time_us) };
-		List<Timeout>       _timeouts           { };
+		Timeout_wheel       _timeouts           { };
+		Microseconds        _next_deadline      { ~(uint64_t)0 };
 		Microseconds        _current_time       { 0 };
 		bool                _destructor_called  { false };
 		Microseconds        _rate_limit_period;
 		Microseconds        _rate_limit_deadline;
 
-		void _insert_into_timeouts_list(Timeout &timeout);
-
 		void _set_time_source_timeout();
 
 		void _set_time_source_timeout(uint64_t duration_us);
@@ -52,4 +52,6 @@ void Signal_receiver::block_for_signal()
 Signal Signal_receiver::pending_signal() {
 	return Signal(); }
 
+void Signal_receiver::discard_wakeup() { }
+
 void Signal_receiver::local_submit(Signal::Data) { ASSERT_NEVER_CALLED; }
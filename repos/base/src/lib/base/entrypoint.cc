@@ -51,15 +51,32 @@ void Entrypoint::Signal_proxy_component::signal()
 	bool io_progress = false;
 
 	/*
-	 * Try to dispatch one pending signal picked-up by the signal-proxy thread.
-	 * Note, we handle only one signal here to ensure fairness between RPCs and
-	 * signals.
+	 * Try to dispatch the pending signal picked-up by the signal-proxy thread.
+	 * Note, unless configured otherwise via 'signal_batch_limit', we handle
+	 * only one signal here to ensure fairness between RPCs and signals.
 	 */
+	unsigned dispatched = 0;
 
-	Signal sig = ep._sig_rec->pending_signal();
+	while (dispatched < ep._signal_batch_limit) {
+
+		Signal sig = ep._sig_rec->pending_signal();
+
+		if (!sig.valid())
+			break;
+
+		/*
+		 * The wakeup of the signal-proxy thread accounts for the first
+		 * signal only. Take back the wakeup of each further signal right
+		 * when fetching it. Deferring this until the batch is complete
+		 * would drop the wakeup of a signal that arrived in the meantime
+		 * if a handler of the batch consumed wakeups by waiting for I/O
+		 * signals.
+		 */
+		if (dispatched)
+			ep._sig_rec->discard_wakeup();
 
-	if (sig.valid()) {
 		ep._dispatch_signal(sig);
+		dispatched++;
 
 		if (sig.context()->level() == Signal_context::Level::Io) {
 			/* trigger the progress handler */
@@ -146,33 +146,50 @@ namespace Genode {
 		private:
 
 			/*
-			 * Currently, the registry is just a linked list. If this becomes a
-			 * scalability problem, we might introduce a more sophisticated
-			 * associative data structure.
+			 * The registered contexts are hashed by their address into a
+			 * fixed number of buckets. The table does not grow because the
+			 * number of contexts of a component is bounded by its cap quota,
+			 * each context occupies a capability at core. Components with a
+			 * few hundred contexts thus see chains of one or two entries,
+			 * and even 10,000 contexts, which require a cap quota beyond
+			 * that of any component in the tree, result in chains of about
+			 * 40 entries only.
 			 */
-			Mutex mutable                       _mutex { };
-			List<List_element<Signal_context> > _list { };
+			enum { BUCKETS_LOG2 = 8, BUCKETS = 1 << BUCKETS_LOG2 };
+
+			typedef List<List_element<Signal_context> > Bucket;
+
+			Mutex mutable _mutex { };
+			Bucket        _buckets[BUCKETS] { };
+
+			static unsigned _index(Signal_context const *context)
+			{
+				/* Fibonacci hashing */
+				uint64_t const value = (uint64_t)(addr_t)context;
+				return (unsigned)((value * 0x9e3779b97f4a7c15ULL) >> (64 - BUCKETS_LOG2));
+			}
 
 		public:
 
 			void insert(List_element<Signal_context> *le)
 			{
 				Mutex::Guard guard(_mutex);
-				_list.insert(le);
+				_buckets[_index(le->object())].insert(le);
 			}
 
 			void remove(List_element<Signal_context> *le)
 			{
 				Mutex::Guard guard(_mutex);
-				_list.remove(le);
+				_buckets[_index(le->object())].remove(le);
 			}
 
 			bool test_and_lock(Signal_context *context) const
 			{
 				Mutex::Guard guard(_mutex);
 
-				/* search list for context */
-				List_element<Signal_context> const *le = _list.first();
+				/* search bucket for context */
+				List_element<Signal_context> const *le =
+					_buckets[_index(context)].first();
 				for ( ; le; le = le->next()) {
 
 					if (context == le->object()) {
@@ -286,6 +303,18 @@ Signal Signal_receiver::pending_signal()
 	return Signal();
 }
 
+
+void Signal_receiver::discard_wakeup()
+{
+	/*
+	 * Each context that became pending increased the semaphore. Hence,
+	 * the wakeup of a signal retrieved already can be dropped without
+	 * blocking.
+	 */
+	_signal_available.try_down();
+}
+
+
 void Signal_receiver::unblock_signal_waiter(Rpc_entrypoint &)
 {
 	_signal_available.up();
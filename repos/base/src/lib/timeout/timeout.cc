@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2016-2017 Genode Labs GmbH
+ * Copyright (C) 2016-2022 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -55,6 +55,176 @@ void Timeout::discard() { _scheduler._discard_timeout(*this); }
 bool Timeout::scheduled() { return _handler != nullptr; }
 
 
+/*******************
+ ** Timeout_wheel **
+ *******************/
+
+void Timeout_wheel::_link(Timeout &timeout, unsigned slot)
+{
+	Timeout *&head = _heads[slot];
+
+	timeout._wheel_prev = nullptr;
+	timeout._wheel_next = head;
+	timeout._wheel_slot = slot;
+	timeout._in_wheel   = true;
+
+	if (head)
+		head->_wheel_prev = &timeout;
+
+	head = &timeout;
+
+	if (slot != OVERFLOW)
+		_occupied[slot / SLOTS] |= 1u << (slot % SLOTS);
+}
+
+
+bool Timeout_wheel::_earliest(unsigned &slot, uint64_t &start) const
+{
+	/*
+	 * The slots of a level lie behind all slots of the lower levels that
+	 * are not yet reached by the wheel time.
+	 */
+	for (unsigned level = 0; level < LEVELS; level++) {
+
+		unsigned const current = (unsigned)(_time >> _shift(level)) & (SLOTS - 1);
+		uint32_t const pending = _occupied[level] & (~0u << current);
+
+		if (!pending)
+			continue;
+
+		unsigned const index = (unsigned)__builtin_ctz(pending);
+		unsigned const upper = _shift(level + 1);
+
+		slot  = level * SLOTS + index;
+		start = ((_time >> upper) << upper) | ((uint64_t)index << _shift(level));
+		return true;
+	}
+
+	if (!_heads[OVERFLOW])
+		return false;
+
+	uint64_t deadline = ~(uint64_t)0;
+	for (Timeout const *t = _heads[OVERFLOW]; t; t = t->_wheel_next)
+		deadline = min(deadline, t->_deadline.value);
+
+	slot  = OVERFLOW;
+	start = (deadline >> _shift(LEVELS)) << _shift(LEVELS);
+	return true;
+}
+
+
+void Timeout_wheel::insert(Timeout &timeout)
+{
+	/* deadlines in the past are due at the current wheel time */
+	uint64_t const deadline = max(timeout._deadline.value, _time);
+	uint64_t const diff     = deadline ^ _time;
+
+	unsigned const level = diff ? (unsigned)(63 - __builtin_clzll(diff)) / SLOT_BITS : 0;
+
+	if (level >= LEVELS) {
+		_link(timeout, OVERFLOW);
+		return;
+	}
+
+	unsigned const index = (unsigned)(deadline >> _shift(level)) & (SLOTS - 1);
+
+	_link(timeout, level * SLOTS + index);
+}
+
+
+void Timeout_wheel::remove(Timeout &timeout)
+{
+	if (!timeout._in_wheel)
+		return;
+
+	unsigned const slot = timeout._wheel_slot;
+
+	if (timeout._wheel_prev)
+		timeout._wheel_prev->_wheel_next = timeout._wheel_next;
+	else
+		_heads[slot] = timeout._wheel_next;
+
+	if (timeout._wheel_next)
+		timeout._wheel_next->_wheel_prev = timeout._wheel_prev;
+
+	if (!_heads[slot] && slot != OVERFLOW)
+		_occupied[slot / SLOTS] &= ~(1u << (slot % SLOTS));
+
+	timeout._wheel_prev = nullptr;
+	timeout._wheel_next = nullptr;
+	timeout._in_wheel   = false;
+}
+
+
+Timeout *Timeout_wheel::any() const
+{
+	for (unsigned level = 0; level < LEVELS; level++)
+		if (_occupied[level])
+			return _heads[level * SLOTS + (unsigned)__builtin_ctz(_occupied[level])];
+
+	return _heads[OVERFLOW];
+}
+
+
+void Timeout_wheel::advance(uint64_t now_us, List<List_element<Timeout> > &expired)
+{
+	for (;;) {
+
+		unsigned slot  = 0;
+		uint64_t start = 0;
+
+		if (!_earliest(slot, start) || start > now_us) {
+			_time = max(_time, now_us);
+			return;
+		}
+
+		/*
+		 * Empty the slot and move its timeouts either to the expired ones or
+		 * to the lower levels, which are relative to the slot start now
+		 */
+		_time = start;
+
+		Timeout *timeout = _heads[slot];
+
+		_heads[slot] = nullptr;
+		if (slot != OVERFLOW)
+			_occupied[slot / SLOTS] &= ~(1u << (slot % SLOTS));
+
+		while (timeout) {
+
+			Timeout &curr = *timeout;
+			timeout = curr._wheel_next;
+
+			curr._wheel_prev = nullptr;
+			curr._wheel_next = nullptr;
+			curr._in_wheel   = false;
+
+			if (curr._deadline.value <= now_us)
+				expired.insert(&curr._pending_timeouts_le);
+			else
+				insert(curr);
+		}
+	}
+}
+
+
+uint64_t Timeout_wheel::next_deadline() const
+{
+	unsigned slot  = 0;
+	uint64_t start = 0;
+
+	if (!_earliest(slot, start))
+		return ~(uint64_t)0;
+
+	/* all other slots hold later deadlines */
+	uint64_t deadline = ~(uint64_t)0;
+	for (Timeout const *t = _heads[slot]; t; t = t->_wheel_next)
+		deadline = min(deadline, t->_deadline.value);
+
+	return deadline;
+}
+
+
 /***********************
  ** Timeout_scheduler **
  ***********************/
@@ -86,19 +256,11 @@ void Timeout_scheduler::handle_timeout(Duration curr_time)
 		/*
 		 * Filter out all pending timeouts to a local list first. The
 		 * processing of pending timeouts can have effects on the '_timeouts'
-		 * list and these would interfere with the filtering if we would do
+		 * wheel and these would interfere with the filtering if we would do
 		 * it all in the same loop.
 		 */
-		while (Timeout *timeout = _timeouts.first()) {
+		_timeouts.advance(_current_time.value, pending_timeouts);
 
-			timeout->_mutex.acquire();
-			if (timeout->_deadline.value > _current_time.value) {
-				timeout->_mutex.release();
-				break;
-			}
-			_timeouts.remove(timeout);
-			pending_timeouts.insert(&timeout->_pending_timeouts_le);
-		}
 		/*
 		 * Do the framework-internal processing of the pending timeouts and
 		 * then release their mutexes.
@@ -108,6 +270,7 @@ void Timeout_scheduler::handle_timeout(Duration curr_time)
 		     elem = elem->next()) {
 
 			Timeout &timeout { *elem->object() };
+			timeout._mutex.acquire();
 			if (!timeout._in_discard_blockade) {
 
 				/*
@@ -153,9 +316,9 @@ void Timeout_scheduler::handle_timeout(Duration curr_time)
 				if (deadline_us < _current_time.value) {
 					deadline_us = ~(uint64_t)0;
 				}
-				/* re-insert timeout into timeouts list */
+				/* re-insert timeout into timeouts wheel */
 				timeout._deadline = Microseconds { deadline_us };
-				_insert_into_timeouts_list(timeout);
+				_timeouts.insert(timeout);
 			}
 			timeout._mutex.release();
 		}
@@ -223,7 +386,7 @@ Timeout_scheduler::~Timeout_scheduler()
 	_destructor_called = true;
 
 	/* discard all scheduled timeouts */
-	while (Timeout *timeout = _timeouts.first()) {
+	while (Timeout *timeout = _timeouts.any()) {
 		Mutex::Guard const timeout_guard { timeout->_mutex };
 		_discard_timeout_unsynchronized(*timeout);
 	}
@@ -242,10 +405,15 @@ void Timeout_scheduler::_enable()
 
 void Timeout_scheduler::_set_time_source_timeout()
 {
+	_next_deadline = Microseconds { _timeouts.next_deadline() };
+
+	if (_next_deadline.value == ~(uint64_t)0) {
+		_set_time_source_timeout(~(uint64_t)0);
+		return;
+	}
 	_set_time_source_timeout(
-		_timeouts.first() ?
-			_timeouts.first()->_deadline.value - _current_time.value :
-			~(uint64_t)0);
+		_next_deadline.value > _current_time.value ?
+			_next_deadline.value - _current_time.value : 0);
 }
 
 
@@ -297,7 +465,7 @@ void Timeout_scheduler::_schedule_timeout(Timeout         &timeout,
 
 	/* prevent inserting a timeout twice */
 	if (timeout._handler != nullptr) {
-		_timeouts.remove(&timeout);
+		_timeouts.remove(timeout);
 	}
 	/* determine timeout deadline */
 	uint64_t const curr_time_us {
@@ -307,45 +475,23 @@ void Timeout_scheduler::_schedule_timeout(Timeout         &timeout,
 		duration.value <= ~(uint64_t)0 - curr_time_us ?
 			curr_time_us + duration.value : ~(uint64_t)0 };
 
-	/* set up timeout object and insert into timeouts list */
+	/* set up timeout object and insert into timeouts wheel */
 	timeout._handler = &handler;
 	timeout._deadline = Microseconds { deadline_us };
 	timeout._period = period;
-	_insert_into_timeouts_list(timeout);
+	_timeouts.insert(timeout);
 
 	/*
 	 * If the new timeout is the first to trigger, we have to  update the
 	 * time-source timeout.
 	 */
-	if (_timeouts.first() == &timeout) {
+	if (deadline_us < _next_deadline.value) {
+		_next_deadline = Microseconds { deadline_us };
 		_set_time_source_timeout(deadline_us - curr_time_us);
 	}
 }
 
 
-void Timeout_scheduler::_insert_into_timeouts_list(Timeout &timeout)
-{
-	/* if timeout list is empty, insert as first element */
-	if (_timeouts.first() == nullptr) {
-		_timeouts.insert(&timeout);
-		return;
-	}
-	/* if timeout has the shortest deadline, insert as first element */
-	if (_timeouts.first()->_deadline.value >= timeout._deadline.value) {
-		_timeouts.insert(&timeout);
-		return;
-	}
-	/* find list element with next shorter deadline and insert behind it */
-	Timeout *curr_timeout { _timeouts.first() };
-	for (;
-	     curr_timeout->next() != nullptr &&
-	     curr_timeout->next()->_deadline.value < timeout._deadline.value;
-	     curr_timeout = curr_timeout->_next);
-
-	_timeouts.insert(&timeout, curr_timeout);
-}
-
-
 void Timeout_scheduler::_discard_timeout(Timeout &timeout)
 {
 	Mutex::Guard const scheduler_mutex { _mutex };
@@ -393,7 +539,7 @@ void Timeout_scheduler::_discard_timeout_unsynchronized(Timeout &timeout)
 		timeout._mutex.acquire();
 		timeout._in_discard_blockade = false;
 	}
-	_timeouts.remove(&timeout);
+	_timeouts.remove(timeout);
 	timeout._handler = nullptr;
 }
 
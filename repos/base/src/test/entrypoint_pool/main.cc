@@ -0,0 +1,207 @@
+/*
+ * \brief  Test for serving RPC objects by a pool of entrypoints
+ * \author Stefan Kalkowski
+ * \date   2022-08-02
+ *
+ * Several client threads call RPC objects and trigger signal handlers that
+ * are spread over the domains of an entrypoint pool. The test checks that
+ * all objects of a domain are served by one thread and never in parallel.
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/entrypoint_pool.h>
+#include <base/heap.h>
+#include <base/rpc_server.h>
+#include <base/rpc_client.h>
+
+namespace Test {
+
+	using namespace Genode;
+
+	struct Session;
+	struct Domain;
+	struct Session_component;
+	struct Client;
+	struct Main;
+
+	enum { SESSIONS_PER_DOMAIN = 2, ROUNDS = 1000, SPIN = 10000 };
+}
+
+
+struct Test::Session : Genode::Session
+{
+	static const char *service_name() { return "Test"; }
+
+	GENODE_RPC(Rpc_work, addr_t, work);
+	GENODE_RPC_INTERFACE(Rpc_work);
+};
+
+
+/*
+ * State shared by the sessions of a domain
+ */
+struct Test::Domain
+{
+	Entrypoint_pool::Domain domain;
+
+	unsigned active { 0 };  /* objects of the domain in execution */
+	addr_t   thread { 0 };  /* thread that served the domain first */
+
+	Domain(Entrypoint_pool &pool) : domain(pool) { }
+};
+
+
+struct Test::Main
+{
+	Env &env;
+
+	Heap heap { env.ram(), env.rm() };
+
+	Entrypoint_pool pool { env, heap,
+	                       (unsigned)env.cpu().affinity_space().total(),
+	                       4*1024*sizeof(long), "test_ep" };
+
+	unsigned active     { 0 };
+	unsigned max_active { 0 };
+	unsigned violations { 0 };
+
+	void violation(char const *reason)
+	{
+		error(reason);
+		__atomic_add_fetch(&violations, 1, __ATOMIC_SEQ_CST);
+	}
+
+	void enter(Domain &domain)
+	{
+		if (__atomic_add_fetch(&domain.active, 1, __ATOMIC_SEQ_CST) > 1)
+			violation("objects of one domain executed in parallel");
+
+		addr_t const myself = (addr_t)Thread::myself();
+		addr_t       first  = 0;
+		if (!__atomic_compare_exchange_n(&domain.thread, &first, myself, false,
+		                                 __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+		 && first != myself)
+			violation("domain served by different threads");
+
+		unsigned const curr = __atomic_add_fetch(&active, 1, __ATOMIC_SEQ_CST);
+		unsigned       max  = __atomic_load_n(&max_active, __ATOMIC_SEQ_CST);
+		while (curr > max
+		    && !__atomic_compare_exchange_n(&max_active, &max, curr, false,
+		                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+	}
+
+	void leave(Domain &domain)
+	{
+		__atomic_sub_fetch(&active, 1, __ATOMIC_SEQ_CST);
+		__atomic_sub_fetch(&domain.active, 1, __ATOMIC_SEQ_CST);
+	}
+
+	Main(Env &env);
+};
+
+
+struct Test::Session_component : Rpc_object<Session, Session_component>
+{
+	Main   &main;
+	Domain &domain;
+
+	Signal_handler<Session_component> sigh {
+		domain.domain.ep(), *this, &Session_component::_handle_signal };
+
+	Capability<Session> cap { domain.domain.ep().manage(*this) };
+
+	void _spin()
+	{
+		main.enter(domain);
+		for (unsigned volatile i = 0; i < SPIN; i++);
+		main.leave(domain);
+	}
+
+	void _handle_signal() { _spin(); }
+
+	Session_component(Main &main, Domain &domain)
+	: main(main), domain(domain) { }
+
+	~Session_component() { domain.domain.ep().dissolve(*this); }
+
+	addr_t work()
+	{
+		_spin();
+		return (addr_t)Thread::myself();
+	}
+};
+
+
+struct Test::Client : Thread
+{
+	Main              &main;
+	Session_component &session;
+
+	Client(Main &main, Session_component &session, unsigned i)
+	:
+		Thread(main.env, Name("client_", i), 4*1024*sizeof(long)),
+		main(main), session(session)
+	{ start(); }
+
+	void entry() override
+	{
+		addr_t const server = session.cap.call<Session::Rpc_work>();
+
+		for (unsigned i = 1; i < ROUNDS; i++) {
+			Signal_transmitter(session.sigh).submit();
+
+			if (session.cap.call<Session::Rpc_work>() != server)
+				main.violation("session served by different threads");
+		}
+	}
+};
+
+
+Test::Main::Main(Env &env) : env(env)
+{
+	log("--- entrypoint pool test started ---");
+
+	unsigned const domains  = 2*pool.count();
+	unsigned const sessions = domains*SESSIONS_PER_DOMAIN;
+
+	log("entrypoints: ", pool.count(), " domains: ", domains,
+	    " sessions: ", sessions);
+
+	Domain            **domain  = new (heap) Domain*[domains];
+	Session_component **session = new (heap) Session_component*[sessions];
+	Client            **client  = new (heap) Client*[sessions];
+
+	for (unsigned i = 0; i < domains; i++)
+		domain[i] = new (heap) Domain(pool);
+
+	for (unsigned i = 0; i < sessions; i++)
+		session[i] = new (heap) Session_component(*this, *domain[i % domains]);
+
+	for (unsigned i = 0; i < sessions; i++)
+		client[i] = new (heap) Client(*this, *session[i], i);
+
+	for (unsigned i = 0; i < sessions; i++)
+		client[i]->join();
+
+	log("max parallel dispatch: ", max_active);
+
+	if (violations) {
+		error("--- entrypoint pool test failed (", violations, " violations) ---");
+		env.parent().exit(-1);
+		return;
+	}
+
+	log("--- entrypoint pool test finished ---");
+	env.parent().exit(0);
+}
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,185 @@
+/*
+ * \brief  Test for the batched dispatch of signals by the entrypoint
+ * \author Stefan Kalkowski
+ * \date   2022-08-04
+ *
+ * A sender thread submits signals to many signal contexts of the entrypoint,
+ * once a single signal at a time and once a burst of one signal per context.
+ * The test measures the time until the entrypoint handled the signals with
+ * the default signal-batch limit of 1 and with a higher limit. A lost signal
+ * stalls the test, a signal handled twice fails it.
+ *
+ * In addition, the handlers of a batch wait for an I/O signal, which consumes
+ * wakeups of the signals fetched by the batch. Signals submitted afterwards
+ * must still be handled.
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/blockade.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <base/thread.h>
+#include <trace/timestamp.h>
+
+namespace Test {
+
+	using namespace Genode;
+
+	struct Context;
+	struct Main;
+
+	enum { CONTEXTS = 1000, ROUNDS = 10, SINGLE_SIGNALS = 1000 };
+}
+
+
+struct Test::Context
+{
+	Main &main;
+
+	Signal_handler<Context> handler;
+
+	inline void _handle();
+
+	Context(Entrypoint &ep, Main &main)
+	: main(main), handler(ep, *this, &Context::_handle) { }
+};
+
+
+struct Test::Main : Thread
+{
+	Env &env;
+
+	Heap heap { env.ram(), env.rm() };
+
+	Context *contexts[CONTEXTS] { };
+
+	unsigned expected   { 0 };  /* signals still to be handled */
+	unsigned unexpected { 0 };
+
+	Blockade handled { };
+
+	bool io_wait    { false };  /* handlers wait for an I/O signal */
+	bool io_handled { false };
+
+	void _handle_io() { io_handled = true; }
+
+	Io_signal_handler<Main> io_handler { env.ep(), *this, &Main::_handle_io };
+
+	/*
+	 * Noncopyable
+	 */
+	Main(Main const &);
+	Main &operator = (Main const &);
+
+	void handle()
+	{
+		if (io_wait) {
+			io_handled = false;
+			Signal_transmitter(io_handler).submit();
+			while (!io_handled)
+				env.ep().wait_and_dispatch_one_io_signal();
+		}
+
+		if (!expected) {
+			unexpected++;
+			return;
+		}
+
+		if (--expected == 0)
+			handled.wakeup();
+	}
+
+	/**
+	 * Submit 'count' signals, one to each of the first contexts
+	 *
+	 * \return  time until all signals were handled
+	 */
+	Trace::Timestamp _submit(unsigned count)
+	{
+		expected = count;
+
+		Trace::Timestamp const start = Trace::timestamp();
+
+		for (unsigned i = 0; i < count; i++)
+			Signal_transmitter(contexts[i]->handler).submit();
+
+		handled.block();
+		return Trace::timestamp() - start;
+	}
+
+	void _measure(unsigned limit)
+	{
+		env.ep().signal_batch_limit(limit);
+
+		Trace::Timestamp single = 0;
+		for (unsigned i = 0; i < SINGLE_SIGNALS; i++)
+			single += _submit(1);
+
+		Trace::Timestamp burst = 0;
+		for (unsigned i = 0; i < ROUNDS; i++)
+			burst += _submit(CONTEXTS);
+
+		log("batch limit ", limit, ": ",
+		    "single signal ", single / SINGLE_SIGNALS, " cycles, ",
+		    "burst of ", (unsigned)CONTEXTS, " signals ", burst / ROUNDS, " cycles");
+	}
+
+	void _test_io_wait_in_batch()
+	{
+		env.ep().signal_batch_limit(CONTEXTS);
+
+		io_wait = true;
+		for (unsigned i = 0; i < ROUNDS; i++)
+			_submit(CONTEXTS);
+		io_wait = false;
+
+		for (unsigned i = 0; i < SINGLE_SIGNALS; i++)
+			_submit(1);
+
+		log("batch limit ", (unsigned)CONTEXTS, ": ",
+		    "handlers waiting for I/O signals within batch passed");
+	}
+
+	void entry() override
+	{
+		_measure(1);
+		_measure(CONTEXTS);
+		_test_io_wait_in_batch();
+		_measure(1);
+
+		if (unexpected) {
+			error("--- signal batch test failed (", unexpected, " unexpected signals) ---");
+			env.parent().exit(-1);
+			return;
+		}
+
+		log("--- signal batch test finished ---");
+		env.parent().exit(0);
+	}
+
+	Main(Env &env)
+	:
+		Thread(env, "sender", 4*1024*sizeof(long)), env(env)
+	{
+		log("--- signal batch test started ---");
+
+		for (unsigned i = 0; i < CONTEXTS; i++)
+			contexts[i] = new (heap) Context(env.ep(), *this);
+
+		start();
+	}
+};
+
+
+void Test::Context::_handle() { main.handle(); }
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-signal_batch
+SRC_CC = main.cc
+LIBS   = base
@@ -0,0 +1,190 @@
+/*
+ * \brief  Stress test and benchmark of the Timeout framework
+ * \author Martin Stein
+ * \date   2022-08-01
+ *
+ * The test manages a large number of one-shot timeouts through one timer
+ * connection. It measures the costs of scheduling, re-scheduling, and
+ * discarding timeouts and checks that no timeout triggers before its
+ * deadline and all timeouts trigger eventually.
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_rom_dataspace.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <timer_session/connection.h>
+
+using namespace Genode;
+
+
+class Main;
+
+
+class Probe : Noncopyable
+{
+	private:
+
+		Main                             &_main;
+		Timer::One_shot_timeout<Probe>    _timeout;
+		uint64_t                          _deadline_us { 0 };
+
+		void _handle_timeout(Duration curr_time);
+
+	public:
+
+		Probe(Timer::Connection &timer, Main &main)
+		:
+			_main    { main },
+			_timeout { timer, *this, &Probe::_handle_timeout }
+		{ }
+
+		void schedule(uint64_t now_us, uint64_t duration_us)
+		{
+			_deadline_us = now_us + duration_us;
+			_timeout.schedule(Microseconds { duration_us });
+		}
+
+		void discard() { _timeout.discard(); }
+};
+
+
+class Main
+{
+	private:
+
+		Env                    &_env;
+		Attached_rom_dataspace  _config { _env, "config" };
+		Heap                    _heap   { _env.ram(), _env.rm() };
+		Timer::Connection       _timer  { _env };
+
+		unsigned const _nr_of_timeouts {
+			_config.xml().attribute_value("timeouts", 10000u) };
+
+		unsigned const _nr_of_rounds {
+			_config.xml().attribute_value("rounds", 10u) };
+
+		uint64_t const _max_fire_us {
+			_config.xml().attribute_value("fire_ms", 2000ULL) * 1000 };
+
+		Probe *_probes { nullptr };
+
+		uint64_t      _seed             { 0x9e3779b97f4a7c15ULL };
+		unsigned long _nr_of_errors     { 0 };
+		unsigned      _nr_of_triggered  { 0 };
+		uint64_t      _max_lateness_us  { 0 };
+		uint64_t      _sum_lateness_us  { 0 };
+		uint64_t      _fire_start_us    { 0 };
+
+		/*
+		 * Noncopyable
+		 */
+		Main(Main const &);
+		Main &operator = (Main const &);
+
+		uint64_t _random()
+		{
+			/* xorshift64 */
+			_seed ^= _seed << 13;
+			_seed ^= _seed >> 7;
+			_seed ^= _seed << 17;
+			return _seed;
+		}
+
+		uint64_t _now_us() { return _timer.curr_time().trunc_to_plain_us().value; }
+
+		/**
+		 * Call 'fn' for each probe and log the average costs per call
+		 */
+		template <typename FN>
+		void _measure(char const *what, FN const &fn)
+		{
+			uint64_t const start_us = _now_us();
+
+			for (unsigned round = 0; round < _nr_of_rounds; round++)
+				for (unsigned i = 0; i < _nr_of_timeouts; i++)
+					fn(_probes[i]);
+
+			uint64_t const duration_us = _now_us() - start_us;
+			uint64_t const nr_of_calls = (uint64_t)_nr_of_rounds * _nr_of_timeouts;
+
+			log("  ", what, ": ", nr_of_calls, " calls in ", duration_us, " us, ",
+			    duration_us * 1000 / max(nr_of_calls, (uint64_t)1), " ns per call");
+		}
+
+		void _finish()
+		{
+			log("  triggered ", _nr_of_triggered, " timeouts in ",
+			    (_now_us() - _fire_start_us) / 1000, " ms, lateness avg ",
+			    _sum_lateness_us / max(_nr_of_triggered, 1u), " us max ",
+			    _max_lateness_us, " us");
+
+			if (_nr_of_errors) {
+				log("Test failed with ", _nr_of_errors, " errors");
+				_env.parent().exit(-1);
+			} else {
+				log("Test succeeded");
+				_env.parent().exit(0);
+			}
+		}
+
+	public:
+
+		Main(Env &env) : _env { env }
+		{
+			log("Stress test with ", _nr_of_timeouts, " timeouts, ",
+			    _nr_of_rounds, " rounds");
+
+			_probes = (Probe *)_heap.alloc(sizeof(Probe) * _nr_of_timeouts);
+			for (unsigned i = 0; i < _nr_of_timeouts; i++)
+				construct_at<Probe>(&_probes[i], _timer, *this);
+
+			/* deadlines far ahead, the timeouts never trigger in this phase */
+			_measure("schedule", [&] (Probe &probe) {
+				probe.schedule(_now_us(), 60'000'000 + _random() % 60'000'000); });
+
+			_measure("reschedule", [&] (Probe &probe) {
+				probe.schedule(_now_us(), 60'000'000 + _random() % 60'000'000); });
+
+			_measure("discard", [&] (Probe &probe) {
+				probe.schedule(_now_us(), 60'000'000 + _random() % 60'000'000);
+				probe.discard(); });
+
+			/* let all timeouts trigger within '_max_fire_us' */
+			_fire_start_us = _now_us();
+			for (unsigned i = 0; i < _nr_of_timeouts; i++)
+				_probes[i].schedule(_now_us(), _random() % _max_fire_us);
+		}
+
+		void triggered(uint64_t deadline_us, uint64_t curr_time_us)
+		{
+			if (curr_time_us < deadline_us) {
+				if (_nr_of_errors++ < 10)
+					error("timeout triggered ", deadline_us - curr_time_us,
+					      " us before its deadline");
+			} else {
+				uint64_t const lateness_us = curr_time_us - deadline_us;
+				_sum_lateness_us += lateness_us;
+				_max_lateness_us  = max(_max_lateness_us, lateness_us);
+			}
+
+			if (++_nr_of_triggered == _nr_of_timeouts)
+				_finish();
+		}
+};
+
+
+void Probe::_handle_timeout(Duration curr_time)
+{
+	_main.triggered(_deadline_us, curr_time.trunc_to_plain_us().value);
+}
+
+
+void Component::construct(Env &env) { static Main main { env }; }
@@ -0,0 +1,3 @@
+TARGET = test-timeout_stress
+SRC_CC = main.cc
+LIBS   = base
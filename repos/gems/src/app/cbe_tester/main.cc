@@ -408,6 +408,7 @@ class Vfs_block_io_job
 				case Result::WRITE_ERR_AGAIN:
 				case Result::WRITE_ERR_INTERRUPT:
 				case Result::WRITE_ERR_WOULD_BLOCK:
+				case Result::WRITE_QUEUED:
 
 					return;
 
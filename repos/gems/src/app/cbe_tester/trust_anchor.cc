@@ -52,6 +52,7 @@ void Trust_anchor::_execute_write_read_operation(Vfs_handle        &file,
 		case Write_result::WRITE_ERR_AGAIN:
 		case Write_result::WRITE_ERR_INTERRUPT:
 		case Write_result::WRITE_ERR_WOULD_BLOCK:
+		case Write_result::WRITE_QUEUED:
 
 			return;
 
@@ -170,6 +171,7 @@ void Trust_anchor::_execute_write_operation(Vfs_handle        &file,
 		case Write_result::WRITE_ERR_AGAIN:
 		case Write_result::WRITE_ERR_INTERRUPT:
 		case Write_result::WRITE_ERR_WOULD_BLOCK:
+		case Write_result::WRITE_QUEUED:
 
 			return;
 
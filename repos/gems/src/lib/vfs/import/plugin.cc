@@ -165,6 +165,7 @@ class Vfs_import::File_system : public Vfs::File_system
 						                               out_count)) {
 						case WRITE_ERR_AGAIN:
 						case WRITE_ERR_WOULD_BLOCK:
+						case WRITE_QUEUED:
 							stalled = true;
 							break;
 						case Write_result::WRITE_ERR_INVALID:
@@ -24,6 +24,7 @@
 #include <sys/stat.h>
 #include <sys/mount.h>  /* for 'struct statfs' */
 #include <sys/poll.h>   /* for 'struct pollfd' */
+#include <sys/uio.h>    /* for 'struct iovec' */
 
 namespace Genode { class Env; }
 
@@ -123,6 +124,7 @@ namespace Libc {
 			virtual bool poll(File_descriptor&, struct pollfd &pfd);
 			virtual ssize_t read(File_descriptor *, void *buf, ::size_t count);
 			virtual ssize_t readlink(const char *path, char *buf, ::size_t bufsiz);
+			virtual ssize_t readv(File_descriptor *, const struct iovec *iov, int iovcnt);
 			virtual ssize_t recv(File_descriptor *, void *buf, ::size_t len, int flags);
 			virtual ssize_t recvfrom(File_descriptor *, void *buf, ::size_t len, int flags,
 			                         struct sockaddr *src_addr, socklen_t *addrlen);
@@ -145,6 +147,7 @@ namespace Libc {
 			virtual int symlink(const char *oldpath, const char *newpath);
 			virtual int unlink(const char *path);
 			virtual ssize_t write(File_descriptor *, const void *buf, ::size_t count);
+			virtual ssize_t writev(File_descriptor *, const struct iovec *iov, int iovcnt);
 	};
 }
 
@@ -223,12 +223,14 @@ class Libc::Vfs_plugin final : public Plugin
 		bool    poll(File_descriptor &fdo, struct pollfd &pfd) override;
 		ssize_t read(File_descriptor *, void *, ::size_t) override;
 		ssize_t readlink(const char *, char *, ::size_t) override;
+		ssize_t readv(File_descriptor *, const struct iovec *, int) override;
 		int     rename(const char *, const char *) override;
 		int     rmdir(const char *) override;
 		int     stat(const char *, struct stat *) override;
 		int     symlink(const char *, const char *) override;
 		int     unlink(const char *) override;
 		ssize_t write(File_descriptor *, const void *, ::size_t ) override;
+		ssize_t writev(File_descriptor *, const struct iovec *, int) override;
 		void   *mmap(void *, ::size_t, int, int, File_descriptor *, ::off_t) override;
 		int     munmap(void *, ::size_t) override;
 		int     select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout) override;
@@ -149,6 +149,54 @@ bool Plugin::supports_mmap()
 }
 
 
+/*
+ * Default implementations of the vectored I/O functions, which transfer
+ * one segment after the other
+ */
+
+template <typename FN>
+static ssize_t for_each_segment(const struct iovec *iov, int iovcnt, FN const &fn)
+{
+	ssize_t bytes_transfered_total = 0;
+
+	for (int i = 0; i < iovcnt; i++) {
+
+		char    *v     = static_cast<char *>(iov[i].iov_base);
+		::size_t v_len = iov[i].iov_len;
+
+		while (v_len > 0) {
+			ssize_t const bytes_transfered = fn(v, v_len);
+
+			if (bytes_transfered == -1)
+				return -1;
+
+			if (bytes_transfered == 0)
+				return bytes_transfered_total;
+
+			v_len -= bytes_transfered;
+			v     += bytes_transfered;
+			bytes_transfered_total += bytes_transfered;
+		}
+	}
+
+	return bytes_transfered_total;
+}
+
+
+ssize_t Plugin::readv(File_descriptor *fd, const struct iovec *iov, int iovcnt)
+{
+	return for_each_segment(iov, iovcnt, [&] (char *v, ::size_t v_len) {
+		return read(fd, v, v_len); });
+}
+
+
+ssize_t Plugin::writev(File_descriptor *fd, const struct iovec *iov, int iovcnt)
+{
+	return for_each_segment(iov, iovcnt, [&] (char const *v, ::size_t v_len) {
+		return write(fd, v, v_len); });
+}
+
+
 /**
  * Generate dummy member function of Plugin class
  */
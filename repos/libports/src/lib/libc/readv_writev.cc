@@ -6,7 +6,7 @@
  */
 
 /*
- * Copyright (C) 2012-2017 Genode Labs GmbH
+ * Copyright (C) 2012-2022 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -20,87 +20,55 @@
 #include <limits.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 
 /* libc-internal includes */
 #include <internal/types.h>
+#include <internal/file.h>
 
 using namespace Libc;
 
 
-struct Read
+/* FIXME this should be a pthread_mutex because function uses blocking operations */
+static Mutex &rw_mutex()
 {
-	ssize_t operator()(int fd, void *buf, size_t count)
-	{
-		return read(fd, buf, count);
-	}
-};
-
-
-struct Write
-{
-	ssize_t operator()(int fd, const void *buf, size_t count)
-	{
-		return write(fd, buf, count);
-	}
-};
+	static Mutex mutex;
+	return mutex;
+}
 
 
-template <typename Rw_func>
-static ssize_t readv_writev_impl(Rw_func rw_func, int fd, const struct iovec *iov, int iovcnt)
+static bool valid_iovec(const struct iovec *iov, int iovcnt)
 {
-	/* FIXME this should be a pthread_mutex because function uses blocking operations */
-	static Mutex rw_mutex;
-
-	Mutex::Guard guard(rw_mutex);
+	if (iovcnt < 1 || iovcnt > IOV_MAX || !iov)
+		return false;
 
-	char *v;
-	ssize_t bytes_transfered_total = 0;
 	size_t v_len = 0;
-	int i;
-
-	if (iovcnt < 1 || iovcnt > IOV_MAX) {
-		errno = EINVAL;
-		return -1;
-	}
-
-	for (i = 0; i < iovcnt; i++)
-		v_len += iov->iov_len;
-
-	if (v_len > SSIZE_MAX) {
-		errno = EINVAL;
-		return -1;
+	for (int i = 0; i < iovcnt; i++) {
+		if (iov[i].iov_len > SSIZE_MAX - v_len)
+			return false;
+		v_len += iov[i].iov_len;
 	}
 
-	while (iovcnt > 0) {
-		v = static_cast<char *>(iov->iov_base);
-		v_len = iov->iov_len;
-
-		while (v_len > 0) {
-			ssize_t bytes_transfered = rw_func(fd, v, v_len);
-
-			if (bytes_transfered == -1)
-				return -1;
+	return true;
+}
 
-			if (bytes_transfered == 0)
-				return bytes_transfered_total;
 
-			v_len -= bytes_transfered;
-			v += bytes_transfered;
-			bytes_transfered_total += bytes_transfered;
-		}
+/*
+ * The segments are passed as a whole to the plugin, which may transfer
+ * them in one operation.
+ */
 
-		iov++;
-		iovcnt--;
+extern "C" ssize_t readv(int libc_fd, const struct iovec *iov, int iovcnt)
+{
+	if (!valid_iovec(iov, iovcnt)) {
+		errno = EINVAL;
+		return -1;
 	}
 
-	return bytes_transfered_total;
-}
-
+	Mutex::Guard guard(rw_mutex());
 
-extern "C" ssize_t readv(int fd, const struct iovec *iov, int iovcnt)
-{
-	return readv_writev_impl(Read(), fd, iov, iovcnt);
+	FD_FUNC_WRAPPER(readv, libc_fd, iov, iovcnt);
 }
 
 extern "C" __attribute__((alias("readv")))
@@ -110,9 +78,21 @@ extern "C" __attribute__((alias("readv")))
 ssize_t _readv(int fd, const struct iovec *iov, int iovcnt);
 
 
-extern "C" ssize_t writev(int fd, const struct iovec *iov, int iovcnt)
+extern "C" ssize_t writev(int libc_fd, const struct iovec *iov, int iovcnt)
 {
-	return readv_writev_impl(Write(), fd, iov, iovcnt);
+	if (!valid_iovec(iov, iovcnt)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	Mutex::Guard guard(rw_mutex());
+
+	int const flags = fcntl(libc_fd, F_GETFL);
+
+	if ((flags != -1) && (flags & O_APPEND))
+		lseek(libc_fd, 0, SEEK_END);
+
+	FD_FUNC_WRAPPER(writev, libc_fd, iov, iovcnt);
 }
 
 extern "C" __attribute__((alias("writev")))
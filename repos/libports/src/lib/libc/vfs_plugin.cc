@@ -386,7 +386,7 @@ Libc::File_descriptor *Libc::Vfs_plugin::open_from_kernel(const char *path, int
 	}
 
 	handle->handler(&_response_handler);
-	fd->flags = flags & (O_ACCMODE|O_NONBLOCK|O_APPEND);
+	fd->flags = flags & (O_ACCMODE|O_NONBLOCK|O_APPEND|O_FSYNC);
 
 	if (flags & O_TRUNC)
 		warning(__func__, ": O_TRUNC is not supported");
@@ -517,7 +517,7 @@ Libc::File_descriptor *Libc::Vfs_plugin::open(char const *path, int flags)
 			}
 
 			handle->handler(&_response_handler);
-			fd->flags = flags & (O_ACCMODE|O_NONBLOCK|O_APPEND);
+			fd->flags = flags & (O_ACCMODE|O_NONBLOCK|O_APPEND|O_FSYNC);
 
 			return Fn::COMPLETE;
 		});
@@ -858,6 +858,14 @@ ssize_t Libc::Vfs_plugin::write(File_descriptor *fd, const void *buf,
 		::off_t            _offset     { 0 };
 		unsigned           _iteration  { 0 };
 
+		/*
+		 * A synchronous write is passed through 'queue_write' and
+		 * 'complete_write', which report the outcome of the write only
+		 * after the back end performed it.
+		 */
+		bool const         _sync       { (fd->flags & O_FSYNC) != 0 };
+		bool               _queued     { false };
+
 		auto _fd_refers_to_continuous_file = [&]
 		{
 			if (!_fd_path) {
@@ -885,7 +893,22 @@ ssize_t Libc::Vfs_plugin::write(File_descriptor *fd, const void *buf,
 				try {
 					char const * const src = (char const *)_buf + _offset;
 
-					_out_result = _handle->fs().write(_handle, src, _count, partial_out_count);
+					if (_sync) {
+						if (!_queued) {
+							if (!_handle->fs().queue_write(_handle, src, _count))
+								return Fn::INCOMPLETE;
+							_queued = true;
+						}
+
+						_out_result = _handle->fs().complete_write(_handle, src, _count,
+						                                           partial_out_count);
+						if (_out_result == Result::WRITE_QUEUED)
+							return Fn::INCOMPLETE;
+
+						_queued = false;
+					} else {
+						_out_result = _handle->fs().write(_handle, src, _count, partial_out_count);
+					}
 				} catch (Vfs::File_io_service::Insufficient_buffer) { return Fn::INCOMPLETE; }
 
 				if (_out_result != Result::WRITE_OK) {
@@ -943,6 +966,8 @@ ssize_t Libc::Vfs_plugin::write(File_descriptor *fd, const void *buf,
 	case Result::WRITE_ERR_IO:          return Errno(EIO);
 	case Result::WRITE_ERR_INTERRUPT:   return Errno(EINTR);
 	case Result::WRITE_OK:              break;
+
+	case Result::WRITE_QUEUED: /* handled by write loop */ break;
 	}
 
 	handle->advance_seek(out_count);
@@ -952,6 +977,109 @@ ssize_t Libc::Vfs_plugin::write(File_descriptor *fd, const void *buf,
 }
 
 
+ssize_t Libc::Vfs_plugin::writev(File_descriptor *fd, const struct iovec *iov,
+                                 int iovcnt)
+{
+	typedef Vfs::File_io_service::Write_result  Result;
+	typedef Vfs::File_io_service::Const_segment Segment;
+
+	if ((fd->flags & O_ACCMODE) == O_RDONLY) {
+		return Errno(EBADF);
+	}
+
+	Vfs::Vfs_handle *handle = vfs_handle(fd);
+
+	enum { MAX_SEGMENTS = 64 };
+
+	ssize_t total = 0;
+
+	/*
+	 * The segments are handed to the VFS in chunks, each of which is
+	 * gathered into one write operation if supported by the file system.
+	 */
+	for (int first = 0; first < iovcnt; first += MAX_SEGMENTS) {
+
+		Segment  segments[MAX_SEGMENTS];
+		unsigned count       = 0;
+		::size_t chunk_bytes = 0;
+
+		for (int i = first; i < iovcnt && count < MAX_SEGMENTS; i++) {
+			segments[count++] = { .start     = (char const *)iov[i].iov_base,
+			                      .num_bytes = iov[i].iov_len };
+			chunk_bytes += iov[i].iov_len;
+		}
+
+		Vfs::file_size out_count  = 0;
+		Result         out_result = Result::WRITE_OK;
+
+		monitor().monitor([&] {
+			try {
+				out_result = handle->fs().writev(handle, segments, count, out_count);
+			} catch (Vfs::File_io_service::Insufficient_buffer) {
+				if (!(fd->flags & O_NONBLOCK))
+					return Fn::INCOMPLETE;
+			}
+			return Fn::COMPLETE;
+		});
+
+		Plugin::resume_all();
+
+		if (out_result != Result::WRITE_OK && total)
+			return total;
+
+		switch (out_result) {
+		case Result::WRITE_ERR_AGAIN:       return Errno(EAGAIN);
+		case Result::WRITE_ERR_WOULD_BLOCK: return Errno(EWOULDBLOCK);
+		case Result::WRITE_ERR_INVALID:     return Errno(EINVAL);
+		case Result::WRITE_ERR_IO:          return Errno(EIO);
+		case Result::WRITE_ERR_INTERRUPT:   return Errno(EINTR);
+		case Result::WRITE_OK:              break;
+
+		case Result::WRITE_QUEUED: /* never returned by 'writev' */ break;
+		}
+
+		handle->advance_seek(out_count);
+		fd->modified = true;
+
+		total += (ssize_t)out_count;
+
+		if (out_count == chunk_bytes)
+			continue;
+
+		if (fd->flags & O_NONBLOCK)
+			return total;
+
+		/*
+		 * Pass the remainder of a partial write, e.g., a chunk exceeding
+		 * the packet size of the file system, to the single-buffer path,
+		 * which takes care of blocking until all bytes are written.
+		 */
+		Vfs::file_size skip = out_count;
+		for (unsigned i = 0; i < count; i++) {
+
+			if (skip >= segments[i].num_bytes) {
+				skip -= segments[i].num_bytes;
+				continue;
+			}
+
+			::size_t const n = (::size_t)(segments[i].num_bytes - skip);
+
+			ssize_t const written = write(fd, segments[i].start + skip, n);
+			if (written == -1)
+				return total ? total : -1;
+
+			total += written;
+			skip   = 0;
+
+			if ((::size_t)written < n)
+				return total;
+		}
+	}
+
+	return total;
+}
+
+
 ssize_t Libc::Vfs_plugin::read(File_descriptor *fd, void *buf,
                                ::size_t count)
 {
@@ -1008,6 +1136,94 @@ ssize_t Libc::Vfs_plugin::read(File_descriptor *fd, void *buf,
 }
 
 
+ssize_t Libc::Vfs_plugin::readv(File_descriptor *fd, const struct iovec *iov,
+                                int iovcnt)
+{
+	if ((fd->flags & O_ACCMODE) == O_WRONLY) {
+		return Errno(EBADF);
+	}
+
+	typedef Vfs::File_io_service::Read_result Result;
+	typedef Vfs::File_io_service::Segment     Segment;
+
+	Vfs::Vfs_handle *handle = vfs_handle(fd);
+
+	if (fd->flags & O_DIRECTORY)
+		return Errno(EISDIR);
+
+	enum { MAX_SEGMENTS = 64 };
+
+	ssize_t total = 0;
+
+	/*
+	 * Each chunk of segments is read by one VFS read operation, which
+	 * scatters the data into the segments. A short read ends the loop.
+	 */
+	for (int first = 0; first < iovcnt; first += MAX_SEGMENTS) {
+
+		Segment  segments[MAX_SEGMENTS];
+		unsigned count       = 0;
+		::size_t chunk_bytes = 0;
+
+		for (int i = first; i < iovcnt && count < MAX_SEGMENTS; i++) {
+			segments[count++] = { .start     = (char *)iov[i].iov_base,
+			                      .num_bytes = iov[i].iov_len };
+			chunk_bytes += iov[i].iov_len;
+		}
+
+		bool succeeded = false;
+		int result_errno = 0;
+		monitor().monitor([&] {
+			if (fd->flags & O_NONBLOCK && !read_ready_from_kernel(fd)) {
+				result_errno = EAGAIN;
+				return Fn::COMPLETE;
+			}
+			succeeded = true;
+			return handle->fs().queue_read(handle, chunk_bytes) ? Fn::COMPLETE : Fn::INCOMPLETE;
+		});
+
+		if (!succeeded) {
+			if (total)
+				return total;
+			return Errno(result_errno);
+		}
+
+		Vfs::file_size out_count = 0;
+		Result         out_result;
+
+		monitor().monitor([&] {
+			out_result = handle->fs().complete_readv(handle, segments, count, out_count);
+			return out_result != Result::READ_QUEUED ? Fn::COMPLETE : Fn::INCOMPLETE;
+		});
+
+		Plugin::resume_all();
+
+		if (out_result != Result::READ_OK && total)
+			return total;
+
+		switch (out_result) {
+		case Result::READ_ERR_AGAIN:       return Errno(EAGAIN);
+		case Result::READ_ERR_WOULD_BLOCK: return Errno(EWOULDBLOCK);
+		case Result::READ_ERR_INVALID:     return Errno(EINVAL);
+		case Result::READ_ERR_IO:          return Errno(EIO);
+		case Result::READ_ERR_INTERRUPT:   return Errno(EINTR);
+		case Result::READ_OK:              break;
+
+		case Result::READ_QUEUED: /* handled above, so never reached */ break;
+		}
+
+		handle->advance_seek(out_count);
+
+		total += (ssize_t)out_count;
+
+		if (out_count < chunk_bytes)
+			break;
+	}
+
+	return total;
+}
+
+
 ssize_t Libc::Vfs_plugin::getdirentries(File_descriptor *fd, char *buf,
                                         ::size_t nbytes, ::off_t *basep)
 {
@@ -151,6 +151,16 @@ class Block::Request_stream : Genode::Noncopyable
 		template <typename FN>
 		void with_payload(FN const &fn) const { fn(_payload); }
 
+		/**
+		 * Call functor 'fn' with the local base address and size of the
+		 * communication buffer as arguments
+		 *
+		 * This allows a driver to prepare the whole buffer for I/O at once,
+		 * e.g., by registering it at the kernel.
+		 */
+		template <typename FN>
+		void with_buffer(FN const &fn) const { fn(_payload._base, _payload._size); }
+
 		/**
 		 * Call functor 'fn' with the pointer and size to the 'request' content
 		 *
@@ -0,0 +1,570 @@
+/*
+ * \brief  Scheduler for block requests of multiple sessions
+ * \author Stefan Kalkowski
+ * \date   2022-07-25
+ *
+ * The scheduler sits between the request streams of the sessions of a block
+ * server and the device (or back-end session) shared by them. Requests are
+ * queued per session and handed out in batches. A batch covers adjacent
+ * requests of one session merged into one operation, or a part of a request
+ * exceeding the maximum transfer size. The requests of a session are handed
+ * out in the order of their submission.
+ *
+ * The bandwidth of the device is shared among the sessions according to their
+ * weight. In addition, a session may request a deadline for its requests.
+ * Requests whose deadline expired are dispatched first, in the order of their
+ * deadlines.
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__BLOCK__SCHEDULER_H_
+#define _INCLUDE__BLOCK__SCHEDULER_H_
+
+/* Genode includes */
+#include <base/registry.h>
+#include <base/session_label.h>
+#include <block/request.h>
+#include <util/misc_math.h>
+#include <util/xml_generator.h>
+#include <util/xml_node.h>
+
+namespace Block { class Scheduler; }
+
+
+class Block::Scheduler : Genode::Noncopyable
+{
+	public:
+
+		typedef Genode::uint64_t time_us_t;
+
+		enum {
+			QUEUE_SIZE   = 64, /* requests queued per session */
+			MAX_SEGMENTS = 16, /* requests merged into one batch */
+		};
+
+		/**
+		 * Scheduling parameters of a session
+		 */
+		struct Policy
+		{
+			unsigned  weight;      /* share of the device bandwidth */
+			time_us_t deadline_us; /* maximum queuing delay, 0 for none */
+
+			/**
+			 * Read the 'weight' and 'deadline_ms' attributes of a
+			 * session policy
+			 */
+			static Policy from_xml(Genode::Xml_node const &node)
+			{
+				return {
+					.weight      = Genode::max(node.attribute_value("weight", 1u), 1u),
+					.deadline_us = node.attribute_value("deadline_ms", 0ULL)*1000 };
+			}
+		};
+
+		class Client;
+
+		/**
+		 * Operation to be issued at the device
+		 *
+		 * The payload of a batch is contiguous within the communication
+		 * buffer of the client.
+		 */
+		struct Batch
+		{
+			struct Segment
+			{
+				unsigned      entry; /* index within the client queue */
+				block_count_t count;
+			};
+
+			unsigned long client;    /* identifier of the client */
+			Operation     operation;
+			off_t         offset;    /* payload offset in the client buffer */
+			Genode::addr_t cookie;   /* cookie of the first request, advanced
+			                            by the offset of the batch within it */
+			unsigned      segments;
+			Segment       segment[MAX_SEGMENTS];
+		};
+
+	private:
+
+		struct Entry
+		{
+			enum class State { FREE, QUEUED, DISPATCHED, DONE };
+
+			State          state      { State::FREE };
+			Request        request    { };
+			Genode::addr_t cookie     { 0 };
+			Genode::uint64_t seq      { 0 };
+			time_us_t      arrival    { 0 };
+			block_count_t  dispatched { 0 }; /* blocks passed to the device */
+			block_count_t  completed  { 0 }; /* blocks completed by the device */
+			bool           failed     { false };
+
+			block_count_t remaining() const
+			{
+				return request.operation.count - dispatched;
+			}
+		};
+
+		/*
+		 * Fixed-point scale of the virtual time charged per block
+		 */
+		enum { WEIGHT_SCALE = 1024 };
+
+		Genode::size_t const _block_size;
+		block_count_t  const _max_transfer;
+
+		Genode::Registry<Client> _clients { };
+
+		unsigned long _client_id { 0 };
+
+		/* virtual time of the client served last */
+		Genode::uint64_t _vtime { 0 };
+
+		unsigned _in_flight     { 0 };
+		unsigned _max_in_flight { 0 };
+
+		inline Client *_select(time_us_t now);
+
+		inline void _build(Client &client, Batch &batch);
+
+		inline void _commit(Client &client, Batch const &batch);
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param block_size    block size of the device
+		 * \param max_transfer  maximum number of blocks of a batch
+		 */
+		Scheduler(Genode::size_t block_size, block_count_t max_transfer)
+		:
+			_block_size(block_size),
+			_max_transfer(Genode::max(max_transfer, (block_count_t)1))
+		{ }
+
+		/**
+		 * Hand out the next batch
+		 *
+		 * The functor 'fn' is called with the 'Batch' as argument and
+		 * returns true if the batch got issued at the device. Otherwise,
+		 * the batch remains queued.
+		 *
+		 * \param now  current time in microseconds
+		 *
+		 * \return  true if a batch got issued
+		 */
+		template <typename FN>
+		bool dispatch(time_us_t now, FN const &fn);
+
+		/**
+		 * Account the completion of a batch issued before
+		 *
+		 * Batches of clients that vanished in the meantime are ignored.
+		 */
+		inline void completed(Batch const &batch, bool success, time_us_t now);
+
+		/**
+		 * Number of batches issued but not completed yet
+		 */
+		unsigned in_flight() const { return _in_flight; }
+
+		/**
+		 * Generate statistics of all clients
+		 */
+		inline void report(Genode::Xml_generator &xml);
+};
+
+
+class Block::Scheduler::Client : Genode::Noncopyable
+{
+	private:
+
+		friend class Scheduler;
+
+		Scheduler &_scheduler;
+
+		Genode::Registry<Client>::Element _element;
+
+		unsigned long const _id;
+
+		Genode::Session_label const _label;
+		Policy                const _policy;
+
+		Entry _entries[QUEUE_SIZE] { };
+
+		Genode::uint64_t _seq    { 0 };
+		unsigned         _used   { 0 }; /* entries not yet acknowledged */
+		unsigned         _queued { 0 }; /* entries not fully dispatched */
+
+		/* service received so far, scaled by the weight */
+		Genode::uint64_t _vtime { 0 };
+
+		struct Statistics
+		{
+			unsigned long requests;
+			unsigned long batches;
+			unsigned long merged;    /* batches covering multiple requests */
+			unsigned long split;     /* batches covering part of a request */
+			unsigned long completed;
+			unsigned long missed;    /* requests dispatched after deadline */
+			unsigned      max_queued;
+			time_us_t     latency_sum;
+			time_us_t     latency_max;
+		} _stats { };
+
+		/**
+		 * Return index of the oldest entry with blocks left to dispatch
+		 */
+		unsigned _head() const
+		{
+			unsigned head = QUEUE_SIZE;
+			for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+				if (_entries[i].state != Entry::State::QUEUED)
+					continue;
+				if (head == QUEUE_SIZE || _entries[i].seq < _entries[head].seq)
+					head = i;
+			}
+			return head;
+		}
+
+		time_us_t _deadline(Entry const &entry) const
+		{
+			return entry.arrival + _policy.deadline_us;
+		}
+
+		/**
+		 * Return true if the deadline of the entry is reached
+		 */
+		bool _expired(Entry const &entry, time_us_t now) const
+		{
+			return _policy.deadline_us && _deadline(entry) <= now;
+		}
+
+	public:
+
+		Client(Scheduler &scheduler, Genode::Session_label const &label,
+		       Policy const &policy)
+		:
+			_scheduler(scheduler), _element(scheduler._clients, *this),
+			_id(++scheduler._client_id), _label(label), _policy(policy)
+		{ }
+
+		/**
+		 * Queue request
+		 *
+		 * \param cookie  client-specific value, e.g., the local address
+		 *                of the payload
+		 * \param now     current time in microseconds
+		 *
+		 * \return  false if the queue of the client is full
+		 */
+		bool submit(Request const &request, Genode::addr_t cookie, time_us_t now)
+		{
+			if (_used == QUEUE_SIZE)
+				return false;
+
+			unsigned i = 0;
+			while (_entries[i].state != Entry::State::FREE)
+				i++;
+
+			/* do not let a formerly idle client catch up on service */
+			if (!_queued)
+				_vtime = Genode::max(_vtime, _scheduler._vtime);
+
+			Entry &entry = _entries[i];
+			entry.state      = Entry::State::QUEUED;
+			entry.request    = request;
+			entry.cookie     = cookie;
+			entry.seq        = _seq++;
+			entry.arrival    = now;
+			entry.dispatched = 0;
+			entry.completed  = 0;
+			entry.failed     = false;
+
+			_used++;
+			_queued++;
+			_stats.requests++;
+			_stats.max_queued = Genode::max(_stats.max_queued, _used);
+			return true;
+		}
+
+		/**
+		 * Identifier referred to by the batches of the client
+		 */
+		unsigned long id() const { return _id; }
+
+		/**
+		 * Number of requests with blocks not yet handed out to the device
+		 */
+		unsigned queued() const { return _queued; }
+
+		/**
+		 * Return true if no request is pending
+		 */
+		bool idle() const { return _used == 0; }
+
+		/**
+		 * Call 'fn' for each completed request
+		 *
+		 * The functor is called with the 'Request' as argument and returns
+		 * true if the request got acknowledged. The iteration stops at the
+		 * first request that could not be acknowledged.
+		 */
+		template <typename FN>
+		void with_completed(FN const &fn)
+		{
+			for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+
+				Entry &entry = _entries[i];
+				if (entry.state != Entry::State::DONE)
+					continue;
+
+				Request request = entry.request;
+				request.success = !entry.failed;
+
+				if (!fn(request))
+					return;
+
+				entry.state = Entry::State::FREE;
+				_used--;
+			}
+		}
+};
+
+
+Block::Scheduler::Client *Block::Scheduler::_select(time_us_t now)
+{
+	Client   *fair = nullptr;
+	Client   *edf  = nullptr;
+	time_us_t edf_deadline = 0;
+
+	_clients.for_each([&] (Client &client) {
+
+		if (!client._queued)
+			return;
+
+		Entry const &head = client._entries[client._head()];
+
+		if (client._expired(head, now)) {
+			time_us_t const deadline = client._deadline(head);
+
+			if (!edf || deadline < edf_deadline) {
+				edf          = &client;
+				edf_deadline = deadline;
+			}
+		}
+
+		if (!fair || client._vtime < fair->_vtime)
+			fair = &client;
+	});
+
+	return edf ? edf : fair;
+}
+
+
+void Block::Scheduler::_build(Client &client, Batch &batch)
+{
+	using Type = Operation::Type;
+
+	unsigned const head  = client._head();
+	Entry    const &entry = client._entries[head];
+
+	Type const type = entry.request.operation.type;
+
+	batch.client   = client._id;
+	batch.segments = 1;
+	batch.offset   = entry.request.offset
+	               + (off_t)(entry.dispatched * _block_size);
+	batch.cookie   = entry.cookie + entry.dispatched * _block_size;
+
+	/* operations without payload are neither split nor merged */
+	if (!Operation::has_payload(type)) {
+		batch.operation  = entry.request.operation;
+		batch.segment[0] = { head, entry.request.operation.count };
+		return;
+	}
+
+	block_count_t const count = Genode::min(entry.remaining(), _max_transfer);
+
+	batch.operation = { .type         = type,
+	                    .block_number = entry.request.operation.block_number
+	                                  + entry.dispatched,
+	                    .count        = count };
+	batch.segment[0] = { head, count };
+
+	if (entry.dispatched || count < entry.request.operation.count)
+		return;
+
+	/*
+	 * Append queued requests that follow the batch on the device as well as
+	 * within the communication buffer. Only the direct successor in the order
+	 * of submission is appended, so a request never overtakes an earlier
+	 * request of the client, e.g., a read an overlapping write.
+	 */
+	Genode::uint64_t seq = entry.seq;
+
+	while (batch.segments < MAX_SEGMENTS) {
+
+		block_number_t const next_block  = batch.operation.block_number
+		                                 + batch.operation.count;
+		off_t          const next_offset = batch.offset
+		                                 + (off_t)(batch.operation.count * _block_size);
+
+		unsigned next = QUEUE_SIZE;
+		for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+
+			Entry const &e = client._entries[i];
+
+			if (e.state == Entry::State::QUEUED && e.seq == seq + 1) {
+				next = i;
+				break;
+			}
+		}
+
+		if (next == QUEUE_SIZE)
+			break;
+
+		Entry const &e = client._entries[next];
+
+		if (e.dispatched
+		 || e.request.operation.type         != type
+		 || e.request.operation.block_number != next_block
+		 || e.request.offset                 != next_offset
+		 || e.request.operation.count        >  _max_transfer
+		                                      - batch.operation.count)
+			break;
+
+		batch.segment[batch.segments++] = { next, e.request.operation.count };
+		batch.operation.count += e.request.operation.count;
+		seq = e.seq;
+	}
+}
+
+
+void Block::Scheduler::_commit(Client &client, Batch const &batch)
+{
+	for (unsigned i = 0; i < batch.segments; i++) {
+
+		Entry &entry = client._entries[batch.segment[i].entry];
+
+		entry.dispatched += batch.segment[i].count;
+
+		if (entry.remaining() == 0 || !Operation::has_payload(entry.request.operation.type)) {
+			entry.state = Entry::State::DISPATCHED;
+			client._queued--;
+		}
+	}
+
+	client._stats.batches++;
+	if (batch.segments > 1)
+		client._stats.merged++;
+	if (batch.operation.count
+	  < client._entries[batch.segment[0].entry].request.operation.count)
+		client._stats.split++;
+
+	/* charge the client for the transferred blocks, at least one */
+	block_count_t const blocks = Genode::max(batch.operation.count, (block_count_t)1);
+	client._vtime += blocks * WEIGHT_SCALE / client._policy.weight;
+	_vtime = client._vtime;
+
+	_in_flight++;
+	_max_in_flight = Genode::max(_max_in_flight, _in_flight);
+}
+
+
+template <typename FN>
+bool Block::Scheduler::dispatch(time_us_t now, FN const &fn)
+{
+	Client *client = _select(now);
+	if (!client)
+		return false;
+
+	Entry const &head = client->_entries[client->_head()];
+	bool  const  late = !head.dispatched && client->_expired(head, now);
+
+	Batch batch { };
+	_build(*client, batch);
+
+	if (!fn(static_cast<Batch const &>(batch)))
+		return false;
+
+	if (late)
+		client->_stats.missed++;
+
+	_commit(*client, batch);
+	return true;
+}
+
+
+void Block::Scheduler::completed(Batch const &batch, bool success, time_us_t now)
+{
+	if (_in_flight)
+		_in_flight--;
+
+	_clients.for_each([&] (Client &client) {
+
+		if (client._id != batch.client)
+			return;
+
+		for (unsigned i = 0; i < batch.segments; i++) {
+
+			Entry &entry = client._entries[batch.segment[i].entry];
+
+			entry.completed += batch.segment[i].count;
+			entry.failed    |= !success;
+
+			if (entry.state != Entry::State::DISPATCHED
+			 || entry.completed < entry.request.operation.count)
+				continue;
+
+			entry.state = Entry::State::DONE;
+			client._stats.completed++;
+
+			time_us_t const latency = now > entry.arrival ? now - entry.arrival : 0;
+			client._stats.latency_sum += latency;
+			client._stats.latency_max  = Genode::max(client._stats.latency_max, latency);
+		}
+	});
+}
+
+
+void Block::Scheduler::report(Genode::Xml_generator &xml)
+{
+	xml.attribute("in_flight",     _in_flight);
+	xml.attribute("max_in_flight", _max_in_flight);
+
+	_clients.for_each([&] (Client const &client) {
+		xml.node("session", [&] () {
+
+			Client::Statistics const &stats = client._stats;
+
+			xml.attribute("label",       client._label);
+			xml.attribute("weight",      client._policy.weight);
+			if (client._policy.deadline_us)
+				xml.attribute("deadline_ms", client._policy.deadline_us / 1000);
+			xml.attribute("queued",      client._used);
+			xml.attribute("max_queued",  stats.max_queued);
+			xml.attribute("requests",    stats.requests);
+			xml.attribute("batches",     stats.batches);
+			xml.attribute("merged",      stats.merged);
+			xml.attribute("split",       stats.split);
+			if (client._policy.deadline_us)
+				xml.attribute("missed",  stats.missed);
+			xml.attribute("avg_latency_us",
+			              stats.completed ? stats.latency_sum / stats.completed : 0);
+			xml.attribute("max_latency_us", stats.latency_max);
+		});
+	});
+}
+
+#endif /* _INCLUDE__BLOCK__SCHEDULER_H_ */
@@ -88,6 +88,12 @@ struct Block::Connection : Genode::Connection<Session>, Session_client
 
 				bool _completed = false;
 
+				/*
+				 * The payload was placed into the packet-stream buffer by
+				 * the application
+				 */
+				bool const _preallocated = false;
+
 				/*
 				 * A job undergoes three stages. The transition from one
 				 * stage to the next happens 'update_jobs'.
@@ -141,7 +147,7 @@ struct Block::Connection : Genode::Connection<Session>, Session_client
 
 					Packet_descriptor const p(_curr_operation(), _payload, tag);
 
-					if (_operation.type == Operation::Type::WRITE)
+					if (_operation.type == Operation::Type::WRITE && !_preallocated)
 						_with_offset_and_length(job, [&] (off_t offset, size_t length) {
 							policy.produce_write_content(job, offset,
 							                             tx.packet_content(p),
@@ -158,6 +164,28 @@ struct Block::Connection : Genode::Connection<Session>, Session_client
 					_connection._pending.enqueue(_pending_elem);
 				}
 
+				/**
+				 * Constructor of a job with preallocated payload
+				 *
+				 * \param offset  position of the payload within the
+				 *                packet-stream buffer
+				 *
+				 * The payload is neither produced nor consumed via the
+				 * 'Update_jobs_policy' and it is not released once the job
+				 * is completed. This way, an application that shares the
+				 * packet-stream buffer with its own clients can pass
+				 * requests to the server without copying their content.
+				 */
+				Job(Connection &connection, Operation operation, off_t offset)
+				:
+					_connection(connection), _operation(operation),
+					_payload({ .offset = offset,
+					           .bytes  = operation.count * connection._info.block_size }),
+					_preallocated(true)
+				{
+					_connection._pending.enqueue(_pending_elem);
+				}
+
 				~Job()
 				{
 					if (pending()) {
@@ -371,14 +399,14 @@ bool Block::Connection<JOB>::_try_process_ack(POLICY &policy, Tx::Source &tx)
 	try {
 		_tags.template apply<_JOB>(id, [&] (_JOB &job) {
 
-			if (type == Operation::Type::READ)
+			/* needed to access private members of 'Job' (friend) */
+			Job &job_base = job;
+
+			if (type == Operation::Type::READ && !job_base._preallocated)
 				Job::_with_offset_and_length(job, [&] (off_t offset, size_t length) {
 					policy.consume_read_result(job, offset,
 					                           tx.packet_content(p), length); });
 
-			/* needed to access private members of 'Job' (friend) */
-			Job &job_base = job;
-
 			bool const partial_read_or_write =
 				p.succeeded() &&
 				Operation::has_payload(type) &&
@@ -391,12 +419,22 @@ bool Block::Connection<JOB>::_try_process_ack(POLICY &policy, Tx::Source &tx)
 				 * existing payload allocation within the packet stream.
 				 */
 				job_base._position += p.block_count();
+
+				/* advance within the preallocated payload */
+				if (job_base._preallocated) {
+					size_t const bytes = p.block_count()*_info.block_size;
+					job_base._payload.offset += bytes;
+					job_base._payload.bytes  -= bytes;
+				}
+
 				job_base._submit(policy, job, tx);
 
 				release_packet = false;
 
 			} else {
 
+				release_packet = !job_base._preallocated;
+
 				job_base._completed = true;
 				job_base._tag.destruct();
 
@@ -442,6 +480,11 @@ bool Block::Connection<JOB>::_try_submit_pending_job(POLICY &policy, Tx::Source
 			if (!Operation::has_payload(job._operation.type))
 				return;
 
+			if (job._preallocated) {
+				payload = job._payload;
+				return;
+			}
+
 			size_t const bytes = _info.block_size * job._curr_operation().count;
 
 			payload = { .offset = tx.alloc_packet(bytes, (unsigned)_info.align_log2).offset(),
@@ -1,5 +1,5 @@
 /*
- * \brief  Computing the Internet Checksum (conforms to RFC 1071)
+ * \brief  Computing the Internet Checksum (conforms to RFC 1071 and RFC 1624)
  * \author Martin Stein
  * \date   2018-03-23
  */
@@ -20,6 +20,8 @@
 
 namespace Net {
 
+	class Internet_checksum_diff;
+
 	/**
 	 * This struct helps avoiding the following compiler warning when using
 	 * the internet checksum functions on packet classes (like
@@ -54,4 +56,46 @@ namespace Net {
 	                                             Ipv4_address          &ip_dst);
 }
 
+
+/**
+ * Accumulated modifications of checksummed data
+ *
+ * Instead of re-summing the whole data after modifying a few header fields,
+ * the one's complement differences of the modified 16-bit words are added up
+ * and applied to the former checksum afterwards (RFC 1624, equation 3). The
+ * cost of updating a checksum thereby doesn't depend on the data size.
+ */
+class Net::Internet_checksum_diff
+{
+	private:
+
+		Genode::addr_t _value { 0 };
+
+	public:
+
+		/**
+		 * Add up the difference caused by replacing 'old_data' with 'new_data'
+		 *
+		 * \param data_sz  size of both buffers in bytes, must be even
+		 *
+		 * The modified data is expected to start at an even offset within the
+		 * checksummed data.
+		 */
+		void add_up_diff(Packed_uint16 const *new_data,
+		                 Packed_uint16 const *old_data,
+		                 Genode::size_t       data_sz);
+
+		/**
+		 * Add up the differences accumulated by another object
+		 */
+		void add_up_diff(Internet_checksum_diff const &icd);
+
+		/**
+		 * Return checksum 'sum' adapted by the accumulated differences
+		 *
+		 * Both, 'sum' and the return value, are in network byte order.
+		 */
+		Genode::uint16_t apply_to(Genode::uint16_t sum) const;
+};
+
 #endif /* _NET__INTERNET_CHECKSUM_H_ */
@@ -31,6 +31,7 @@ namespace Net {
 
 	class Ipv4_address;
 	class Ipv4_packet;
+	class Internet_checksum_diff;
 
 	static inline Genode::size_t ascii_to(char const *, Net::Ipv4_address &);
 }
@@ -94,6 +95,11 @@ class Net::Ipv4_packet
 
 		void update_checksum();
 
+		/**
+		 * Update checksum incrementally by applying modifications in 'icd'
+		 */
+		void update_checksum(Internet_checksum_diff const &icd);
+
 		bool checksum_error() const;
 
 	private:
@@ -209,6 +215,12 @@ class Net::Ipv4_packet
 		void src_big_endian(Genode::uint32_t v)  { *(Genode::uint32_t *)&_src = v; }
 		void dst_big_endian(Genode::uint32_t v)  { *(Genode::uint32_t *)&_dst = v; }
 
+		/**
+		 * Set address and add up the modification to 'icd'
+		 */
+		void src(Ipv4_address v, Internet_checksum_diff &icd);
+		void dst(Ipv4_address v, Internet_checksum_diff &icd);
+
 		void flags(Genode::uint8_t v)
 		{
 			Genode::uint16_t be = host_to_big_endian(_offset_6_u16);
@@ -72,6 +72,14 @@ class Net::Tcp_packet
 		                     Ipv4_address ip_dst,
 		                     size_t       tcp_size);
 
+		/**
+		 * Update checksum incrementally by applying modifications in 'icd'
+		 *
+		 * Modifications of the IPv4 addresses must be contained in 'icd' as
+		 * well because they are part of the pseudo header.
+		 */
+		void update_checksum(Internet_checksum_diff const &icd);
+
 
 		/***************
 		 ** Accessors **
@@ -99,6 +107,12 @@ class Net::Tcp_packet
 		void src_port(Port p) { _src_port = host_to_big_endian(p.value); }
 		void dst_port(Port p) { _dst_port = host_to_big_endian(p.value); }
 
+		/**
+		 * Set port and add up the modification to 'icd'
+		 */
+		void src_port(Port p, Internet_checksum_diff &icd);
+		void dst_port(Port p, Internet_checksum_diff &icd);
+
 
 		/*********
 		 ** log **
@@ -84,6 +84,15 @@ class Net::Udp_packet
 		void update_checksum(Ipv4_address ip_src,
 		                     Ipv4_address ip_dst);
 
+		/**
+		 * Update checksum incrementally by applying modifications in 'icd'
+		 *
+		 * Modifications of the IPv4 addresses must be contained in 'icd' as
+		 * well because they are part of the pseudo header. A zero checksum
+		 * (not computed by the sender) remains untouched.
+		 */
+		void update_checksum(Internet_checksum_diff const &icd);
+
 		bool checksum_error(Ipv4_address ip_src,
 		                    Ipv4_address ip_dst) const;
 
@@ -103,6 +112,12 @@ class Net::Udp_packet
 		void src_port_big_endian(Genode::uint16_t v) { _src_port = v; }
 		void dst_port_big_endian(Genode::uint16_t v) { _dst_port = v; }
 
+		/**
+		 * Set port and add up the modification to 'icd'
+		 */
+		void src_port(Port p, Internet_checksum_diff &icd);
+		void dst_port(Port p, Internet_checksum_diff &icd);
+
 
 		/*********
 		 ** log **
@@ -1,5 +1,5 @@
 /*
- * \brief  Fast-bitmap allocator for NIC-session packet streams
+ * \brief  Packet allocators for NIC-session packet streams
  * \author Sebastian Sumpf
  * \date   2012-07-30
  *
@@ -17,9 +17,15 @@
 #define _INCLUDE__NIC__PACKET_ALLOCATOR__
 
 #include <os/packet_allocator.h>
+#include <os/buddy_packet_allocator.h>
 #include <base/log.h>
 
-namespace Nic { struct Packet_allocator; }
+namespace Nic {
+
+	template <typename> struct Offset_packet_allocator;
+	struct Packet_allocator;
+	struct Buddy_packet_allocator;
+}
 
 
 /**
@@ -38,8 +44,12 @@ namespace Nic { struct Packet_allocator; }
  * Genode::Packet_allocator. As DEFAULT_PACKET_SIZE is used for the
  * transmission-buffer calculation we could not change it without breaking the
  * API. OFFSET_PACKET_SIZE reflects the actual (usable) packet-buffer size.
+ *
+ * The BACKEND manages the packet buffer, see 'Nic::Packet_allocator' and
+ * 'Nic::Buddy_packet_allocator' below.
  */
-struct Nic::Packet_allocator : Genode::Packet_allocator
+template <typename BACKEND>
+struct Nic::Offset_packet_allocator : BACKEND
 {
 	enum {
 		DEFAULT_PACKET_SIZE = 1600,
@@ -49,13 +59,16 @@ struct Nic::Packet_allocator : Genode::Packet_allocator
 
 	typedef Genode::size_t size_t;
 
+	using Alloc_result = typename BACKEND::Alloc_result;
+	using Alloc_error  = typename BACKEND::Alloc_error;
+
 	/**
 	 * Constructor
 	 *
 	 * \param md_alloc  Meta-data allocator
 	 */
-	Packet_allocator(Genode::Allocator *md_alloc)
-	: Genode::Packet_allocator(md_alloc, DEFAULT_PACKET_SIZE) {}
+	Offset_packet_allocator(Genode::Allocator *md_alloc)
+	: BACKEND(md_alloc, DEFAULT_PACKET_SIZE) {}
 
 	Alloc_result try_alloc(size_t size) override
 	{
@@ -64,7 +77,7 @@ struct Nic::Packet_allocator : Genode::Packet_allocator
 			return Alloc_result { Alloc_error::DENIED };
 		}
 
-		Alloc_result result = Genode::Packet_allocator::try_alloc(size + OFFSET);
+		Alloc_result result = BACKEND::try_alloc(size + OFFSET);
 
 		result.with_result(
 			[&] (void *content) {
@@ -90,10 +103,31 @@ struct Nic::Packet_allocator : Genode::Packet_allocator
 			return;
 		}
 
-		Genode::Packet_allocator::free((Genode::uint8_t *)addr - OFFSET, size + OFFSET);
+		BACKEND::free((Genode::uint8_t *)addr - OFFSET, size + OFFSET);
 	}
+};
+
+
+/**
+ * Default NIC packet allocator based on the fast-bitmap allocator
+ */
+struct Nic::Packet_allocator : Offset_packet_allocator<Genode::Packet_allocator>
+{
+	Packet_allocator(Genode::Allocator *md_alloc)
+	: Offset_packet_allocator(md_alloc) { }
+};
 
 
+/**
+ * NIC packet allocator with bounded allocation costs
+ *
+ * Can be used instead of 'Nic::Packet_allocator' for sessions with a high
+ * packet rate where the buffer tends to become fragmented.
+ */
+struct Nic::Buddy_packet_allocator : Offset_packet_allocator<Genode::Buddy_packet_allocator>
+{
+	Buddy_packet_allocator(Genode::Allocator *md_alloc)
+	: Offset_packet_allocator(md_alloc) { }
 };
 
 #endif /* _INCLUDE__NIC__PACKET_ALLOCATOR__ */
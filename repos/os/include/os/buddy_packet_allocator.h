@@ -0,0 +1,278 @@
+/*
+ * \brief  Buddy allocator for packet streams
+ * \author Stefan Kalkowski
+ * \date   2022-06-27
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__OS__BUDDY_PACKET_ALLOCATOR_H_
+#define _INCLUDE__OS__BUDDY_PACKET_ALLOCATOR_H_
+
+#include <base/allocator.h>
+#include <util/string.h>
+
+namespace Genode { class Buddy_packet_allocator; }
+
+
+/**
+ * Alternative to 'Packet_allocator' with bounded allocation costs
+ *
+ * Like the 'Packet_allocator', this allocator manages the bulk buffer of a
+ * packet stream in units of a minimal block size. Free chunks are kept in
+ * one free list per power-of-two block count (order). A bit mask of the
+ * non-empty lists yields the smallest fitting chunk without any search. A
+ * chunk that is larger than requested is split. The unused tail goes back to
+ * the free lists. On release, a chunk gets merged with its free buddies.
+ *
+ * Hence, allocating and releasing a packet costs at most a number of steps
+ * proportional to the number of orders, independent of the fragmentation of
+ * the buffer. Single-block packets, for instance MTU-sized NIC packets, are
+ * usually served directly from the order-0 list in constant time.
+ *
+ * The meta data comprises nine bytes per block, which is more than the one
+ * bit per block of the 'Packet_allocator'.
+ */
+class Genode::Buddy_packet_allocator : public Genode::Range_allocator
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Buddy_packet_allocator(Buddy_packet_allocator const &);
+		Buddy_packet_allocator &operator = (Buddy_packet_allocator const &);
+
+		enum : uint8_t  { NOT_FREE  = 0xff };
+		enum : unsigned { MAX_ORDER = sizeof(addr_t) * 8 - 1 };
+		enum : uint32_t { NIL       = ~(uint32_t)0 };
+
+		Allocator *_md_alloc;                   /* meta-data allocator            */
+		size_t     _block_size;                 /* granularity of allocations     */
+		addr_t     _base       = 0;             /* allocation base                */
+		uint32_t   _blocks     = 0;             /* number of managed blocks       */
+		void      *_md         = nullptr;       /* meta data of all blocks        */
+		uint32_t  *_next       = nullptr;       /* free-list successor per chunk  */
+		uint32_t  *_prev       = nullptr;       /* free-list predecessor          */
+		uint8_t   *_order      = nullptr;       /* order of free chunk or NOT_FREE */
+		uint32_t   _head[MAX_ORDER + 1] { };    /* first free chunk per order     */
+		addr_t     _nonempty   = 0;             /* bit mask of non-empty orders   */
+		size_t     _free       = 0;             /* number of free blocks          */
+
+		static size_t _md_size(uint32_t blocks)
+		{
+			return blocks * (2 * sizeof(uint32_t) + sizeof(uint8_t));
+		}
+
+		static unsigned _log2_floor(addr_t value)
+		{
+			return (unsigned)(sizeof(addr_t) * 8 - 1 - __builtin_clzl(value));
+		}
+
+		static unsigned _log2_ceil(addr_t value)
+		{
+			unsigned const floor = _log2_floor(value);
+			return (value & (value - 1)) ? floor + 1 : floor;
+		}
+
+		size_t _blocks_cnt(size_t size) const
+		{
+			return (size % _block_size) ? size / _block_size + 1
+			                            : size / _block_size;
+		}
+
+		void _insert(uint32_t idx, unsigned order)
+		{
+			_order[idx] = (uint8_t)order;
+			_prev[idx]  = NIL;
+			_next[idx]  = _head[order];
+			if (_head[order] != NIL)
+				_prev[_head[order]] = idx;
+
+			_head[order] = idx;
+			_nonempty   |= (addr_t)1 << order;
+			_free       += (size_t)1 << order;
+		}
+
+		void _remove(uint32_t idx)
+		{
+			unsigned const order = _order[idx];
+			if (_prev[idx] != NIL)
+				_next[_prev[idx]] = _next[idx];
+			else
+				_head[order] = _next[idx];
+
+			if (_next[idx] != NIL)
+				_prev[_next[idx]] = _prev[idx];
+
+			_order[idx] = NOT_FREE;
+			_free      -= (size_t)1 << order;
+			if (_head[order] == NIL)
+				_nonempty &= ~((addr_t)1 << order);
+		}
+
+		/**
+		 * Return chunk of 2^order blocks at 'idx' and merge it with buddies
+		 */
+		void _release_chunk(uint32_t idx, unsigned order)
+		{
+			while (order < MAX_ORDER) {
+				addr_t const buddy = (addr_t)idx ^ ((addr_t)1 << order);
+				if (buddy >= _blocks || _order[buddy] != order)
+					break;
+
+				_remove((uint32_t)buddy);
+				idx = (uint32_t)(idx & ~((addr_t)1 << order));
+				order++;
+			}
+			_insert(idx, order);
+		}
+
+		/**
+		 * Return the blocks [idx, idx + cnt) as naturally aligned chunks
+		 */
+		void _release_range(addr_t idx, addr_t cnt)
+		{
+			while (cnt) {
+				unsigned order = _log2_floor(cnt);
+				if (idx) {
+					unsigned const align = (unsigned)__builtin_ctzl(idx);
+					if (align < order)
+						order = align;
+				}
+				_release_chunk((uint32_t)idx, order);
+				idx += (addr_t)1 << order;
+				cnt -= (addr_t)1 << order;
+			}
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param md_alloc       Meta-data allocator
+		 * \param block_size     Granularity of packets in stream
+		 */
+		Buddy_packet_allocator(Allocator *md_alloc, size_t block_size)
+		: _md_alloc(md_alloc), _block_size(block_size) { }
+
+
+		/*******************************
+		 ** Range-allocator interface **
+		 *******************************/
+
+		Range_result add_range(addr_t const base, size_t const size) override
+		{
+			if (_base || _md)
+				return Alloc_error::DENIED;
+
+			size_t const blocks = size / _block_size;
+			if (!blocks || blocks >= NIL)
+				return Alloc_error::DENIED;
+
+			try { _md = _md_alloc->alloc(_md_size((uint32_t)blocks)); }
+			catch (Out_of_ram)  { return Alloc_error::OUT_OF_RAM; }
+			catch (Out_of_caps) { return Alloc_error::OUT_OF_CAPS; }
+			catch (...)         { return Alloc_error::DENIED; }
+
+			_base   = base;
+			_blocks = (uint32_t)blocks;
+			_next   = (uint32_t *)_md;
+			_prev   = _next + _blocks;
+			_order  = (uint8_t *)(_prev + _blocks);
+			memset(_order, NOT_FREE, _blocks);
+
+			for (unsigned order = 0; order <= MAX_ORDER; order++)
+				_head[order] = NIL;
+
+			_nonempty = 0;
+			_free     = 0;
+			_release_range(0, _blocks);
+			return Range_ok();
+		}
+
+		Range_result remove_range(addr_t base, size_t) override
+		{
+			if (_base != base || !_md)
+				return Alloc_error::DENIED;
+
+			_md_alloc->free(_md, _md_size(_blocks));
+			_md       = nullptr;
+			_base     = 0;
+			_blocks   = 0;
+			_nonempty = 0;
+			_free     = 0;
+			return Range_ok();
+		}
+
+		Alloc_result alloc_aligned(size_t size, unsigned, Range) override
+		{
+			return try_alloc(size);
+		}
+
+		Alloc_result try_alloc(size_t size) override
+		{
+			size_t const cnt = _blocks_cnt(size);
+			if (!cnt || !_md || cnt > _blocks)
+				return Alloc_error::DENIED;
+
+			/* find the smallest non-empty order that fits */
+			unsigned const min_order = _log2_ceil(cnt);
+			addr_t   const fitting   = _nonempty & ~(((addr_t)1 << min_order) - 1);
+			if (!fitting)
+				return Alloc_error::DENIED;
+
+			unsigned const order = (unsigned)__builtin_ctzl(fitting);
+			uint32_t const idx   = _head[order];
+			_remove(idx);
+
+			/* give back the part of the chunk that is not needed */
+			_release_range(idx + cnt, ((addr_t)1 << order) - cnt);
+
+			return reinterpret_cast<void *>(idx * _block_size + _base);
+		}
+
+		void free(void *addr, size_t size) override
+		{
+			addr_t const idx = (((addr_t)addr) - _base) / _block_size;
+			size_t const cnt = _blocks_cnt(size);
+			if (!_md || idx >= _blocks || cnt > _blocks - idx)
+				return;
+
+			_release_range(idx, cnt);
+		}
+
+
+		/**
+		 * Return number of free bytes
+		 *
+		 * Note, a packet of this size may not be allocatable if the free
+		 * blocks are fragmented.
+		 */
+		size_t avail() const override { return _free * _block_size; }
+
+		bool valid_addr(addr_t addr) const override
+		{
+			return _md && addr >= _base
+			    && (addr - _base) / _block_size < _blocks;
+		}
+
+
+		/*************
+		 ** Dummies **
+		 *************/
+
+		bool need_size_for_free() const override { return true; }
+		void free(void *) override { }
+		size_t overhead(size_t) const override {  return 0;}
+		Alloc_result alloc_addr(size_t, addr_t) override {
+			return Alloc_error::DENIED; }
+};
+
+#endif /* _INCLUDE__OS__BUDDY_PACKET_ALLOCATOR_H_ */
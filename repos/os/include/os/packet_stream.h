@@ -60,6 +60,34 @@
  * These conditions must be queried before interacting with the queues by
  * using the methods 'packet_avail', 'ready_to_submit', 'ready_to_ack', and
  * 'ack_avail'.
+ *
+ * Under sustained load, the 'packet_avail' and 'ack_avail' signals may be
+ * suppressed by enabling the adaptive polling of the receiving side via
+ * 'adaptive_polling'. Once its queue is drained, the receiving side then
+ * polls the queue a configurable number of times via 'poll_packet_avail'
+ * respectively 'poll_ack_avail' before it relies on the signal again. While
+ * the receiving side is polling, the other side omits the signal. Like with
+ * interrupt moderation, the threshold trades CPU time for fewer signals.
+ *
+ * A packet descriptor refers to its payload by an offset within the
+ * communication buffer of one particular stream, and this buffer also hosts
+ * the queues of the stream. A packet obtained from the sink of one stream
+ * thus cannot be submitted as is at the source of another stream. A component
+ * that forwards payload between streams, like a NIC router or a
+ * block-partition server, copies it by default. Such a component should copy
+ * each payload at most once, passing the received packet straight to
+ * 'packet_content' of the destination packet, and acknowledge the received
+ * packet only after the copy is done.
+ *
+ * Payload can be forwarded without copying if the communication buffer
+ * handed out to the client is a 'Packet_stream_window'
+ * (os/packet_stream_window.h): the pages of the queues are backed by RAM of
+ * the server, and the remaining pages map a window of the buffer of the
+ * other stream. The server translates the offset of a client packet into the
+ * window and keeps the window allocated as long as packets of the client
+ * are in flight, even beyond the end of the client session. The client gains
+ * access to its window only, which keeps it isolated from other clients. The
+ * partition server 'part_block' uses this scheme in its zero-copy mode.
  */
 
 /*
@@ -159,6 +187,11 @@ class Genode::Packet_descriptor_queue
 {
 	private:
 
+		static_assert(QUEUE_SIZE > 1 && !(QUEUE_SIZE & (QUEUE_SIZE - 1)),
+		              "packet-descriptor queue size must be a power of two");
+
+		enum : unsigned { MASK = QUEUE_SIZE - 1 };
+
 		/*
 		 * The anonymous struct is needed to skip the initialization of the
 		 * members, which are shared by both sides of the packet stream.
@@ -167,9 +200,24 @@ class Genode::Packet_descriptor_queue
 		{
 			unsigned volatile _head;
 			unsigned volatile _tail;
+			unsigned volatile _polling;
 			PACKET_DESCRIPTOR _queue[QUEUE_SIZE];
 		};
 
+		/*
+		 * Each index is written by one side only. The producer publishes
+		 * '_head' not before the descriptors are written and the consumer
+		 * publishes '_tail' not before the descriptors are read. Reading the
+		 * index of the other side with acquire semantics orders the
+		 * subsequent accesses to the descriptors accordingly.
+		 */
+
+		static unsigned _acquire(unsigned volatile const &idx) {
+			return __atomic_load_n(&idx, __ATOMIC_ACQUIRE) & MASK; }
+
+		static void _release(unsigned volatile &idx, unsigned value) {
+			__atomic_store_n(&idx, value & MASK, __ATOMIC_RELEASE); }
+
 	public:
 
 		typedef PACKET_DESCRIPTOR Packet_descriptor;
@@ -189,8 +237,10 @@ class Genode::Packet_descriptor_queue
 			if (role == PRODUCER) {
 				_head = 0;
 				Genode::memset(_queue, 0, sizeof(_queue));
-			} else
-				_tail = 0;
+			} else {
+				_tail    = 0;
+				_polling = 0;
+			}
 		}
 
 		/**
@@ -199,62 +249,134 @@ class Genode::Packet_descriptor_queue
 		 * \return true on success, or
 		 *         false if queue is full
 		 */
-		bool add(PACKET_DESCRIPTOR packet)
+		bool add(PACKET_DESCRIPTOR packet) { return add(&packet, 1) == 1; }
+
+		/**
+		 * Place as many of the 'count' packet descriptors into the queue as
+		 * there are free slots
+		 *
+		 * The head index is published once for the whole batch.
+		 *
+		 * \return  number of added packet descriptors
+		 */
+		unsigned add(PACKET_DESCRIPTOR const *packets, unsigned count)
 		{
-			if (full()) return false;
+			unsigned const head = _head & MASK;
+			unsigned const free = (_acquire(_tail) - head - 1) & MASK;
 
-			_queue[_head%QUEUE_SIZE] = packet;
-			_head = (_head + 1)%QUEUE_SIZE;
-			return true;
+			if (count > free)
+				count = free;
+
+			for (unsigned i = 0; i < count; i++)
+				_queue[(head + i) & MASK] = packets[i];
+
+			_release(_head, head + count);
+			return count;
 		}
 
 		/**
 		 * Take packet descriptor from queue
 		 *
-		 * \return  packet descriptor
+		 * \return  packet descriptor, or an invalid packet descriptor if
+		 *          the queue is empty
 		 */
 		PACKET_DESCRIPTOR get()
 		{
-			PACKET_DESCRIPTOR packet = _queue[_tail%QUEUE_SIZE];
-			_tail = (_tail + 1)%QUEUE_SIZE;
+			PACKET_DESCRIPTOR packet { };
+			get(&packet, 1);
 			return packet;
 		}
 
+		/**
+		 * Take up to 'count' packet descriptors from queue
+		 *
+		 * The tail index is published once for the whole batch.
+		 *
+		 * \return  number of packet descriptors written to 'packets'
+		 */
+		unsigned get(PACKET_DESCRIPTOR *packets, unsigned count)
+		{
+			unsigned const tail  = _tail & MASK;
+			unsigned const avail = (_acquire(_head) - tail) & MASK;
+
+			if (count > avail)
+				count = avail;
+
+			for (unsigned i = 0; i < count; i++)
+				packets[i] = _queue[(tail + i) & MASK];
+
+			_release(_tail, tail + count);
+			return count;
+		}
+
 		/**
 		 * Return current packet descriptor
 		 */
 		PACKET_DESCRIPTOR peek() const
 		{
-			return _queue[_tail%QUEUE_SIZE];
+			return _queue[_tail & MASK];
 		}
 
 		/**
 		 * Return true if packet-descriptor queue is empty
 		 */
-		bool empty() { return _tail == _head; }
+		bool empty() { return slots_used() == 0; }
 
 		/**
 		 * Return true if packet-descriptor queue is full
 		 */
-		bool full() { return (_head + 1)%QUEUE_SIZE == _tail; }
+		bool full() { return slots_free() == 0; }
 
 		/**
 		 * Return true if a single element is stored in the queue
 		 */
-		bool single_element() { return (_tail + 1)%QUEUE_SIZE == _head; }
+		bool single_element() { return slots_used() == 1; }
 
 
 		/**
 		 * Return true if a single slot is left to be put into the queue
 		 */
-		bool single_slot_free() { return (_head + 2)%QUEUE_SIZE == _tail; }
+		bool single_slot_free() { return slots_free() == 1; }
 
 		/**
 		 * Return number of slots left to be put into the queue
 		 */
 		unsigned slots_free() {
-			return ((_tail > _head) ? _tail - _head
-			                        : QUEUE_SIZE - _head + _tail) - 1; }
+			return (_acquire(_tail) - _acquire(_head) - 1) & MASK; }
+
+		/**
+		 * Return number of packet descriptors stored in the queue
+		 */
+		unsigned slots_used() {
+			return (_acquire(_head) - _acquire(_tail)) & MASK; }
+
+		/*
+		 * The polling state and the queue indices form a Dekker-style
+		 * handshake. The consumer withdraws its polling state before it
+		 * checks the queue a last time. The producer publishes its index
+		 * before it checks the polling state. So, either the consumer sees
+		 * the new descriptors or the producer sees that it must signal.
+		 */
+
+		/**
+		 * Announce whether the consumer polls the queue, called by the
+		 * consumer
+		 */
+		void consumer_polling(bool polling)
+		{
+			__atomic_store_n(&_polling, polling ? 1U : 0U, __ATOMIC_SEQ_CST);
+			__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		}
+
+		/**
+		 * Return true if the consumer polls the queue, called by the
+		 * producer after adding descriptors
+		 */
+		bool consumer_polling()
+		{
+			__atomic_thread_fence(__ATOMIC_SEQ_CST);
+			return __atomic_load_n(&_polling, __ATOMIC_SEQ_CST) != 0;
+		}
 };
 
 
@@ -321,7 +443,7 @@ class Genode::Packet_descriptor_transmitter
 
 			_tx_queue->add(packet);
 
-			if (_tx_queue->single_element())
+			if (_tx_queue->single_element() && !_tx_queue->consumer_polling())
 				_rx_ready.submit();
 		}
 
@@ -340,13 +462,35 @@ class Genode::Packet_descriptor_transmitter
 			return true;
 		}
 
+		/**
+		 * Put up to 'count' packets into the tx queue
+		 *
+		 * The receiver is signalled at most once for the whole batch.
+		 *
+		 * \return  number of packets taken from 'packets'
+		 */
+		unsigned tx(typename TX_QUEUE::Packet_descriptor const *packets,
+		            unsigned count)
+		{
+			Genode::Mutex::Guard mutex_guard(_tx_queue_mutex);
+
+			unsigned const result = _tx_queue->add(packets, count);
+
+			/* the receiver had drained the queue before */
+			if (result && _tx_queue->slots_used() == result &&
+			    !_tx_queue->consumer_polling())
+				_rx_ready.submit();
+
+			return result;
+		}
+
 		bool tx_wakeup()
 		{
 			Genode::Mutex::Guard mutex_guard(_tx_queue_mutex);
 
 			bool signal_submitted = false;
 
-			if (_tx_wakeup_needed) {
+			if (_tx_wakeup_needed && !_tx_queue->consumer_polling()) {
 				_rx_ready.submit();
 				signal_submitted = true;
 			}
@@ -378,6 +522,7 @@ class Genode::Packet_descriptor_receiver
 		Genode::Mutex mutable  _rx_queue_mutex { };
 		RX_QUEUE              *_rx_queue;
 		bool                   _rx_wakeup_needed = false;
+		unsigned               _rx_poll_spins    = 0;
 
 		/*
 		 * Noncopyable
@@ -416,6 +561,50 @@ class Genode::Packet_descriptor_receiver
 			return !_rx_queue->empty();
 		}
 
+		/**
+		 * Set number of times to poll the empty rx queue, 0 disables polling
+		 */
+		void rx_poll_spins(unsigned spins)
+		{
+			Genode::Mutex::Guard mutex_guard(_rx_queue_mutex);
+
+			if (!spins)
+				_rx_queue->consumer_polling(false);
+
+			_rx_poll_spins = spins;
+		}
+
+		/**
+		 * Poll the rx queue until it is non-empty or the spins are exhausted
+		 *
+		 * \return  true if a packet is available, false if the transmitter
+		 *          signals the next packet
+		 */
+		bool rx_poll()
+		{
+			Genode::Mutex::Guard mutex_guard(_rx_queue_mutex);
+
+			if (!_rx_poll_spins)
+				return !_rx_queue->empty();
+
+			_rx_queue->consumer_polling(true);
+			for (unsigned i = 0; i < _rx_poll_spins; i++)
+				if (!_rx_queue->empty())
+					return true;
+
+			_rx_queue->consumer_polling(false);
+			return !_rx_queue->empty();
+		}
+
+		/**
+		 * Leave polling without having drained the rx queue
+		 */
+		void rx_poll_end()
+		{
+			Genode::Mutex::Guard mutex_guard(_rx_queue_mutex);
+			_rx_queue->consumer_polling(false);
+		}
+
 		void rx(typename RX_QUEUE::Packet_descriptor *out_packet)
 		{
 			Genode::Mutex::Guard mutex_guard(_rx_queue_mutex);
@@ -444,6 +633,27 @@ class Genode::Packet_descriptor_receiver
 			return packet;
 		}
 
+		/**
+		 * Take up to 'count' packets from the rx queue
+		 *
+		 * The transmitter is signalled at most once for the whole batch.
+		 *
+		 * \return  number of packets written to 'packets'
+		 */
+		unsigned rx(typename RX_QUEUE::Packet_descriptor *packets,
+		            unsigned count)
+		{
+			Genode::Mutex::Guard mutex_guard(_rx_queue_mutex);
+
+			unsigned const result = _rx_queue->get(packets, count);
+
+			/* the queue was saturated before */
+			if (result && _rx_queue->slots_free() == result)
+				_tx_ready.submit();
+
+			return result;
+		}
+
 		bool rx_wakeup()
 		{
 			Genode::Mutex::Guard mutex_guard(_rx_queue_mutex);
@@ -756,6 +966,24 @@ class Genode::Packet_stream_source : private Packet_stream_base
 			_submit_transmitter.tx(packet);
 		}
 
+		/**
+		 * Tell sink about a batch of packets to process
+		 *
+		 * In contrast to calling 'submit_packet' for each packet, the
+		 * submit-queue index is updated and the sink is signalled only once
+		 * per batch. Packets that do not fit into the submit queue are left
+		 * to the caller.
+		 *
+		 * \return  number of submitted packets, taken from the start of
+		 *          'packets'
+		 *
+		 * This method never blocks.
+		 */
+		unsigned submit_packets(Packet_descriptor const *packets, unsigned count)
+		{
+			return _submit_transmitter.tx(packets, count);
+		}
+
 		/**
 		 * Submit the specified packet to the server if possible
 		 *
@@ -780,11 +1008,54 @@ class Genode::Packet_stream_source : private Packet_stream_base
 			_submit_transmitter.tx_wakeup() || _ack_receiver.rx_wakeup();
 		}
 
+		/**
+		 * Wake up the packet sink if packets were submitted via
+		 * 'try_submit_packet' to an empty submit queue
+		 *
+		 * In contrast to 'wakeup', this method does not assume that the sink
+		 * uses the same signal handler for both conditions.
+		 */
+		void wakeup_packet_avail() { _submit_transmitter.tx_wakeup(); }
+
+		/**
+		 * Wake up the packet sink if acknowledgements were taken via
+		 * 'try_get_acked_packet' from a full acknowledgement queue
+		 */
+		void wakeup_ready_to_ack() { _ack_receiver.rx_wakeup(); }
+
 		/**
 		 * Returns true if one or more packet acknowledgements are available
 		 */
 		bool ack_avail() { return _ack_receiver.ready_for_rx(); }
 
+		/**
+		 * Enable adaptive polling of the acknowledgement queue
+		 *
+		 * \param spins  number of times 'poll_ack_avail' polls the empty
+		 *               queue before the 'ack_avail' signal gets armed,
+		 *               0 disables the polling
+		 */
+		void adaptive_polling(unsigned spins) { _ack_receiver.rx_poll_spins(spins); }
+
+		/**
+		 * Poll for acknowledgements after the acknowledgement queue was
+		 * drained
+		 *
+		 * With adaptive polling enabled, the sink omits the 'ack_avail'
+		 * signal as long as the source polls. The source must therefore
+		 * keep processing acknowledgements until this method returns false
+		 * or call 'stop_polling'.
+		 *
+		 * \return  true if an acknowledgement is available
+		 */
+		bool poll_ack_avail() { return _ack_receiver.rx_poll(); }
+
+		/**
+		 * Re-arm the 'ack_avail' signal if the source stops processing
+		 * acknowledgements before 'poll_ack_avail' returned false
+		 */
+		void stop_polling() { _ack_receiver.rx_poll_end(); }
+
 		/**
 		 * Get acknowledged packet
 		 */
@@ -800,6 +1071,18 @@ class Genode::Packet_stream_source : private Packet_stream_base
 			return packet;
 		}
 
+		/**
+		 * Get up to 'count' acknowledged packets
+		 *
+		 * \return  number of packets written to 'packets'
+		 *
+		 * This method never blocks.
+		 */
+		unsigned get_acked_packets(Packet_descriptor *packets, unsigned count)
+		{
+			return _ack_receiver.rx(packets, count);
+		}
+
 		/**
 		 * Return next acknowledgement from sink, or an invalid packet
 		 *
@@ -899,6 +1182,33 @@ class Genode::Packet_stream_sink : private Packet_stream_base
 		 */
 		bool packet_avail() { return _submit_receiver.ready_for_rx(); }
 
+		/**
+		 * Enable adaptive polling of the submit queue
+		 *
+		 * \param spins  number of times 'poll_packet_avail' polls the empty
+		 *               queue before the 'packet_avail' signal gets armed,
+		 *               0 disables the polling
+		 */
+		void adaptive_polling(unsigned spins) { _submit_receiver.rx_poll_spins(spins); }
+
+		/**
+		 * Poll for packets after the submit queue was drained
+		 *
+		 * With adaptive polling enabled, the source omits the 'packet_avail'
+		 * signal as long as the sink polls. The sink must therefore keep
+		 * processing packets until this method returns false or call
+		 * 'stop_polling'.
+		 *
+		 * \return  true if a packet is available
+		 */
+		bool poll_packet_avail() { return _submit_receiver.rx_poll(); }
+
+		/**
+		 * Re-arm the 'packet_avail' signal if the sink stops processing
+		 * packets before 'poll_packet_avail' returned false
+		 */
+		void stop_polling() { _submit_receiver.rx_poll_end(); }
+
 		/**
 		 * Get next packet from source
 		 *
@@ -916,6 +1226,21 @@ class Genode::Packet_stream_sink : private Packet_stream_base
 			return packet;
 		}
 
+		/**
+		 * Get up to 'count' packets from source
+		 *
+		 * The submit-queue index is updated and the source is signalled
+		 * only once per batch.
+		 *
+		 * \return  number of packets written to 'packets'
+		 *
+		 * This method never blocks.
+		 */
+		unsigned get_packets(Packet_descriptor *packets, unsigned count)
+		{
+			return _submit_receiver.rx(packets, count);
+		}
+
 		/**
 		 * Return next packet from source, or an invalid packet
 		 *
@@ -938,6 +1263,21 @@ class Genode::Packet_stream_sink : private Packet_stream_base
 			_submit_receiver.rx_wakeup() || _ack_transmitter.tx_wakeup();
 		}
 
+		/**
+		 * Wake up the packet source if packets were taken via
+		 * 'try_get_packet' from a full submit queue
+		 *
+		 * In contrast to 'wakeup', this method does not assume that the
+		 * source uses the same signal handler for both conditions.
+		 */
+		void wakeup_ready_to_submit() { _submit_receiver.rx_wakeup(); }
+
+		/**
+		 * Wake up the packet source if packets were acknowledged via
+		 * 'try_ack_packet' to an empty acknowledgement queue
+		 */
+		void wakeup_ack_avail() { _ack_transmitter.tx_wakeup(); }
+
 		/**
 		 * Return but do not dequeue next packet
 		 *
@@ -983,6 +1323,23 @@ class Genode::Packet_stream_sink : private Packet_stream_base
 			_ack_transmitter.tx(packet);
 		}
 
+		/**
+		 * Tell the source that the processing of a batch of packets is
+		 * completed
+		 *
+		 * Packets that do not fit into the acknowledgement queue are left
+		 * to the caller.
+		 *
+		 * \return  number of acknowledged packets, taken from the start of
+		 *          'packets'
+		 *
+		 * This method never blocks.
+		 */
+		unsigned acknowledge_packets(Packet_descriptor const *packets, unsigned count)
+		{
+			return _ack_transmitter.tx(packets, count);
+		}
+
 		/**
 		 * Acknowledge the specified packet to the client if possible
 		 *
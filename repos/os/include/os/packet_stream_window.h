@@ -0,0 +1,216 @@
+/*
+ * \brief  Packet-stream buffer that shares its payload with another stream
+ * \author Stefan Kalkowski
+ * \date   2022-08-08
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__OS__PACKET_STREAM_WINDOW_H_
+#define _INCLUDE__OS__PACKET_STREAM_WINDOW_H_
+
+#include <base/env.h>
+#include <base/allocator.h>
+#include <region_map/client.h>
+#include <rm_session/connection.h>
+#include <util/noncopyable.h>
+
+namespace Genode { class Packet_stream_window; }
+
+
+/**
+ * Communication buffer composed of RAM for the queues and a window of the
+ * buffer of another packet stream
+ *
+ * A server that forwards packets from the streams of its clients to a
+ * stream of its own, e.g., to a back-end driver, hands out such a buffer to
+ * each client. The first pages of the buffer, which hold the queues of the
+ * client's stream, are backed by RAM of the server. The remaining pages map
+ * a window of the buffer of the other stream, the peer. The window is
+ * allocated from the packet allocator of the peer stream. A packet of the
+ * client can thereby be forwarded to the peer stream by translating its
+ * offset via 'peer_offset', without copying its payload. The client gains
+ * access to its window only.
+ *
+ * The server tracks the packets forwarded to the peer via 'acquire' and
+ * 'release'. If the client session is closed while packets are still in
+ * flight, the server must keep the window allocated until they are
+ * acknowledged by the peer. It calls 'retain' before destructing the object
+ * and frees the returned window at the peer's packet allocator once the
+ * last packet is released.
+ *
+ * The caller is expected to account the RAM quota of the RM session,
+ * 'Rm_connection::RAM_QUOTA', and the RAM of the queues to the client.
+ */
+class Genode::Packet_stream_window : Noncopyable
+{
+	public:
+
+		struct Window_unavailable : Exception { };
+
+		/**
+		 * Window within the buffer of the peer stream
+		 */
+		struct Window
+		{
+			addr_t offset;
+			size_t size;
+
+			void free(Range_allocator &peer_alloc) const {
+				peer_alloc.free((void *)offset, size); }
+		};
+
+		/**
+		 * Size of the queues of a packet stream with the given policy
+		 */
+		template <typename POLICY>
+		static size_t queues_size()
+		{
+			return align_addr(sizeof(typename POLICY::Submit_queue) +
+			                  sizeof(typename POLICY::Ack_queue), 12);
+		}
+
+	private:
+
+		Ram_allocator   &_ram;
+		Range_allocator &_peer_alloc;
+		size_t     const _size;
+		size_t     const _queues_size;
+		Window     const _window;
+
+		bool     _retained  { false };
+		unsigned _in_flight { 0 };
+
+		Ram_dataspace_capability const _queues_ds;
+
+		Rm_connection     _rm;
+		Region_map_client _map;
+
+		Window _alloc_window(unsigned align_log2)
+		{
+			if (_size <= _queues_size)
+				throw Window_unavailable();
+
+			size_t const size = _size - _queues_size;
+
+			return _peer_alloc.alloc_aligned(size, align_log2).convert<Window>(
+				[&] (void *ptr) { return Window { (addr_t)ptr, size }; },
+				[&] (Allocator::Alloc_error) -> Window { throw Window_unavailable(); });
+		}
+
+		Ram_dataspace_capability _alloc_queues()
+		{
+			try { return _ram.alloc(_queues_size); }
+			catch (...) {
+				_window.free(_peer_alloc);
+				throw;
+			}
+		}
+
+		Dataspace_capability _compose(Dataspace_capability peer_ds)
+		{
+			_map.attach_at(_queues_ds, 0);
+			_map.attach_at(peer_ds, _queues_size, _window.size,
+			               (off_t)_window.offset);
+			return _map.dataspace();
+		}
+
+		Dataspace_capability const _ds;
+
+		/*
+		 * Noncopyable
+		 */
+		Packet_stream_window(Packet_stream_window const &);
+		Packet_stream_window &operator = (Packet_stream_window const &);
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param peer_alloc   packet allocator of the peer stream
+		 * \param peer_ds      communication buffer of the peer stream
+		 * \param size         size of the buffer, rounded up to pages
+		 * \param queues_size  size of the queues at the start of the buffer
+		 * \param align_log2   alignment of the window within the peer buffer,
+		 *                     at least page alignment is required
+		 *
+		 * \throw Window_unavailable  peer buffer exhausted or 'size' too small
+		 */
+		Packet_stream_window(Env &env, Range_allocator &peer_alloc,
+		                     Dataspace_capability peer_ds, size_t size,
+		                     size_t queues_size, unsigned align_log2)
+		:
+			_ram(env.ram()), _peer_alloc(peer_alloc),
+			_size(align_addr(size, 12)), _queues_size(queues_size),
+			_window(_alloc_window(max(align_log2, 12u))),
+			_queues_ds(_alloc_queues()),
+			_rm(env), _map(_rm.create(_size)), _ds(_compose(peer_ds))
+		{ }
+
+		~Packet_stream_window()
+		{
+			_ram.free(_queues_ds);
+
+			if (!_retained)
+				_window.free(_peer_alloc);
+		}
+
+		/**
+		 * Communication buffer to be handed out to the client
+		 */
+		Dataspace_capability dataspace() const { return _ds; }
+
+		/**
+		 * Return true if the payload lies within the window
+		 *
+		 * \param offset  payload offset within the client's buffer
+		 */
+		bool contains(off_t offset, size_t size) const
+		{
+			return offset >= (off_t)_queues_size
+			    && size <= _size && (size_t)offset <= _size - size;
+		}
+
+		/**
+		 * Translate payload offset into offset within the peer buffer
+		 */
+		off_t peer_offset(off_t offset) const
+		{
+			return (off_t)(_window.offset + offset - _queues_size);
+		}
+
+		/**
+		 * Account packet forwarded to the peer stream
+		 */
+		void acquire() { _in_flight++; }
+
+		/**
+		 * Account packet acknowledged by the peer stream
+		 */
+		void release() { if (_in_flight) _in_flight--; }
+
+		/**
+		 * Number of packets forwarded to the peer stream and not released
+		 */
+		unsigned in_flight() const { return _in_flight; }
+
+		/**
+		 * Keep the window allocated beyond the lifetime of the object
+		 *
+		 * \return  window to be freed at the peer's packet allocator by the
+		 *          caller
+		 */
+		Window retain()
+		{
+			_retained = true;
+			return _window;
+		}
+};
+
+#endif /* _INCLUDE__OS__PACKET_STREAM_WINDOW_H_ */
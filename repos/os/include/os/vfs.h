@@ -776,6 +776,7 @@ class Genode::New_file : Noncopyable
 
 					case Write_result::WRITE_ERR_AGAIN:
 					case Write_result::WRITE_ERR_WOULD_BLOCK:
+					case Write_result::WRITE_QUEUED:
 						stalled = true;
 						break;
 
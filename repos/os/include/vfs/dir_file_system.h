@@ -898,6 +898,18 @@ class Vfs::Dir_file_system : public File_system
 			return WRITE_ERR_INVALID;
 		}
 
+		Write_result writev(Vfs_handle *, Const_segment const *, unsigned,
+		                    file_size &) override
+		{
+			return WRITE_ERR_INVALID;
+		}
+
+		Write_result complete_write(Vfs_handle *, char const *, file_size,
+		                            file_size &) override
+		{
+			return WRITE_ERR_INVALID;
+		}
+
 		bool queue_read(Vfs_handle *vfs_handle, file_size) override
 		{
 			Dir_vfs_handle *dir_vfs_handle =
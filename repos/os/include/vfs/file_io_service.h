@@ -25,6 +25,12 @@ struct Vfs::File_io_service : Interface
 {
 	enum General_error { ERR_FD_INVALID, NUM_GENERAL_ERRORS };
 
+	/**
+	 * Memory segment of a vectored read or write operation
+	 */
+	struct Segment       { char       *start; file_size num_bytes; };
+	struct Const_segment { char const *start; file_size num_bytes; };
+
 
 	/***********
 	 ** Write **
@@ -39,12 +45,90 @@ struct Vfs::File_io_service : Interface
 
 	enum Write_result { WRITE_ERR_AGAIN,     WRITE_ERR_WOULD_BLOCK,
 	                    WRITE_ERR_INVALID,   WRITE_ERR_IO,
-	                    WRITE_ERR_INTERRUPT, WRITE_OK };
+	                    WRITE_ERR_INTERRUPT, WRITE_QUEUED,
+	                    WRITE_OK };
 
 	virtual Write_result write(Vfs_handle *vfs_handle,
 	                           char const *buf, file_size buf_size,
 	                           file_size &out_count) = 0;
 
+	/**
+	 * Write content of multiple memory segments
+	 *
+	 * The segments are written consecutively starting at the seek offset
+	 * of the handle. Like 'write', the operation may be partial. The
+	 * default implementation issues one 'write' per segment.
+	 */
+	virtual Write_result writev(Vfs_handle *vfs_handle,
+	                            Const_segment const *segments, unsigned count,
+	                            file_size &out_count)
+	{
+		out_count = 0;
+
+		file_size const seek = vfs_handle->seek();
+
+		Write_result result = WRITE_OK;
+		for (unsigned i = 0; i < count; i++) {
+
+			file_size n = 0;
+			try {
+				result = write(vfs_handle, segments[i].start,
+				               segments[i].num_bytes, n);
+			} catch (Insufficient_buffer) {
+				if (!out_count) {
+					vfs_handle->seek(seek);
+					throw;
+				}
+				break;
+			}
+
+			if (result != WRITE_OK)
+				break;
+
+			out_count += n;
+			vfs_handle->advance_seek(n);
+
+			if (n < segments[i].num_bytes)
+				break;
+		}
+
+		vfs_handle->seek(seek);
+
+		return out_count ? WRITE_OK : result;
+	}
+
+	/**
+	 * Queue write operation
+	 *
+	 * In contrast to 'write', the outcome of the operation is reported
+	 * by 'complete_write'. A plugin may thereby pass the write to its
+	 * back end and let the caller wait for the back end's acknowledgement.
+	 *
+	 * \return false if queue is full
+	 *
+	 * If the queue is full, the caller can try again after a previous VFS
+	 * request is completed.
+	 */
+	virtual bool queue_write(Vfs_handle *, char const * /* src */, file_size)
+	{
+		return true;
+	}
+
+	/**
+	 * Complete write operation queued via 'queue_write'
+	 *
+	 * The arguments must match those given to 'queue_write'. The default
+	 * implementation performs the write not before this point.
+	 *
+	 * \return WRITE_QUEUED if the operation is still in progress
+	 */
+	virtual Write_result complete_write(Vfs_handle *vfs_handle,
+	                                    char const *src, file_size count,
+	                                    file_size &out_count)
+	{
+		return write(vfs_handle, src, count, out_count);
+	}
+
 
 	/**********
 	 ** Read **
@@ -72,6 +156,76 @@ struct Vfs::File_io_service : Interface
 	                                  file_size   /* in count */,
 	                                  file_size & /* out count */) = 0;
 
+	/**
+	 * Complete read operation into multiple memory segments
+	 *
+	 * The read must have been queued with the total size of all segments.
+	 * The default implementation reads the segments one after another,
+	 * queueing the read of each further segment itself. It stops at a short
+	 * read or if no more data is available. If a segment is not readily
+	 * completed, the progress is kept at the handle until the operation is
+	 * completed by calling 'complete_readv' again with the same arguments.
+	 */
+	virtual Read_result complete_readv(Vfs_handle *vfs_handle,
+	                                   Segment const *segments, unsigned count,
+	                                   file_size &out_count)
+	{
+		Vfs_handle::Readv_state &state = vfs_handle->readv_state();
+
+		/* the read of the first segment got queued by the caller */
+		if (!state.active)
+			state = { .active  = true,
+			          .queued  = true,
+			          .segment = 0,
+			          .count   = 0,
+			          .seek    = vfs_handle->seek() };
+
+		Read_result result = READ_OK;
+
+		while (state.segment < count) {
+
+			Segment const &segment = segments[state.segment];
+
+			if (!state.queued) {
+
+				/* do not block for data beyond the segments read already */
+				if (!read_ready(vfs_handle))
+					break;
+
+				if (!queue_read(vfs_handle, segment.num_bytes))
+					return READ_QUEUED;
+
+				state.queued = true;
+			}
+
+			file_size n = 0;
+			result = complete_read(vfs_handle, segment.start,
+			                       segment.num_bytes, n);
+
+			if (result == READ_QUEUED)
+				return READ_QUEUED;
+
+			state.queued = false;
+
+			if (result != READ_OK)
+				break;
+
+			state.count += n;
+			state.segment++;
+			vfs_handle->advance_seek(n);
+
+			if (n < segment.num_bytes)
+				break;
+		}
+
+		vfs_handle->seek(state.seek);
+
+		out_count = state.count;
+		state     = { };
+
+		return out_count ? READ_OK : result;
+	}
+
 	/**
 	 * Return true if the handle has readable data
 	 */
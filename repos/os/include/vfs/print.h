@@ -138,6 +138,7 @@ static inline void print(Genode::Output &output, Vfs::File_io_service::Write_res
 		CASE_PRINT(WRITE_ERR_INVALID);
 		CASE_PRINT(WRITE_ERR_IO);
 		CASE_PRINT(WRITE_ERR_INTERRUPT);
+		CASE_PRINT(WRITE_QUEUED);
 	}
 
 #undef CASE_PRINT
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2011-2017 Genode Labs GmbH
+ * Copyright (C) 2011-2022 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU Affero General Public License version 3.
@@ -71,6 +71,25 @@ class Vfs::Vfs_handle
 		file_size            _seek = 0;
 		int                  _status_flags;
 
+	public:
+
+		/**
+		 * Progress of a vectored read performed by the default
+		 * implementation of 'File_io_service::complete_readv'
+		 */
+		struct Readv_state
+		{
+			bool      active;
+			bool      queued;   /* read of current segment got queued */
+			unsigned  segment;  /* index of current segment */
+			file_size count;    /* bytes read into the preceding segments */
+			file_size seek;     /* seek offset at the start of the read */
+		};
+
+	private:
+
+		Readv_state _readv_state { };
+
 		/*
 		 * Noncopyable
 		 */
@@ -138,6 +157,13 @@ class Vfs::Vfs_handle
 		 */
 		void advance_seek(file_size incr) { _seek += incr; }
 
+		/**
+		 * Return state of vectored read
+		 *
+		 * \noapi
+		 */
+		Readv_state &readv_state() { return _readv_state; }
+
 		/**
 		 * Set response handler, unset with nullptr
 		 */
@@ -72,6 +72,25 @@ struct Test::Result
 	double mibs      { 0.0f };
 	double iops      { 0.0f };
 
+	/*
+	 * Request latencies in microseconds, only gathered by the benchmark
+	 */
+	struct Latency
+	{
+		bool     valid;
+		uint64_t min, avg, p50, p99, p999, max;
+
+		void print(Genode::Output &out) const
+		{
+			Genode::print(out, "lat_min:",  min,  " ",
+			                   "lat_avg:",  avg,  " ",
+			                   "lat_p50:",  p50,  " ",
+			                   "lat_p99:",  p99,  " ",
+			                   "lat_p999:", p999, " ",
+			                   "lat_max:",  max);
+		}
+	} latency { };
+
 	Result() { }
 
 	Result(bool success, uint64_t d, uint64_t b, uint64_t rx, uint64_t tx,
@@ -101,6 +120,10 @@ struct Test::Result
 			Genode::print(out, "mibs:", mibs, " iops:", iops);
 		}
 
+		if (latency.valid) {
+			Genode::print(out, " ", latency);
+		}
+
 		Genode::print(out, " triggered:", triggered);
 		Genode::print(out, " result:", success ? "ok" : "failed");
 	}
@@ -125,6 +148,7 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 		size_t   const _io_buffer;
 		uint64_t const _progress_interval;
 		bool     const _copy;
+		bool     const _pattern;
 		size_t   const _batch;
 
 		Constructible<Timer::Connection> _timer { };
@@ -142,6 +166,10 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 		{
 			unsigned const id;
 
+			uint64_t submitted_us { 0 };
+
+			bool corrupt { false };  /* read content differs from pattern */
+
 			Job(Block_connection &connection, Block::Operation operation, unsigned id)
 			:
 				Block_connection::Job(connection, operation), id(id)
@@ -195,6 +223,53 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 			Genode::memcpy(dst, src, length);
 		}
 
+		/*
+		 * Content of the word 'index' of block 'block' in pattern mode
+		 */
+		static uint64_t _pattern_word(block_number_t block, size_t index)
+		{
+			return (block << 16) ^ index ^ 0xa5a5a5a5a5a5a5a5ull;
+		}
+
+		template <typename FN>
+		void _for_each_pattern_word(Job const &job, Block::seek_off_t offset,
+		                            size_t length, FN const &fn)
+		{
+			size_t const words = _info.block_size / sizeof(uint64_t);
+
+			for (size_t pos = 0; pos < length; pos += _info.block_size) {
+
+				block_number_t const block = job.operation().block_number
+				                           + (offset + pos) / _info.block_size;
+
+				for (size_t i = 0; i < words; i++)
+					if (!fn(block, pos + i*sizeof(uint64_t), _pattern_word(block, i)))
+						return;
+			}
+		}
+
+		void _fill_pattern(Job const &job, Block::seek_off_t offset,
+		                   char *dst, size_t length)
+		{
+			_for_each_pattern_word(job, offset, length,
+				[&] (block_number_t, size_t pos, uint64_t word) {
+					Genode::memcpy(dst + pos, &word, sizeof(word));
+					return true; });
+		}
+
+		void _check_pattern(Job &job, Block::seek_off_t offset,
+		                    char const *src, size_t length)
+		{
+			_for_each_pattern_word(job, offset, length,
+				[&] (block_number_t block, size_t pos, uint64_t word) {
+					if (!Genode::memcmp(src + pos, &word, sizeof(word)))
+						return true;
+
+					error("job ", job.id, ": unexpected content of block ", block);
+					job.corrupt = true;
+					return false; });
+		}
+
 	public:
 
 		/**
@@ -208,7 +283,9 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 			if (_verbose)
 				log("job ", job.id, ": writing ", length, " bytes at ", offset);
 
-			if (_copy)
+			if (_pattern)
+				_fill_pattern(job, offset, dst, length);
+			else if (_copy)
 				_memcpy(dst, _scratch_buffer.base, length);
 		}
 
@@ -224,7 +301,9 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 			if (_verbose)
 				log("job ", job.id, ": got ", length, " bytes at ", offset);
 
-			if (_copy)
+			if (_pattern)
+				_check_pattern(job, offset, src, length);
+			else if (_copy)
 				_memcpy(_scratch_buffer.base, src, length);
 		}
 
@@ -235,12 +314,17 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 		{
 			_completed++;
 
+			if (job.corrupt)
+				success = false;
+
 			if (_verbose)
 				log("job ", job.id, ": ", job.operation(), ", completed");
 
 			if (!success)
 				error("processing ", job.operation(), " failed");
 
+			_job_completed(job);
+
 			destroy(_alloc, &job);
 
 			if (!success && _stop_on_error)
@@ -287,7 +371,9 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 			                                 Number_of_bytes(4*1024*1024))),
 			_progress_interval(_node.attribute_value("progress", (uint64_t)0)),
 			_copy(_node.attribute_value("copy", true)),
-			_batch(_node.attribute_value("batch", 1u)),
+			_pattern(_node.attribute_value("pattern", false)),
+			_batch(_node.attribute_value("batch",
+			                             _node.attribute_value("iodepth", 1u))),
 			_finished_sig(finished_sig),
 			_scratch_buffer(scratch_buffer)
 		{
@@ -309,12 +395,12 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 
 			_init();
 
-			for (unsigned i = 0; i < _batch; i++)
-				_spawn_job();
-
 			_timer.construct(_env);
 			_start_time = _timer->elapsed_ms();
 
+			for (unsigned i = 0; i < _batch; i++)
+				_spawn_job();
+
 			_handle_block_io();
 		}
 
@@ -324,6 +410,7 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 
 		virtual void _init() = 0;
 		virtual void _spawn_job() = 0;
+		virtual void _job_completed(Job const &) { }
 		virtual Result result() = 0;
 		virtual char const *name() const = 0;
 		virtual void print(Output &) const = 0;
@@ -331,6 +418,7 @@ struct Test::Test_base : private Genode::Fifo<Test_base>::Element
 
 
 /* tests */
+#include <test_benchmark.h>
 #include <test_ping_pong.h>
 #include <test_random.h>
 #include <test_replay.h>
@@ -396,6 +484,18 @@ struct Test::Main
 							xml.attribute("iops", (unsigned)(tr.result.iops + 0.5f));
 						}
 
+						Result::Latency const &latency = tr.result.latency;
+						if (latency.valid) {
+							xml.node("latency", [&] () {
+								xml.attribute("min",  latency.min);
+								xml.attribute("avg",  latency.avg);
+								xml.attribute("p50",  latency.p50);
+								xml.attribute("p99",  latency.p99);
+								xml.attribute("p999", latency.p999);
+								xml.attribute("max",  latency.max);
+							});
+						}
+
 						xml.attribute("result", tr.result.success ? 0 : 1);
 					});
 				});
@@ -466,6 +566,12 @@ struct Test::Main
 			Genode::Xml_node tests = config.sub_node("tests");
 			tests.for_each_sub_node([&] (Genode::Xml_node node) {
 
+				if (node.has_type("benchmark")) {
+					Test_base *t = new (&_heap)
+						Benchmark(_env, _heap, node, _finished_sigh, _scratch_buffer);
+					_tests.enqueue(*t);
+				} else
+
 				if (node.has_type("ping_pong")) {
 					Test_base *t = new (&_heap)
 						Ping_pong(_env, _heap, node, _finished_sigh, _scratch_buffer);
@@ -0,0 +1,297 @@
+/*
+ * \brief  Block session testing - benchmark
+ * \author Josef Soentgen
+ * \date   2022-07-27
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _TEST_BENCHMARK_H_
+#define _TEST_BENCHMARK_H_
+
+/* local includes */
+#include <test_random.h>
+
+namespace Test {
+
+	struct Latency_histogram;
+	struct Benchmark;
+}
+
+
+/*
+ * Histogram of request latencies
+ *
+ * Values below 16 are counted exactly, larger values are sorted into
+ * eight buckets per power of two, which bounds the error of a percentile
+ * to 12.5%.
+ */
+struct Test::Latency_histogram
+{
+	enum { SUB_BUCKETS_LOG2 = 3, SUB_BUCKETS = 1u << SUB_BUCKETS_LOG2,
+	       LINEAR = 2*SUB_BUCKETS, BUCKETS = LINEAR + (64 - 4)*SUB_BUCKETS };
+
+	uint64_t _count[BUCKETS] { };
+
+	uint64_t _total { 0 };
+	uint64_t _sum   { 0 };
+	uint64_t _min   { ~0ULL };
+	uint64_t _max   { 0 };
+
+	static unsigned _index(uint64_t value)
+	{
+		if (value < LINEAR)
+			return (unsigned)value;
+
+		unsigned const e   = log2(value);
+		unsigned const sub = (unsigned)(value >> (e - SUB_BUCKETS_LOG2))
+		                   & (SUB_BUCKETS - 1);
+
+		return LINEAR + (e - 4)*SUB_BUCKETS + sub;
+	}
+
+	/**
+	 * Return largest value sorted into the bucket
+	 */
+	static uint64_t _upper_bound(unsigned index)
+	{
+		if (index < LINEAR)
+			return index;
+
+		unsigned const e   = (index - LINEAR) / SUB_BUCKETS + 4;
+		unsigned const sub = (index - LINEAR) % SUB_BUCKETS;
+
+		return ((uint64_t)(SUB_BUCKETS + sub + 1) << (e - SUB_BUCKETS_LOG2)) - 1;
+	}
+
+	void add(uint64_t value)
+	{
+		_count[_index(value)]++;
+		_total++;
+		_sum += value;
+		_min  = min(_min, value);
+		_max  = max(_max, value);
+	}
+
+	/**
+	 * Return value below which the given per-mille of all values lie
+	 */
+	uint64_t percentile(unsigned permille) const
+	{
+		uint64_t const rank = (_total * permille + 999) / 1000;
+
+		uint64_t seen = 0;
+		for (unsigned i = 0; i < BUCKETS; i++) {
+			seen += _count[i];
+			if (seen && seen >= rank)
+				return min(_upper_bound(i), _max);
+		}
+		return _max;
+	}
+
+	Result::Latency latency() const
+	{
+		if (!_total)
+			return Result::Latency { };
+
+		return Result::Latency {
+			.valid = true,
+			.min   = _min,
+			.avg   = _sum / _total,
+			.p50   = percentile(500),
+			.p99   = percentile(990),
+			.p999  = percentile(999),
+			.max   = _max };
+	}
+};
+
+
+/*
+ * Benchmark
+ *
+ * This test issues requests according to a job description modelled
+ * after the job files of fio. The request latencies are recorded in a
+ * histogram.
+ */
+struct Test::Benchmark : Test_base
+{
+	typedef String<32> Name;
+	typedef String<16> Pattern;
+
+	Name     const _name       = _node.attribute_value("name", Name("benchmark"));
+	Pattern  const _rw         = _node.attribute_value("rw", Pattern("read"));
+	size_t   const _bs         = _node.attribute_value("bs", Number_of_bytes());
+	unsigned const _rwmixread  = min(_node.attribute_value("rwmixread", 50u), 100u);
+	uint64_t const _runtime_ms = _node.attribute_value("runtime", (uint64_t)0);
+	uint64_t const _offset     = _node.attribute_value("offset", Number_of_bytes());
+	uint64_t       _size       = _node.attribute_value("size", Number_of_bytes());
+	uint64_t       _io_size    = _node.attribute_value("io_size", Number_of_bytes());
+
+	Util::Xoroshiro _random;
+
+	bool _random_access { false };
+	bool _mixed         { false };
+
+	Block::Operation::Type _op_type { Block::Operation::Type::READ };
+
+	block_number_t _first  { 0 };  /* first block of the area */
+	block_number_t _blocks { 0 };  /* number of blocks of the area */
+	block_number_t _next   { 0 };  /* sequential position within the area */
+
+	uint64_t _issued { 0 };        /* bytes of spawned jobs */
+
+	Latency_histogram _latency { };
+
+	uint64_t _now_us()
+	{
+		return _timer.constructed()
+		     ? _timer->curr_time().trunc_to_plain_us().value : 0;
+	}
+
+	bool _expired()
+	{
+		/* the timer is gone once the test finished */
+		if (!_timer.constructed())
+			return true;
+
+		if (_io_size && _issued >= _io_size)
+			return true;
+
+		return _runtime_ms && _timer->elapsed_ms() - _start_time >= _runtime_ms;
+	}
+
+	template <typename... ARGS>
+	Benchmark(ARGS &&...args)
+	:
+		Test_base(args...),
+		_random(_node.attribute_value("seed", 42UL))
+	{ }
+
+	void _init() override
+	{
+		using Type = Block::Operation::Type;
+
+		if      (_rw == "read")      { _op_type = Type::READ; }
+		else if (_rw == "write")     { _op_type = Type::WRITE; }
+		else if (_rw == "randread")  { _op_type = Type::READ;  _random_access = true; }
+		else if (_rw == "randwrite") { _op_type = Type::WRITE; _random_access = true; }
+		else if (_rw == "rw")        { _mixed = true; }
+		else if (_rw == "randrw")    { _mixed = true; _random_access = true; }
+		else {
+			error("unknown access pattern '", _rw, "'");
+			throw Constructing_test_failed();
+		}
+
+		size_t const bs = _bs ? _bs : _info.block_size;
+
+		if (_copy && bs > _scratch_buffer.size) {
+			error("request size exceeds scratch buffer size");
+			throw Constructing_test_failed();
+		}
+
+		if (_info.block_size > bs || (bs % _info.block_size) != 0) {
+			error("request size invalid ", _info.block_size, " ", bs);
+			throw Constructing_test_failed();
+		}
+
+		uint64_t const capacity = _info.block_count * _info.block_size;
+
+		if (_offset % _info.block_size || _offset >= capacity) {
+			error("offset invalid ", _offset);
+			throw Constructing_test_failed();
+		}
+
+		if (!_size || _size > capacity - _offset)
+			_size = capacity - _offset;
+
+		_size_in_blocks = bs / _info.block_size;
+		_first          = _offset / _info.block_size;
+		_blocks         = _size / _info.block_size;
+
+		if (_blocks < _size_in_blocks) {
+			error("size of area smaller than request size");
+			throw Constructing_test_failed();
+		}
+
+		/* without runtime, the area is covered once */
+		if (!_io_size && !_runtime_ms)
+			_io_size = _blocks * _info.block_size;
+
+		_length_in_blocks = (size_t)(_io_size / _info.block_size);
+	}
+
+	block_number_t _next_block()
+	{
+		block_number_t const slots = _blocks - _size_in_blocks + 1;
+
+		if (_random_access)
+			return _first + _random.get() % slots;
+
+		if (_next >= slots)
+			_next = 0;
+
+		block_number_t const block = _first + _next;
+		_next += _size_in_blocks;
+		return block;
+	}
+
+	void _spawn_job() override
+	{
+		if (_expired())
+			return;
+
+		_job_cnt++;
+
+		using Type = Block::Operation::Type;
+
+		Type const op_type = !_mixed ? _op_type
+		                   : (_random.get() % 100 < _rwmixread) ? Type::READ
+		                                                        : Type::WRITE;
+
+		Block::Operation const operation { .type         = op_type,
+		                                   .block_number = _next_block(),
+		                                   .count        = _size_in_blocks };
+
+		Job &job = *new (_alloc) Job(*_block, operation, _job_cnt);
+		job.submitted_us = _now_us();
+
+		_issued += _size_in_blocks * _info.block_size;
+	}
+
+	void _job_completed(Job const &job) override
+	{
+		uint64_t const now = _now_us();
+		_latency.add(now > job.submitted_us ? now - job.submitted_us : 0);
+	}
+
+	Result result() override
+	{
+		Result r(_success, _end_time - _start_time, _bytes, _rx, _tx,
+		         _size_in_blocks * _info.block_size, _info.block_size,
+		         _triggered);
+
+		r.latency = _latency.latency();
+		return r;
+	}
+
+	char const *name() const override { return _name.string(); }
+
+	void print(Output &out) const override
+	{
+		Genode::print(out, name(),                " "
+		                   "rw:",      _rw,        " "
+		                   "bs:",      _bs,        " "
+		                   "iodepth:", _batch,     " "
+		                   "offset:",  _offset,    " "
+		                   "size:",    _size,      " "
+		                   "runtime:", _runtime_ms, " "
+		                   "copy:",    _copy);
+	}
+};
+
+#endif /* _TEST_BENCHMARK_H_ */
@@ -471,6 +471,7 @@ struct Ahci::Protocol : Interface
 	virtual void handle_irq(Port &port) = 0;
 
 	virtual Response submit(Port &port, Block::Request const request) = 0;
+	virtual void issue(Port &port) = 0;
 	virtual Block::Request completed(Port &port) = 0;
 
 	virtual void writeable(bool rw) = 0;
@@ -943,6 +944,8 @@ struct Ahci::Port : private Port_base
 	Response submit(Block::Request const request) {
 		return protocol.submit(*this, request); }
 
+	void issue() { protocol.issue(*this); }
+
 	template <typename FN>
 	void for_one_completed_request(FN const &fn)
 	{
@@ -119,6 +119,11 @@ struct Ata::String
 
 /**
  * Protocol driver using ncq- and non-ncq commands
+ *
+ * Requests are prepared in free command slots and issued to the device in
+ * batches via 'issue'. A request that continues the previously prepared
+ * request in terms of blocks and buffer is merged into the same command.
+ * Finished commands are collected from 'Ci' and 'Sact' on each interrupt.
  */
 class Ata::Protocol : public Ahci::Protocol, Noncopyable
 {
@@ -126,24 +131,70 @@ class Ata::Protocol : public Ahci::Protocol, Noncopyable
 
 		bool _syncing { false };
 
-		struct Request : Block::Request
+		/*
+		 * Limits of one command, the PRD byte count has 22 bits and the
+		 * sector count of the FIS 16 bits
+		 */
+		enum { MAX_COMMAND_BYTES = 4 * 1024 * 1024, MAX_COMMAND_COUNT = 0xffff };
+
+		/**
+		 * ATA command that covers one or more adjacent block requests
+		 */
+		struct Command
 		{
-			bool valid() const { return operation.valid(); }
-			void invalidate() { operation.type = Block::Operation::Type::INVALID; }
+			enum { MAX_REQUESTS = 8 };
+
+			Block::Request   requests[MAX_REQUESTS] { };
+			unsigned         count     { 0 };
+			Block::Operation operation { };  /* operation of the whole command */
+			Block::off_t     offset    { 0 };
 
-			Request & operator=(const Block::Request &request)
+			bool valid() const { return count > 0; }
+			void invalidate() { count = 0; }
+
+			void init(Block::Request const &request)
 			{
-				operation = request.operation;
-				success = request.success;
-				offset = request.offset;
-				tag = request.tag;
+				requests[0] = request;
+				count       = 1;
+				operation   = request.operation;
+				offset      = request.offset;
+			}
 
-				return *this;
+			/**
+			 * Return true if 'request' continues the command
+			 */
+			bool continued_by(Block::Request const &request, size_t block_size) const
+			{
+				Block::Operation const &op = request.operation;
+
+				return count < MAX_REQUESTS
+				    && op.type == operation.type
+				    && (op.type == Block::Operation::Type::READ ||
+				        op.type == Block::Operation::Type::WRITE)
+				    && op.block_number == operation.block_number + operation.count
+				    && request.offset  == offset + (Block::off_t)(operation.count * block_size)
+				    && operation.count + op.count <= MAX_COMMAND_COUNT
+				    && (operation.count + op.count) * block_size <= MAX_COMMAND_BYTES;
+			}
+
+			void append(Block::Request const &request)
+			{
+				requests[count++] = request;
+				operation.count  += request.operation.count;
 			}
 		};
 
-		Util::Slots<Request, 32> _slots { };
-		unsigned                 _slot_states = 0;
+		Util::Slots<Command, 32> _slots { };
+
+		/* bit masks of command slots */
+		unsigned _staged     { 0 };  /* prepared but not issued yet */
+		unsigned _staged_ncq { 0 };  /* prepared queued commands */
+		unsigned _active     { 0 };  /* issued to the device */
+		unsigned _completed  { 0 };  /* finished but not acknowledged yet */
+
+		/* slot of the command that may still be extended by merging */
+		enum { NO_SLOT = ~0u };
+		unsigned _last_staged { NO_SLOT };
 
 		typedef String<Identity::Serial_number> Serial_string;
 		typedef String<Identity::Model_number>  Model_string;
@@ -158,32 +209,42 @@ class Ata::Protocol : public Ahci::Protocol, Noncopyable
 
 	private:
 
+		/**
+		 * Check if the request conflicts with a pending write or is a write
+		 * that conflicts with any pending request
+		 *
+		 * Reads of the same blocks may be processed concurrently.
+		 */
 		bool _overlap_check(Block::Request const &request)
 		{
 			block_number_t block_number = request.operation.block_number;
 			block_number_t end = block_number + request.operation.count - 1;
 
-			auto overlap_check = [&] (Request const &req) {
-				if (req.operation.type == Block::Operation::Type::SYNC)
+			bool const write = request.operation.type == Block::Operation::Type::WRITE;
+
+			auto overlap_check = [&] (Command const &cmd) {
+				if (cmd.operation.type == Block::Operation::Type::SYNC)
+					return false;
+
+				bool const pending_write =
+					cmd.operation.type == Block::Operation::Type::WRITE;
+
+				if (!write && !pending_write)
 					return false;
 
-				block_number_t pending_start = req.operation.block_number;
-				block_number_t pending_end   = pending_start + req.operation.count - 1;
-
-				/* check if a pending packet overlaps */
-				if ((block_number >= pending_start && block_number <= pending_end) ||
-				    (end          >= pending_start && end          <= pending_end) ||
-				    (pending_start >= block_number && pending_start <= end) ||
-				    (pending_end   >= block_number && pending_end   <= end)) {
-
-					warning("overlap: ",
-					        "pending ", pending_start,
-					        " + ", req.operation.count,
-									" (", req.operation.type == Block::Operation::Type::WRITE ?
-									"write" : "read", "), ",
-					        "request: ", block_number, " + ", request.operation.count,
-									" (", request.operation.type == Block::Operation::Type::WRITE ?
-									"write" : "read", ")");
+				block_number_t pending_start = cmd.operation.block_number;
+				block_number_t pending_end   = pending_start + cmd.operation.count - 1;
+
+				/* check if a pending command overlaps */
+				if (block_number <= pending_end && pending_start <= end) {
+
+					if (verbose)
+						warning("overlap: ",
+						        "pending ", pending_start,
+						        " + ", cmd.operation.count,
+						        " (", pending_write ? "write" : "read", "), ",
+						        "request: ", block_number, " + ", request.operation.count,
+						        " (", write ? "write" : "read", ")");
 					return true;
 				}
 
@@ -213,6 +274,35 @@ class Ata::Protocol : public Ahci::Protocol, Noncopyable
 			return _identity->read<Identity::Sector_count>();
 		}
 
+		/**
+		 * Write command FIS, PRD, and header of the command in 'slot'
+		 */
+		void _setup_command(Port &port, unsigned slot, Command const &cmd)
+		{
+			Block::Operation const op = cmd.operation;
+
+			bool const sync  = (op.type == Block::Operation::Type::SYNC);
+			bool const write = (op.type == Block::Operation::Type::WRITE);
+
+			/* setup fis */
+			Command_table table(port.command_table_addr(slot),
+			                    port.dma_base + cmd.offset, /* physical address */
+			                    op.count * _block_size());
+
+			/* setup ATA command */
+			if (sync)
+				table.fis.flush_cache_ext();
+			else if (_ncq_support(port))
+				table.fis.fpdma(write == false, op.block_number, op.count, slot);
+			else
+				table.fis.dma_ext(write == false, op.block_number, op.count);
+
+			/* set or clear write flag in command header */
+			Command_header header(port.command_header_addr(slot));
+			header.write<Command_header::Bits::W>(write ? 1 : 0);
+			header.clear_byte_count();
+		}
+
 	public:
 
 		/******************************
@@ -244,6 +334,9 @@ class Ata::Protocol : public Ahci::Protocol, Noncopyable
 			/* read number of command slots of ATA device */
 			unsigned cmd_slots = _identity->read<Identity::Queue_depth::Max_depth >() + 1;
 
+			/* the HBA may support less slots than the device */
+			cmd_slots = min(cmd_slots, port.cmd_slots);
+
 			/* no native command queueing */
 			if (!_ncq_support(port))
 				cmd_slots = 1;
@@ -268,10 +361,16 @@ class Ata::Protocol : public Ahci::Protocol, Noncopyable
 			else if (Port::Is::Dma_ext_irq::get(port.read<Port::Is>()))
 				port.ack_irq();
 
-			_slot_states = port.read<Port::Ci>() | port.read<Port::Sact>();
+			/* collect all commands finished since the last interrupt at once */
+			unsigned const busy = port.read<Port::Ci>() | port.read<Port::Sact>();
+
+			_completed |= _active & ~busy;
+			_active    &= busy;
+
 			port.stop();
 
-			_syncing = false;
+			if (!_active)
+				_syncing = false;
 		}
 
 		Block::Session::Info info() const override
@@ -291,7 +390,7 @@ class Ata::Protocol : public Ahci::Protocol, Noncopyable
 			bool const sync  = (op.type == Block::Operation::Type::SYNC);
 			bool const write = (op.type == Block::Operation::Type::WRITE);
 
-			if ((sync && _slot_states) || _syncing)
+			if ((sync && (_staged | _active)) || _syncing)
 				return Response::RETRY;
 
 			if (_writeable == false && write)
@@ -305,61 +404,73 @@ class Ata::Protocol : public Ahci::Protocol, Noncopyable
 					return Response::RETRY;
 			}
 
-			Request *r = _slots.get();
+			/* extend the previous command if not issued yet */
+			if (_last_staged != NO_SLOT) {
+				Command &last = _slots.entry(_last_staged);
+
+				if (last.continued_by(request, _block_size())) {
+					last.append(request);
+					_setup_command(port, _last_staged, last);
+					return Response::ACCEPTED;
+				}
+			}
 
-			if (r == nullptr)
+			Command *cmd = _slots.get();
+
+			if (cmd == nullptr)
 				return Response::RETRY;
 
-			*r = request;
+			cmd->init(request);
 
-			size_t slot         = _slots.index(*r);
-			_slot_states       |= 1u << slot;
+			unsigned const slot = (unsigned)_slots.index(*cmd);
 
-			/* setup fis */
-			Command_table table(port.command_table_addr(slot),
-			                    port.dma_base + request.offset, /* physical address */
-			                    op.count * _block_size());
+			_setup_command(port, slot, *cmd);
 
-			/* setup ATA command */
-			if (sync) {
-				table.fis.flush_cache_ext();
-				_syncing = true;
-			} else if (_ncq_support(port)) {
-				table.fis.fpdma(write == false, op.block_number, op.count, slot);
-				/* ensure that 'Cmd::St' is 1 before writing 'Sact' */
-				port.start();
-				/* set pending */
-				port.write<Port::Sact>(1U << slot);
-			} else {
-				table.fis.dma_ext(write == false, op.block_number, op.count);
-			}
+			_staged |= 1u << slot;
 
-			/* set or clear write flag in command header */
-			Command_header header(port.command_header_addr(slot));
-			header.write<Command_header::Bits::W>(write ? 1 : 0);
-			header.clear_byte_count();
+			if (sync)
+				_syncing = true;
+			else if (_ncq_support(port))
+				_staged_ncq |= 1u << slot;
 
-			port.execute(slot);
+			_last_staged = slot;
 
 			return Response::ACCEPTED;
 		}
 
+		void issue(Port &port) override
+		{
+			if (!_staged)
+				return;
+
+			/* ensure that 'Cmd::St' is 1 before writing 'Sact' */
+			port.start();
+
+			/* set pending */
+			if (_staged_ncq)
+				port.write<Port::Sact>(_staged_ncq);
+
+			port.write<Port::Ci>(_staged);
+
+			_active     |= _staged;
+			_staged      = 0;
+			_staged_ncq  = 0;
+			_last_staged = NO_SLOT;
+		}
+
 		Block::Request completed(Port & /* port */) override
 		{
-			Block::Request r { };
+			if (!_completed)
+				return Block::Request();
 
-			_slots.for_each([&](Request &request)
-			{
-				size_t index = _slots.index(request);
-				/* request still pending */
-				if (_slot_states & (1u << index))
-					return false;
+			unsigned const slot = log2(_completed);
+			Command       &cmd  = _slots.entry(slot);
 
-				r = request;
-				request.invalidate();
+			/* hand out the merged requests one by one */
+			Block::Request const r = cmd.requests[--cmd.count];
 
-				return true;
-			});
+			if (!cmd.valid())
+				_completed &= ~(1u << slot);
 
 			return r;
 		}
@@ -178,6 +178,8 @@ class Atapi::Protocol : public Ahci::Protocol, Noncopyable
 			return Response::ACCEPTED;
 		}
 
+		void issue(Port &) override { }
+
 		Block::Request completed(Port &port) override
 		{
 			if (!_pending.operation.valid() || port.read<Port::Ci>())
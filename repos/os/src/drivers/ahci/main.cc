@@ -298,6 +298,9 @@ struct Ahci::Block_session_component : Rpc_object<Block::Session>,
 				return response;
 			});
 
+			/* pass all accepted requests to the device at once */
+			port.issue();
+
 			if (progress == false) break;
 		}
 
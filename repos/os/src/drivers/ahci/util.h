@@ -64,6 +64,8 @@ namespace Util {
 			return index;
 		}
 
+		T &entry(size_t index) { return _entries[index]; }
+
 		void limit(size_t limit) { _limit = limit; }
 	};
 }
@@ -47,6 +47,7 @@ class Genode::Uplink_client_base : Noncopyable
 		Signal_handler<Uplink_client_base>  _conn_tx_ack_avail_handler       { _env.ep(), *this, &Uplink_client_base::_conn_tx_handle_ack_avail };
 		Signal_handler<Uplink_client_base>  _conn_tx_ready_to_submit_handler { _env.ep(), *this, &Uplink_client_base::_conn_tx_handle_ready_to_submit };
 		Packet_descriptor                   _save                            { };
+		unsigned                            _conn_rx_poll_spins              { 0 };
 
 
 		/*****************************************
@@ -89,8 +90,13 @@ class Genode::Uplink_client_base : Noncopyable
 			bool pkts_transmitted          { false };
 
 			while (drv_ready_to_transmit_pkt &&
-			       _conn->rx()->packet_avail() &&
-			       _conn->rx()->ready_to_ack()) {
+			       (_conn->rx()->packet_avail() ||
+			        _conn->rx()->poll_packet_avail())) {
+
+				if (!_conn->rx()->ready_to_ack()) {
+					_conn->rx()->stop_polling();
+					break;
+				}
 
 				Packet_descriptor const conn_rx_pkt {
 					_conn->rx()->get_packet() };
@@ -121,6 +127,7 @@ class Genode::Uplink_client_base : Noncopyable
 					case Transmit_result::RETRY:
 
 						drv_ready_to_transmit_pkt = false;
+						_conn->rx()->stop_polling();
 						break;
 					}
 
@@ -225,6 +232,8 @@ class Genode::Uplink_client_base : Noncopyable
 				_conn->rx_channel()->sigh_packet_avail(
 					_conn_rx_packet_avail_handler);
 
+				_conn->rx()->adaptive_polling(_conn_rx_poll_spins);
+
 				_conn->tx_channel()->sigh_ack_avail(
 					_conn_tx_ack_avail_handler);
 
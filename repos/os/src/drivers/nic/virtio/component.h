@@ -500,6 +500,8 @@ class Virtio_nic::Uplink_client : public Virtio_nic::Device,
 			Uplink_client_base { env, alloc, read_mac_address() },
 			_irq_handler       { env.ep(), *this, &Uplink_client::_handle_irq }
 		{
+			_conn_rx_poll_spins = xml.attribute_value("poll_spins", 0U);
+
 			Virtio_nic::Device::init(_irq_handler);
 			_drv_handle_link_state(read_link_state());
 		}
@@ -66,6 +66,7 @@ namespace Nvme {
 	struct Sqe_create_sq;
 	struct Sqe_identify;
 	struct Sqe_io;
+	struct Sqe_set_features;
 
 	struct Queue;
 	struct Sq;
@@ -78,7 +79,17 @@ namespace Nvme {
 		CQE_LEN                = 1u << CQE_LEN_LOG2,
 		SQE_LEN_LOG2           = 6u,
 		SQE_LEN                = 1u << SQE_LEN_LOG2,
-		MAX_IO_QUEUES          = 1,
+
+		/*
+		 * Limit the number of I/O queue pairs. The actual number is
+		 * configurable and negotiated with the controller. By default,
+		 * only one pair is used as the commands in flight are limited by
+		 * the command identifiers (MAX_IO_ENTRIES) and the queue of the
+		 * single block session anyway, which one pair already covers.
+		 * Additional pairs merely add memory and completion polling.
+		 */
+		MAX_IO_QUEUES          = 16,
+		DEFAULT_IO_QUEUES      = 1,
 
 		/*
 		 * Limit max number of I/O slots. By now most controllers
@@ -113,7 +124,7 @@ namespace Nvme {
 		 */
 		IO_NSID    = 1u,
 		MAX_NS     = 1u,
-		NUM_QUEUES = 1 + MAX_NS,
+		NUM_QUEUES = 1 + MAX_IO_QUEUES,
 	};
 
 	enum Opcode {
@@ -375,6 +386,38 @@ struct Nvme::Sqe_create_sq : Nvme::Sqe
 };
 
 
+/*
+ * Set features command
+ */
+struct Nvme::Sqe_set_features : Nvme::Sqe
+{
+	enum Fid { NUMBER_OF_QUEUES = 0x07, };
+
+	struct Cdw10 : Register<0x28, 32>
+	{
+		struct Fid : Bitfield< 0, 8> { }; /* feature identifier */
+	};
+
+	struct Cdw11 : Register<0x2c, 32>
+	{
+		/* number of queues feature */
+		struct Nsqr : Bitfield< 0, 16> { }; /* I/O submission queues requested 0-based */
+		struct Ncqr : Bitfield<16, 16> { }; /* I/O completion queues requested 0-based */
+	};
+
+	/*
+	 * Completion dword 0 of the number of queues feature
+	 */
+	struct Number_of_queues : Genode::Register<32>
+	{
+		struct Nsqa : Bitfield< 0, 16> { }; /* I/O submission queues allocated 0-based */
+		struct Ncqa : Bitfield<16, 16> { }; /* I/O completion queues allocated 0-based */
+	};
+
+	Sqe_set_features(addr_t const base) : Sqe(base) { }
+};
+
+
 /*
  * I/O command
  */
@@ -626,20 +669,13 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 	};
 
 	/*
-	 * I/O submission doorbell
-	 */
-	struct Io_sdb : Register<0x1008, 32>
-	{
-		struct Sqt : Bitfield< 0, 16> { }; /* submission queue tail */
-	};
-
-	/*
-	 * I/O completion doorbell
+	 * Queue doorbells
+	 *
+	 * The submission-queue tail and completion-queue head doorbells of
+	 * all queues are interleaved, separated by the doorbell stride.
 	 */
-	struct Io_cdb : Register<0x100C, 32>
-	{
-		struct Cqh : Bitfield< 0, 16> { }; /* completion queue tail */
-	};
+	enum { MAX_DSTRD = 2 };
+	struct Db : Register_array<0x1000, 32, (2 * NUM_QUEUES) << MAX_DSTRD, 32> { };
 
 	/**********
 	 ** CODE **
@@ -659,8 +695,8 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 	Mmio::Delayer       &_delayer;
 
 	/*
-	 * There is a completion and submission queue for
-	 * every namespace and one pair for the admin queues.
+	 * There is one pair for the admin queues followed by
+	 * the pairs of I/O completion and submission queues.
 	 */
 	Nvme::Cq _cq[NUM_QUEUES] { };
 	Nvme::Sq _sq[NUM_QUEUES] { };
@@ -680,6 +716,9 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 	size_t _max_io_entries      { MAX_IO_ENTRIES };
 	size_t _max_io_entries_mask { _max_io_entries - 1 };
 
+	uint16_t _io_queues { 0 };
+	unsigned _dstrd     { 0 };
+
 	enum Cns {
 		IDENTIFY_NS = 0x00,
 		IDENTIFY    = 0x01,
@@ -694,6 +733,7 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 		QUERYNS_CID,
 		CREATE_IO_CQ_CID,
 		CREATE_IO_SQ_CID,
+		SET_FEATURES_CID,
 	};
 
 	Mem_address _nvme_query_ns[MAX_NS] { };
@@ -770,6 +810,25 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 
 		write<Cc::Iocqes>(CQE_LEN_LOG2);
 		write<Cc::Iosqes>(SQE_LEN_LOG2);
+
+		_dstrd = read<Cap::Dstrd>();
+		if (_dstrd > MAX_DSTRD) {
+			error("unsupported doorbell stride: ", _dstrd);
+			throw Initialization_failed();
+		}
+	}
+
+	/**
+	 * Write doorbell of queue
+	 *
+	 * \param qid    queue identifier
+	 * \param cq     true for the completion-queue head doorbell, false
+	 *               for the submission-queue tail doorbell
+	 * \param value  new head or tail
+	 */
+	void _ring_doorbell(uint16_t qid, bool cq, uint32_t value)
+	{
+		write<Db>(value, (2u * qid + (cq ? 1 : 0)) << _dstrd);
 	}
 
 	/**
@@ -839,13 +898,15 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 	/**
 	 * Wait until admin command has finished
 	 *
-	 * \param num  number of attempts
-	 * \param cid  command identifier
+	 * \param num   number of attempts
+	 * \param cid   command identifier
+	 * \param func  function that is called with the completion entry
 	 *
 	 * \return  returns true if attempt to wait was successfull, otherwise
 	 *          false is returned
 	 */
-	bool _wait_for_admin_cq(uint32_t num, uint16_t cid)
+	template <typename FUNC>
+	bool _wait_for_admin_cq(uint32_t num, uint16_t cid, FUNC const &func)
 	{
 		bool success = false;
 
@@ -858,6 +919,8 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 				continue;
 			}
 
+			func(b);
+
 			_admin_cq.advance_head();
 
 			success = true;
@@ -869,6 +932,11 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 		return success;
 	}
 
+	bool _wait_for_admin_cq(uint32_t num, uint16_t cid)
+	{
+		return _wait_for_admin_cq(num, cid, [] (Cqe const &) { });
+	}
+
 	/**
 	 * Get list of namespaces
 	 */
@@ -999,6 +1067,43 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 		_max_io_entries_mask = _max_io_entries - 1;
 	}
 
+	/**
+	 * Negotiate number of I/O queue pairs
+	 *
+	 * \param requested  number of queue pairs the driver wants to use
+	 *
+	 * \return  number of queue pairs allocated by the controller
+	 */
+	uint16_t _set_number_of_queues(uint16_t requested)
+	{
+		Sqe_set_features b(_admin_command(Opcode::SET_FEATURES, 0, SET_FEATURES_CID));
+		b.write<Nvme::Sqe_set_features::Cdw10::Fid>(Sqe_set_features::NUMBER_OF_QUEUES);
+		b.write<Nvme::Sqe_set_features::Cdw11::Nsqr>(requested - 1);
+		b.write<Nvme::Sqe_set_features::Cdw11::Ncqr>(requested - 1);
+
+		write<Admin_sdb::Sqt>(_admin_sq.tail);
+
+		using Nq = Sqe_set_features::Number_of_queues;
+
+		Nq::access_t result    = 0;
+		bool         succeeded = false;
+		bool const   completed =
+			_wait_for_admin_cq(10, SET_FEATURES_CID, [&] (Cqe const &e) {
+				succeeded = Nvme::Cqe::succeeded(e);
+				result    = e.read<Nvme::Cqe::Dw0>();
+			});
+
+		/* one I/O queue pair is always supported */
+		if (!completed || !succeeded) {
+			warning("set number of queues failed, use one I/O queue pair");
+			return 1;
+		}
+
+		uint32_t const sq = Nq::Nsqa::get(result) + 1;
+		uint32_t const cq = Nq::Ncqa::get(result) + 1;
+		return (uint16_t)Genode::min((uint32_t)requested, Genode::min(sq, cq));
+	}
+
 	/**
 	 * Setup I/O completion queue
 	 *
@@ -1018,6 +1123,12 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 		b.write<Nvme::Sqe_create_cq::Cdw11::Pc>(1);
 		b.write<Nvme::Sqe_create_cq::Cdw11::En>(1);
 
+		/*
+		 * The platform driver provides only one interrupt per device,
+		 * hence all completion queues share the first vector.
+		 */
+		b.write<Nvme::Sqe_create_cq::Cdw11::Iv>(0);
+
 		write<Admin_sdb::Sqt>(_admin_sq.tail);
 
 		if (!_wait_for_admin_cq(10, CREATE_IO_CQ_CID)) {
@@ -1109,24 +1220,42 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 	}
 
 	/**
-	 * Setup I/O queue
+	 * Setup I/O queues
+	 *
+	 * Each I/O submission queue is paired with the completion queue of
+	 * the same identifier, starting with identifier 1.
+	 *
+	 * \param requested  number of queue pairs the driver wants to use
 	 */
-	void setup_io(uint16_t cid, uint16_t sid)
+	void setup_io(uint16_t requested)
 	{
-		_setup_io_cq(cid);
-		_setup_io_sq(sid, cid);
+		requested  = Genode::max((uint16_t)1,
+		                         Genode::min(requested, (uint16_t)MAX_IO_QUEUES));
+		_io_queues = _set_number_of_queues(requested);
+
+		for (uint16_t qid = 1; qid <= _io_queues; qid++) {
+			_setup_io_cq(qid);
+			_setup_io_sq(qid, qid);
+		}
 	}
 
+	/**
+	 * Get number of I/O queue pairs
+	 */
+	uint16_t io_queues() const { return _io_queues; }
+
 	/**
 	 * Get next free IO submission queue slot
 	 *
+	 * \param qid   queue identifier
 	 * \param nsid  namespace identifier
+	 * \param cid   command identifier
 	 *
 	 * \return  returns virtual address of the I/O command
 	 */
-	addr_t io_command(uint16_t nsid, uint16_t cid)
+	addr_t io_command(uint16_t qid, uint16_t nsid, uint16_t cid)
 	{
-		Nvme::Sq &sq = _sq[nsid];
+		Nvme::Sq &sq = _sq[qid];
 
 		Sqe e(sq.next());
 		e.write<Nvme::Sqe::Cdw0::Cid>(cid);
@@ -1137,38 +1266,38 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 	/**
 	 * Check if I/O queue is full
 	 *
-	 * \param nsid  namespace identifier
+	 * \param qid  queue identifier
 	 *
 	 * \return  true if full, otherwise false
 	 */
-	bool io_queue_full(uint16_t nsid) const
+	bool io_queue_full(uint16_t qid) const
 	{
-		Nvme::Sq const &sq = _sq[nsid];
-		Nvme::Cq const &cq = _cq[nsid];
+		Nvme::Sq const &sq = _sq[qid];
+		Nvme::Cq const &cq = _cq[qid];
 		return _queue_full(sq, cq);
 	}
 
 	/**
 	 * Write current I/O submission queue tail
 	 *
-	 * \param nsid  namespace identifier
+	 * \param qid  queue identifier
 	 */
-	void commit_io(uint16_t nsid)
+	void commit_io(uint16_t qid)
 	{
-		Nvme::Sq &sq = _sq[nsid];
-		write<Io_sdb::Sqt>(sq.tail);
+		Nvme::Sq &sq = _sq[qid];
+		_ring_doorbell(qid, false, sq.tail);
 	}
 
 	/**
 	 * Process a pending I/O completion
 	 *
-	 * \param nsid  namespace identifier
+	 * \param qid   queue identifier
 	 * \param func  function that is called on each completion
 	 */
 	template <typename FUNC>
-	void handle_io_completion(uint16_t nsid, FUNC const &func)
+	void handle_io_completion(uint16_t qid, FUNC const &func)
 	{
-		Nvme::Cq &cq = _cq[nsid];
+		Nvme::Cq &cq = _cq[qid];
 
 		if (!cq.valid()) { return; }
 
@@ -1192,12 +1321,12 @@ struct Nvme::Controller : public Genode::Attached_dataspace,
 	/**
 	 * Acknowledge every pending I/O already handled
 	 *
-	 * \param nsid  namespace identifier
+	 * \param qid  queue identifier
 	 */
-	void ack_io_completions(uint16_t nsid)
+	void ack_io_completions(uint16_t qid)
 	{
-		Nvme::Cq &cq = _cq[nsid];
-		write<Io_cdb::Cqh>(cq.head);
+		Nvme::Cq &cq = _cq[qid];
+		_ring_doorbell(qid, true, cq.head);
 	}
 
 	/**
@@ -1438,7 +1567,8 @@ class Nvme::Driver : Genode::Noncopyable
 		struct Command_id
 		{
 			using Bitmap = Genode::Bit_array<ENTRIES>;
-			Bitmap _bitmap { };
+			Bitmap   _bitmap { };
+			unsigned _used   { 0 };
 
 			uint16_t _bitmap_find_free() const
 			{
@@ -1454,16 +1584,20 @@ class Nvme::Driver : Genode::Noncopyable
 				return _bitmap.get(cid, 1);
 			}
 
+			bool full() const { return _used == ENTRIES; }
+
 			uint16_t alloc()
 			{
 				uint16_t const id = _bitmap_find_free();
 				_bitmap.set(id, 1);
+				_used++;
 				return id;
 			}
 
 			void free(uint16_t id)
 			{
 				_bitmap.clear(id, 1);
+				_used--;
 			}
 		};
 
@@ -1481,8 +1615,55 @@ class Nvme::Driver : Genode::Noncopyable
 			return false;
 		}
 
-		bool _submits_pending   { false };
-		bool _completed_pending { false };
+		/*
+		 * The requests are distributed round-robin over the I/O queue
+		 * pairs to make use of the parallelism of the device. The
+		 * pending flags are indexed by the queue identifier.
+		 */
+		uint16_t _submit_qid     { 0 };
+		uint16_t _completion_qid { 0 };
+
+		bool _submits_pending  [Nvme::NUM_QUEUES] { };
+		bool _completed_pending[Nvme::NUM_QUEUES] { };
+
+		/**
+		 * Get identifier of the next I/O queue with a free slot
+		 *
+		 * \return  queue identifier or 0 if all I/O queues are full
+		 */
+		uint16_t _free_io_queue() const
+		{
+			uint16_t const queues = _nvme_ctrlr->io_queues();
+			for (uint16_t i = 0; i < queues; i++) {
+				uint16_t const qid = 1 + (_submit_qid + i) % queues;
+				if (!_nvme_ctrlr->io_queue_full(qid)) { return qid; }
+			}
+			return 0;
+		}
+
+		/**
+		 * Allocate command identifier and queue slot for request
+		 *
+		 * \param request  block request
+		 * \param out_cid  allocated command identifier
+		 *
+		 * \return  returns virtual address of the I/O command
+		 */
+		addr_t _io_command(Block::Request const &request, uint16_t &out_cid)
+		{
+			uint16_t const qid = _free_io_queue();
+			uint16_t const cid = _command_id_allocator.alloc();
+			uint32_t const id  = cid | (qid<<16);
+			Request &r = _requests[cid];
+			r = Request { .block_request = request,
+			              .id            = id };
+
+			_submit_qid           = qid % _nvme_ctrlr->io_queues();
+			_submits_pending[qid] = true;
+
+			out_cid = cid;
+			return _nvme_ctrlr->io_command(qid, Nvme::IO_NSID, cid);
+		}
 
 		/*********************
 		 ** MMIO Controller **
@@ -1570,7 +1751,10 @@ class Nvme::Driver : Genode::Noncopyable
 				}
 			}
 
-			_nvme_ctrlr->setup_io(Nvme::IO_NSID, Nvme::IO_NSID);
+			uint16_t const io_queues =
+				_config_rom.xml().attribute_value("io_queues",
+				                                  (uint16_t)Nvme::DEFAULT_IO_QUEUES);
+			_nvme_ctrlr->setup_io(io_queues);
 
 			/*
 			 * Setup Block session
@@ -1598,7 +1782,8 @@ class Nvme::Driver : Genode::Noncopyable
 			log("Block", " "
 			    "size: ",  _info.block_size, " "
 			    "count: ", _info.block_count, " "
-			    "I/O entries: ", _nvme_ctrlr->max_io_entries());
+			    "I/O entries: ", _nvme_ctrlr->max_io_entries(), " "
+			    "I/O queues: ", _nvme_ctrlr->io_queues());
 
 			/* generate Report if requested */
 			try {
@@ -1642,10 +1827,10 @@ class Nvme::Driver : Genode::Noncopyable
 		{
 			/*
 			 * All memory is dimensioned in a way that it will allow for
-			 * MAX_IO_ENTRIES requests, so it is safe to only check the
-			 * I/O queue.
+			 * MAX_IO_ENTRIES requests, which may be spread over all I/O
+			 * queues, so check for a free command identifier as well.
 			 */
-			if (_nvme_ctrlr->io_queue_full(Nvme::IO_NSID)) {
+			if (!_free_io_queue() || _command_id_allocator.full()) {
 				return Response::RETRY;
 			}
 
@@ -1729,13 +1914,8 @@ class Nvme::Driver : Genode::Noncopyable
 				    " offset: ", Hex(request.offset));
 			}
 
-			uint16_t const cid = _command_id_allocator.alloc();
-			uint32_t const id  = cid | (Nvme::IO_NSID<<16);
-			Request &r = _requests[cid];
-			r = Request { .block_request = request,
-			              .id            = id };
-
-			Nvme::Sqe_io b(_nvme_ctrlr->io_command(Nvme::IO_NSID, cid));
+			uint16_t cid = 0;
+			Nvme::Sqe_io b(_io_command(request, cid));
 			Nvme::Opcode const op = write ? Nvme::Opcode::WRITE : Nvme::Opcode::READ;
 			b.write<Nvme::Sqe::Cdw0::Opc>(op);
 			b.write<Nvme::Sqe::Prp1>(request_pa);
@@ -1776,28 +1956,18 @@ class Nvme::Driver : Genode::Noncopyable
 
 		void _submit_sync(Block::Request const request)
 		{
-			uint16_t const cid = _command_id_allocator.alloc();
-			uint32_t const id  = cid | (Nvme::IO_NSID<<16);
-			Request &r = _requests[cid];
-			r = Request { .block_request = request,
-			              .id            = id };
-
-			Nvme::Sqe_io b(_nvme_ctrlr->io_command(Nvme::IO_NSID, cid));
+			uint16_t cid = 0;
+			Nvme::Sqe_io b(_io_command(request, cid));
 			b.write<Nvme::Sqe::Cdw0::Opc>(Nvme::Opcode::FLUSH);
 		}
 
 		void _submit_trim(Block::Request const request)
 		{
-			uint16_t const cid = _command_id_allocator.alloc();
-			uint32_t const id  = cid | (Nvme::IO_NSID<<16);
-			Request &r = _requests[cid];
-			r = Request { .block_request = request,
-			              .id            = id };
-
 			size_t          const count = request.operation.count;
 			Block::sector_t const lba   = request.operation.block_number;
 
-			Nvme::Sqe_io b(_nvme_ctrlr->io_command(Nvme::IO_NSID, cid));
+			uint16_t cid = 0;
+			Nvme::Sqe_io b(_io_command(request, cid));
 			b.write<Nvme::Sqe::Cdw0::Opc>(Nvme::Opcode::WRITE_ZEROS);
 			b.write<Nvme::Sqe_io::Slba>(lba);
 
@@ -1812,27 +1982,36 @@ class Nvme::Driver : Genode::Noncopyable
 
 		void _get_completed_request(Block::Request &out, uint16_t &out_cid)
 		{
-			_nvme_ctrlr->handle_io_completion(Nvme::IO_NSID, [&] (Nvme::Cqe const &b) {
-
-				if (_verbose_io) { Nvme::Cqe::dump(b); }
-
-				uint32_t const id  = Nvme::Cqe::request_id(b);
-				uint16_t const cid = Nvme::Cqe::command_id(b);
-				Request &r = _requests[cid];
-				if (r.id != id) {
-					error("no pending request found for CQ entry: id: ",
-					      id, " != r.id: ", r.id);
-					Nvme::Cqe::dump(b);
-					return;
-				}
+			uint16_t const queues = _nvme_ctrlr->io_queues();
 
-				out_cid = cid;
+			/* start with a different queue each time to be fair */
+			for (uint16_t i = 0; i < queues && !out.operation.valid(); i++) {
 
-				r.block_request.success = Nvme::Cqe::succeeded(b);
-				out = r.block_request;
+				uint16_t const qid = 1 + (_completion_qid + i) % queues;
 
-				_completed_pending = true;
-			});
+				_nvme_ctrlr->handle_io_completion(qid, [&] (Nvme::Cqe const &b) {
+
+					if (_verbose_io) { Nvme::Cqe::dump(b); }
+
+					uint32_t const id  = Nvme::Cqe::request_id(b);
+					uint16_t const cid = Nvme::Cqe::command_id(b);
+					Request &r = _requests[cid];
+					if (r.id != id) {
+						error("no pending request found for CQ entry: id: ",
+						      id, " != r.id: ", r.id);
+						Nvme::Cqe::dump(b);
+						return;
+					}
+
+					out_cid = cid;
+
+					r.block_request.success = Nvme::Cqe::succeeded(b);
+					out = r.block_request;
+
+					_completed_pending[qid] = true;
+				});
+			}
+			_completion_qid = (_completion_qid + 1) % queues;
 		}
 
 		void _free_completed_request(uint16_t const cid)
@@ -1866,8 +2045,6 @@ class Nvme::Driver : Genode::Noncopyable
 			default:
 				return;
 			}
-
-			_submits_pending = true;
 		}
 
 		void mask_irq()
@@ -1883,11 +2060,16 @@ class Nvme::Driver : Genode::Noncopyable
 
 		bool execute()
 		{
-			if (!_submits_pending) { return false; }
+			bool progress = false;
+
+			for (uint16_t qid = 1; qid <= _nvme_ctrlr->io_queues(); qid++) {
+				if (!_submits_pending[qid]) { continue; }
 
-			_nvme_ctrlr->commit_io(Nvme::IO_NSID);
-			_submits_pending = false;
-			return true;
+				_nvme_ctrlr->commit_io(qid);
+				_submits_pending[qid] = false;
+				progress = true;
+			}
+			return progress;
 		}
 
 		template <typename FN>
@@ -1906,10 +2088,12 @@ class Nvme::Driver : Genode::Noncopyable
 
 		void acknowledge_if_completed()
 		{
-			if (!_completed_pending) { return; }
+			for (uint16_t qid = 1; qid <= _nvme_ctrlr->io_queues(); qid++) {
+				if (!_completed_pending[qid]) { continue; }
 
-			_nvme_ctrlr->ack_io_completions(Nvme::IO_NSID);
-			_completed_pending = false;
+				_nvme_ctrlr->ack_io_completions(qid);
+				_completed_pending[qid] = false;
+			}
 		}
 };
 
@@ -1,5 +1,5 @@
 /*
- * \brief  Computing the Internet Checksum (conforms to RFC 1071)
+ * \brief  Computing the Internet Checksum (conforms to RFC 1071 and RFC 1624)
  * \author Martin Stein
  * \date   2018-03-23
  */
@@ -24,6 +24,15 @@ struct Packed_uint8
 } __attribute__((packed));
 
 
+static inline addr_t _fold_sum(addr_t sum)
+{
+	while (addr_t const sum_rsh = sum >> 16)
+		sum = (sum & 0xffff) + sum_rsh;
+
+	return sum;
+}
+
+
 uint16_t Net::internet_checksum(Packed_uint16 const *addr,
                                 size_t               size,
                                 addr_t               init_sum)
@@ -40,8 +49,7 @@ uint16_t Net::internet_checksum(Packed_uint16 const *addr,
 		sum += ((Packed_uint8 const *)addr)->value;
 
 	/* fold sum to 16-bit value */
-	while (addr_t const sum_rsh = sum >> 16)
-		sum = (sum & 0xffff) + sum_rsh;
+	sum = _fold_sum(sum);
 
 	/* return one's complement */
 	return (uint16_t)(~sum);
@@ -70,3 +78,39 @@ uint16_t Net::internet_checksum_pseudo_ip(Packed_uint16   const *ip_data,
 	/* add up IP data bytes */
 	return internet_checksum(ip_data, ip_data_sz, sum);
 }
+
+
+/****************************
+ ** Internet_checksum_diff **
+ ****************************/
+
+void Internet_checksum_diff::add_up_diff(Packed_uint16 const *new_data,
+                                         Packed_uint16 const *old_data,
+                                         size_t               data_sz)
+{
+	/*
+	 * Each replaced word 'm' with new value 'm_new' contributes
+	 * '~m + m_new' to the sum (RFC 1624, equation 3).
+	 */
+	for (; data_sz > 1; data_sz -= sizeof(Packed_uint16)) {
+		_value += (uint16_t)~old_data->value;
+		_value += new_data->value;
+		old_data++;
+		new_data++;
+	}
+	/* prevent overflows when adding up many differences */
+	_value = _fold_sum(_value);
+}
+
+
+void Internet_checksum_diff::add_up_diff(Internet_checksum_diff const &icd)
+{
+	_value = _fold_sum(_value + icd._value);
+}
+
+
+uint16_t Internet_checksum_diff::apply_to(uint16_t sum) const
+{
+	/* HC' = ~(~HC + ~m + m') */
+	return (uint16_t)~_fold_sum((uint16_t)~sum + _value);
+}
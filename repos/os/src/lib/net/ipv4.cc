@@ -145,6 +145,26 @@ void Ipv4_packet::update_checksum()
 }
 
 
+void Ipv4_packet::update_checksum(Internet_checksum_diff const &icd)
+{
+	_checksum = icd.apply_to(_checksum);
+}
+
+
+void Ipv4_packet::src(Ipv4_address v, Internet_checksum_diff &icd)
+{
+	icd.add_up_diff((Packed_uint16 *)&v.addr, (Packed_uint16 *)&_src, ADDR_LEN);
+	v.copy(&_src);
+}
+
+
+void Ipv4_packet::dst(Ipv4_address v, Internet_checksum_diff &icd)
+{
+	icd.add_up_diff((Packed_uint16 *)&v.addr, (Packed_uint16 *)&_dst, ADDR_LEN);
+	v.copy(&_dst);
+}
+
+
 bool Ipv4_packet::checksum_error() const
 {
 	return internet_checksum((Packed_uint16 *)this, sizeof(Ipv4_packet));
@@ -41,6 +41,36 @@ void Net::Udp_packet::update_checksum(Ipv4_address ip_src,
 }
 
 
+void Net::Udp_packet::update_checksum(Internet_checksum_diff const &icd)
+{
+	/* the sender didn't compute a checksum (RFC 768) */
+	if (!_checksum) {
+		return; }
+
+	_checksum = icd.apply_to(_checksum);
+
+	/* a computed zero checksum is transmitted as all ones (RFC 768) */
+	if (!_checksum) {
+		_checksum = 0xffff; }
+}
+
+
+void Net::Udp_packet::src_port(Port p, Internet_checksum_diff &icd)
+{
+	uint16_t const p_be = host_to_big_endian(p.value);
+	icd.add_up_diff((Packed_uint16 *)&p_be, (Packed_uint16 *)&_src_port, 2);
+	_src_port = p_be;
+}
+
+
+void Net::Udp_packet::dst_port(Port p, Internet_checksum_diff &icd)
+{
+	uint16_t const p_be = host_to_big_endian(p.value);
+	icd.add_up_diff((Packed_uint16 *)&p_be, (Packed_uint16 *)&_dst_port, 2);
+	_dst_port = p_be;
+}
+
+
 bool Net::Udp_packet::checksum_error(Ipv4_address ip_src,
                                      Ipv4_address ip_dst) const
 {
@@ -31,12 +31,58 @@ struct Vfs::Block_file_system
 {
 	typedef String<64> Name;
 
+	struct Job;
+
+	typedef Block::Connection<Job> Block_connection;
+
 	struct Local_factory;
 	struct Data_file_system;
 	struct Compound_file_system;
 };
 
 
+/**
+ * Block operation issued on behalf of a VFS handle
+ *
+ * The content of reads is copied from the packet stream directly to the
+ * destination buffer of the caller. The content of writes is copied from
+ * the source buffer of the caller into the packet stream at submission time.
+ */
+struct Vfs::Block_file_system::Job : Block_connection::Job
+{
+	Genode::Registry<Job>::Element _element;
+
+	/* handle waiting for the completion, nullptr for writes */
+	Vfs_handle *handle;
+
+	char       *dst;
+	char const *src;
+
+	/* bytes at the start of the operation not requested by the caller */
+	size_t const skip;
+
+	/* number of bytes requested by the caller */
+	size_t const length;
+
+	bool done { false };
+
+	/*
+	 * Noncopyable
+	 */
+	Job(Job const &);
+	Job &operator = (Job const &);
+
+	Job(Block_connection &block, Block::Operation operation,
+	    Genode::Registry<Job> &registry, Vfs_handle *handle,
+	    char *dst, char const *src, size_t skip, size_t length)
+	:
+		Block_connection::Job(block, operation),
+		_element(registry, *this),
+		handle(handle), dst(dst), src(src), skip(skip), length(length)
+	{ }
+};
+
+
 class Vfs::Block_file_system::Data_file_system : public Single_file_system
 {
 	private:
@@ -54,307 +100,458 @@ class Vfs::Block_file_system::Data_file_system : public Single_file_system
 		 */
 		Mutex _mutex { };
 
-		char                 *_block_buffer;
-		unsigned              _block_buffer_count;
-
-		Block::Connection<>        &_block;
+		Block_connection           &_block;
 		Block::Session::Info const &_info;
-		Block::Session::Tx::Source *_tx_source;
 
 		bool const _writeable;
 
-		class Block_vfs_handle : public Single_vfs_handle
+		enum { MAX_JOBS = 32 };
+
+		Genode::Registry<Job> _jobs { };
+
+		unsigned _jobs_in_flight { 0 };
+
+		/*
+		 * Upper bound of blocks per job, which allows for several jobs
+		 * being in flight at the same time
+		 */
+		Block::block_count_t const _max_job_blocks;
+
+		/* failed write to be reported by the next sync */
+		bool _write_error { false };
+
+		struct Block_vfs_handle;
+
+		Genode::Registry<Block_vfs_handle> _handles { };
+
+		struct Block_vfs_handle : Single_vfs_handle
 		{
-			private:
-
-				Genode::Entrypoint                &_ep;
-				Genode::Allocator                 &_alloc;
-				Mutex                             &_mutex;
-				char                              *_block_buffer;
-				unsigned                          &_block_buffer_count;
-				Block::Connection<>               &_block;
-				size_t                       const _block_size;
-				Block::sector_t              const _block_count;
-				Block::Session::Tx::Source        *_tx_source;
-				bool                         const _writeable;
-
-				void _block_for_ack()
-				{
-					while (!_tx_source->ack_avail())
-						_ep.wait_and_dispatch_one_io_signal();
-				}
+			enum class State { IDLE, QUEUED, IN_PROGRESS, COMPLETE };
+
+			Data_file_system &_data_fs;
+
+			Genode::Registry<Block_vfs_handle>::Element _element;
+
+			struct
+			{
+				State     state  { State::IDLE };
+				file_size offset { 0 };
+				file_size count  { 0 };
+				unsigned  jobs   { 0 };
+				bool      failed { false };
+			} queued_read { };
+
+			struct
+			{
+				State state   { State::IDLE };
+				bool  success { false };
+			} queued_sync { };
+
+			/* block buffer for partially written blocks */
+			char * const rmw_buffer;
+
+			struct
+			{
+				bool pending;
+				bool failed;
+			} rmw { false, false };
+
+			bool waiting() const
+			{
+				return queued_read.state != State::IDLE
+				    || queued_sync.state != State::IDLE;
+			}
+
+			/*
+			 * Noncopyable
+			 */
+			Block_vfs_handle(Block_vfs_handle const &);
+			Block_vfs_handle &operator = (Block_vfs_handle const &);
+
+			Block_vfs_handle(Data_file_system &data_fs, Genode::Allocator &alloc)
+			:
+				Single_vfs_handle(data_fs, data_fs, alloc, 0),
+				_data_fs(data_fs), _element(data_fs._handles, *this),
+				rmw_buffer(new (alloc) char[data_fs._info.block_size])
+			{ }
+
+			~Block_vfs_handle() { destroy(alloc(), rmw_buffer); }
+
+			Read_result read(char *dst, file_size count,
+			                 file_size &out_count) override
+			{
+				return _data_fs._complete_read(*this, dst, count, out_count);
+			}
+
+			Write_result write(char const *src, file_size count,
+			                   file_size &out_count) override
+			{
+				return _data_fs._write(*this, src, count, out_count);
+			}
+
+			Sync_result sync() override { return _data_fs._complete_sync(*this); }
+
+			bool read_ready() override { return true; }
+		};
+
+		file_size _size() const { return _info.block_count * _info.block_size; }
+
+		void _update_jobs()
+		{
+			_block.update_jobs(*this);
+
+			_jobs.for_each([&] (Job &job) {
+				if (!job.done)
+					return;
+
+				_jobs_in_flight--;
+				destroy(_env.alloc(), &job);
+			});
+		}
+
+		/**
+		 * Process I/O signals until 'condition' is met
+		 *
+		 * Must be called with '_mutex' acquired.
+		 */
+		template <typename FN>
+		void _wait_until(FN const &condition)
+		{
+			_update_jobs();
 
-				/*
-				 * Noncopyable
-				 */
-				Block_vfs_handle(Block_vfs_handle const &);
-				Block_vfs_handle &operator = (Block_vfs_handle const &);
+			while (!condition()) {
+				_mutex.release();
+				_env.env().ep().wait_and_dispatch_one_io_signal();
+				_mutex.acquire();
+				_update_jobs();
+			}
+		}
+
+		bool _write_in_flight(Block::block_number_t first,
+		                      Block::block_count_t  count)
+		{
+			bool result = false;
+			_jobs.for_each([&] (Job const &job) {
+				Block::Operation const op = job.operation();
+				if (op.type == Block::Operation::Type::WRITE
+				 && op.block_number < first + count
+				 && first < op.block_number + op.count)
+					result = true;
+			});
+			return result;
+		}
+
+		bool _job_slot_available() const { return _jobs_in_flight < MAX_JOBS; }
 
-				file_size _block_io(file_size nr, void *buf, file_size sz,
-				                    bool write, bool bulk = false)
-				{
-					Block::Packet_descriptor::Opcode op;
-					op = write ? Block::Packet_descriptor::WRITE : Block::Packet_descriptor::READ;
+		bool _job_pending()
+		{
+			bool result = false;
+			_jobs.for_each([&] (Job const &job) { result |= job.pending(); });
+			return result;
+		}
 
-					size_t packet_count = bulk ? (size_t)(sz / _block_size) : 1;
+		void _submit(Block::Operation::Type type, Block::block_number_t first,
+		             Block::block_count_t count, Vfs_handle *handle,
+		             char *dst, char const *src, size_t skip, size_t length)
+		{
+			Block::Operation const operation { .type         = type,
+			                                   .block_number = first,
+			                                   .count        = count };
+			_jobs_in_flight++;
+			new (_env.alloc())
+				Job(_block, operation, _jobs, handle, dst, src, skip, length);
+		}
 
-					Block::Packet_descriptor packet;
+		/**
+		 * Write blocks from the caller's buffer
+		 *
+		 * Returns after the content is copied into the packet stream. The
+		 * write itself completes asynchronously.
+		 */
+		void _write_blocks(Block::block_number_t first, Block::block_count_t count,
+		                   char const *src)
+		{
+			size_t const block_size = _info.block_size;
 
-					/* sanity check */
-					if (packet_count > _block_buffer_count) {
-						packet_count = _block_buffer_count;
-					}
+			while (count) {
 
-					while (true) {
-						try {
-							Mutex::Guard guard(_mutex);
+				Block::block_count_t const n = Genode::min(count, _max_job_blocks);
 
-							packet = _block.alloc_packet(packet_count * _block_size);
-							break;
-						} catch (Block::Session::Tx::Source::Packet_alloc_failed) {
+				/* the block device may reorder overlapping requests */
+				_wait_until([&] () {
+					return _job_slot_available() && !_write_in_flight(first, n); });
 
-							while (!_tx_source->ready_to_submit())
-								_ep.wait_and_dispatch_one_io_signal();
+				_submit(Block::Operation::Type::WRITE, first, n,
+				        nullptr, nullptr, src, 0, (size_t)(n*block_size));
 
-							if (packet_count > 1) {
-								packet_count /= 2;
-							}
-						}
-					}
-					Mutex::Guard guard(_mutex);
+				/* the caller's buffer must not be accessed after returning */
+				_wait_until([&] () { return !_job_pending(); });
 
-					Block::Packet_descriptor p(packet, op, nr, packet_count);
+				first += n;
+				count -= n;
+				src   += n*block_size;
+			}
+		}
 
-					if (write)
-						Genode::memcpy(_tx_source->packet_content(p), buf, packet_count * _block_size);
+		/**
+		 * Read-modify-write part of one block
+		 */
+		bool _write_partial(Block_vfs_handle &handle, Block::block_number_t nr,
+		                    size_t offset, char const *src, size_t length)
+		{
+			_wait_until([&] () {
+				return _job_slot_available() && !_write_in_flight(nr, 1); });
 
-					_tx_source->submit_packet(p);
+			handle.rmw = { .pending = true, .failed = false };
 
-					_block_for_ack();
+			_submit(Block::Operation::Type::READ, nr, 1, &handle,
+			        handle.rmw_buffer, nullptr, 0, _info.block_size);
 
-					p = _tx_source->get_acked_packet();
+			_wait_until([&] () { return !handle.rmw.pending; });
 
-					if (!p.succeeded()) {
-						Genode::error("Could not read block(s)");
-						_tx_source->release_packet(p);
-						return 0;
-					}
+			if (handle.rmw.failed)
+				return false;
 
-					if (!write)
-						Genode::memcpy(buf, _tx_source->packet_content(p), packet_count * _block_size);
+			Genode::memcpy(handle.rmw_buffer + offset, src, length);
+			_write_blocks(nr, 1, handle.rmw_buffer);
+			return true;
+		}
 
-					_tx_source->release_packet(p);
-					return packet_count * _block_size;
-				}
+		Write_result _write(Block_vfs_handle &handle, char const *src,
+		                    file_size count, file_size &out_count)
+		{
+			if (!_writeable) {
+				Genode::error("block device is not writeable");
+				return WRITE_ERR_INVALID;
+			}
 
-			public:
-
-				Block_vfs_handle(Directory_service                 &ds,
-				                 File_io_service                   &fs,
-				                 Genode::Entrypoint                &ep,
-				                 Genode::Allocator                 &alloc,
-				                 Mutex                             &mutex,
-				                 char                              *block_buffer,
-				                 unsigned                          &block_buffer_count,
-				                 Block::Connection<>               &block,
-				                 size_t                             block_size,
-				                 Block::sector_t                    block_count,
-				                 Block::Session::Tx::Source        *tx_source,
-				                 bool                               writeable)
-				:
-					Single_vfs_handle(ds, fs, alloc, 0),
-					_ep(ep),
-					_alloc(alloc),
-					_mutex(mutex),
-					_block_buffer(block_buffer),
-					_block_buffer_count(block_buffer_count),
-					_block(block),
-					_block_size(block_size),
-					_block_count(block_count),
-					_tx_source(tx_source),
-					_writeable(writeable)
-				{ }
-
-				Read_result read(char *dst, file_size count,
-				                 file_size &out_count) override
-				{
-					file_size seek_offset = seek();
-
-					file_size read = 0;
-					while (count > 0) {
-						file_size displ   = 0;
-						file_size length  = 0;
-						file_size nbytes  = 0;
-						file_size blk_nr  = seek_offset / _block_size;
-
-						displ = seek_offset % _block_size;
-
-						if ((displ + count) > _block_size)
-							length = (_block_size - displ);
-						else
-							length = count;
-
-						/*
-						 * We take a shortcut and read the blocks all at once if the
-						 * offset is aligned on a block boundary and the count is a
-						 * multiple of the block size, e.g. 4K reads will be read at
-						 * once.
-						 *
-						 * XXX this is quite hackish because we have to omit partial
-						 * blocks at the end.
-						 */
-						if (displ == 0 && !(count < _block_size)) {
-							file_size bytes_left = count - (count % _block_size);
-
-							nbytes = _block_io(blk_nr, dst + read, bytes_left, false, true);
-							if (nbytes == 0) {
-								Genode::error("error while reading block:", blk_nr, " from block device");
-								return READ_ERR_INVALID;
-							}
-
-							read  += nbytes;
-							count -= nbytes;
-							seek_offset += nbytes;
-
-							continue;
-						}
-
-						nbytes = _block_io(blk_nr, _block_buffer, _block_size, false);
-						if ((unsigned)nbytes != _block_size) {
-							Genode::error("error while reading block:", blk_nr, " from block device");
-							return READ_ERR_INVALID;
-						}
-
-						Genode::memcpy(dst + read, _block_buffer + displ, (size_t)length);
-
-						read  += length;
-						count -= length;
-						seek_offset += length;
-					}
-
-					out_count = read;
-
-					return READ_OK;
+			/* a zero-length write must not read-modify-write a block */
+			if (count == 0) {
+				out_count = 0;
+				return WRITE_OK;
+			}
 
+			Mutex::Guard guard(_mutex);
+
+			file_size const offset = handle.seek();
+			if (offset >= _size())
+				return WRITE_ERR_INVALID;
+
+			count = Genode::min(count, _size() - offset);
+
+			size_t          const block_size = _info.block_size;
+			Block::block_number_t nr         = offset / block_size;
+			size_t          const displ      = (size_t)(offset % block_size);
+
+			file_size written = 0;
+
+			/* leading partial block */
+			if (displ || count < block_size) {
+				size_t const length = (size_t)Genode::min(count, (file_size)(block_size - displ));
+
+				if (!_write_partial(handle, nr, displ, src, length)) {
+					Genode::error("error while writing block:", nr, " to block device");
+					return WRITE_ERR_IO;
 				}
 
-				Write_result write(char const *buf, file_size count,
-				                   file_size &out_count) override
-				{
-					if (!_writeable) {
-						Genode::error("block device is not writeable");
-						return WRITE_ERR_INVALID;
-					}
-
-					file_size seek_offset = seek();
-
-					file_size written = 0;
-					while (count > 0) {
-						file_size displ   = 0;
-						file_size length  = 0;
-						file_size nbytes  = 0;
-						file_size blk_nr  = seek_offset / _block_size;
-
-						displ = seek_offset % _block_size;
-
-						if ((displ + count) > _block_size)
-							length = (_block_size - displ);
-						else
-							length = count;
-
-						/*
-						 * We take a shortcut and write as much as possible without
-						 * using the block buffer if the offset is aligned on a block
-						 * boundary and the count is a multiple of the block size,
-						 * e.g. 4K writes will be written at once.
-						 *
-						 * XXX this is quite hackish because we have to omit partial
-						 * blocks at the end.
-						 */
-						if (displ == 0 && !(count < _block_size)) {
-							file_size bytes_left = count - (count % _block_size);
-
-							nbytes = _block_io(blk_nr, (void*)(buf + written),
-							                   bytes_left, true, true);
-							if (nbytes == 0) {
-								Genode::error("error while write block:", blk_nr, " to block device");
-								return WRITE_ERR_INVALID;
-							}
-
-							written     += nbytes;
-							count       -= nbytes;
-							seek_offset += nbytes;
-
-							continue;
-						}
-
-						/*
-						 * The offset is not aligned on a block boundary. Therefore
-						 * we need to read the block to the block buffer first and
-						 * put the buffer content at the right offset before we can
-						 * write the whole block back. In addition if length is less
-						 * than block size, we also have to read the block first.
-						 */
-						if (displ > 0 || length < _block_size)
-							_block_io(blk_nr, _block_buffer, _block_size, false);
-
-						Genode::memcpy(_block_buffer + displ, buf + written, (size_t)length);
-
-						nbytes = _block_io(blk_nr, _block_buffer, _block_size, true);
-						if ((unsigned)nbytes != _block_size) {
-							Genode::error("error while writing block:", blk_nr, " to block_device");
-							return WRITE_ERR_INVALID;
-						}
-
-						written     += length;
-						count       -= length;
-						seek_offset += length;
-					}
-
-					out_count = written;
-
-					return WRITE_OK;
+				written += length;
+				nr++;
+			}
+
+			/* complete blocks */
+			Block::block_count_t const blocks = (count - written) / block_size;
+			if (blocks) {
+				_write_blocks(nr, blocks, src + written);
+				written += blocks*block_size;
+				nr      += blocks;
+			}
 
+			/* trailing partial block */
+			if (written < count) {
+				size_t const length = (size_t)(count - written);
+
+				if (!_write_partial(handle, nr, 0, src + written, length)) {
+					Genode::error("error while writing block:", nr, " to block device");
+					return WRITE_ERR_IO;
 				}
 
-				Sync_result sync() override
-				{
-					/*
-					 * Just in case bail if we cannot submit the packet.
-					 * (Since the plugin operates in a synchronous fashion
-					 * that should not happen.)
-					 */
-					if (!_tx_source->ready_to_submit()) {
-						Genode::error("vfs_block: could not sync blocks");
-						return SYNC_ERR_INVALID;
-					}
+				written += length;
+			}
 
-					Block::Packet_descriptor p =
-						Block::Session::sync_all_packet_descriptor(
-							_block.info(), Block::Session::Tag { 0 });
+			out_count = written;
+			return WRITE_OK;
+		}
 
-					_tx_source->submit_packet(p);
+		bool _queue_read(Block_vfs_handle &handle, file_size count)
+		{
+			Mutex::Guard guard(_mutex);
 
-					_block_for_ack();
+			if (handle.queued_read.state != Block_vfs_handle::State::IDLE)
+				return false;
 
-					p = _tx_source->get_acked_packet();
-					_tx_source->release_packet(p);
+			file_size const offset = handle.seek();
 
-					if (!p.succeeded()) {
-						Genode::error("vfs_block: syncing blocks failed");
-						return SYNC_ERR_INVALID;
-					}
+			handle.queued_read = { };
+			handle.queued_read.state  = Block_vfs_handle::State::QUEUED;
+			handle.queued_read.offset = offset;
+			handle.queued_read.count  = offset < _size()
+			                          ? Genode::min(count, _size() - offset) : 0;
+			return true;
+		}
 
-					return SYNC_OK;
-				}
+		/**
+		 * Issue the jobs of a queued read
+		 *
+		 * The jobs are issued not before the destination buffer is known,
+		 * which allows for copying the content directly to the caller.
+		 *
+		 * \return  false if the jobs cannot be issued yet
+		 */
+		bool _issue_read(Block_vfs_handle &handle, char *dst)
+		{
+			size_t    const block_size = _info.block_size;
+			file_size const offset     = handle.queued_read.offset;
+			file_size const count      = handle.queued_read.count;
 
-				bool read_ready() override { return true; }
-		};
+			Block::block_number_t const first = offset / block_size;
+			Block::block_number_t const end   = (offset + count + block_size - 1) / block_size;
+
+			if (_jobs_in_flight + (end - first + _max_job_blocks - 1) / _max_job_blocks > MAX_JOBS
+			 && _jobs_in_flight)
+				return false;
+
+			if (_write_in_flight(first, end - first))
+				return false;
+
+			size_t    skip = (size_t)(offset % block_size);
+			file_size left = count;
+
+			for (Block::block_number_t nr = first; nr < end; ) {
+
+				Block::block_count_t const n = Genode::min(end - nr, _max_job_blocks);
+
+				size_t const length =
+					(size_t)Genode::min(left, (file_size)(n*block_size - skip));
+
+				_submit(Block::Operation::Type::READ, nr, n, &handle, dst,
+				        nullptr, skip, length);
+
+				handle.queued_read.jobs++;
+
+				dst  += length;
+				left -= length;
+				skip  = 0;
+				nr   += n;
+			}
+
+			handle.queued_read.state = Block_vfs_handle::State::IN_PROGRESS;
+			_update_jobs();
+			return true;
+		}
+
+		Read_result _complete_read(Block_vfs_handle &handle, char *dst,
+		                           file_size count, file_size &out_count)
+		{
+			Mutex::Guard guard(_mutex);
+
+			using State = Block_vfs_handle::State;
+
+			auto &read = handle.queued_read;
+
+			switch (read.state) {
+
+			case State::IDLE:
+				return READ_ERR_INVALID;
+
+			case State::QUEUED:
+
+				read.count = Genode::min(read.count, count);
+
+				if (read.count && !_issue_read(handle, dst))
+					return READ_QUEUED;
+
+				[[fallthrough]];
+
+			case State::IN_PROGRESS:
+			case State::COMPLETE:
+
+				if (read.jobs)
+					return READ_QUEUED;
+			}
+
+			Read_result const result = read.failed ? READ_ERR_IO : READ_OK;
+
+			if (result == READ_OK)
+				out_count = read.count;
+			else
+				Genode::error("error while reading from block device at offset ",
+				              read.offset);
+
+			read = { };
+			return result;
+		}
+
+		Sync_result _complete_sync(Block_vfs_handle &handle)
+		{
+			Mutex::Guard guard(_mutex);
+
+			using State = Block_vfs_handle::State;
+
+			auto &sync = handle.queued_sync;
+
+			if (sync.state == State::IDLE)
+				sync.state = State::QUEUED;
+
+			if (sync.state == State::QUEUED) {
+
+				bool writes = false;
+				_jobs.for_each([&] (Job const &job) {
+					if (job.operation().type == Block::Operation::Type::WRITE)
+						writes = true; });
+
+				/* sync after all preceding writes are completed */
+				if (writes || !_job_slot_available())
+					return SYNC_QUEUED;
+
+				_submit(Block::Operation::Type::SYNC, 0, _info.block_count,
+				        &handle, nullptr, nullptr, 0, 0);
+
+				sync.state = State::IN_PROGRESS;
+				_update_jobs();
+			}
+
+			if (sync.state != State::COMPLETE)
+				return SYNC_QUEUED;
+
+			bool const success = sync.success && !_write_error;
+
+			_write_error = false;
+			sync = { };
+
+			if (!success) {
+				Genode::error("vfs_block: syncing blocks failed");
+				return SYNC_ERR_INVALID;
+			}
+
+			return SYNC_OK;
+		}
+
+		static Block::block_count_t _init_max_job_blocks(Block_connection &block,
+		                                                 Block::Session::Info const &info,
+		                                                 unsigned block_buffer_count)
+		{
+			if (block_buffer_count)
+				return block_buffer_count;
+
+			/* let at least four jobs fit into the packet stream */
+			size_t const bytes = block.tx()->bulk_buffer_size() / 4;
+			return Genode::max(bytes / info.block_size, (size_t)1);
+		}
 
 	public:
 
 		Data_file_system(Vfs::Env                   &env,
-		                 Block::Connection<>        &block,
+		                 Block_connection           &block,
 		                 Block::Session::Info const &info,
 		                 Name                 const &name,
 		                 unsigned                    block_buffer_count)
@@ -363,24 +560,102 @@ class Vfs::Block_file_system::Data_file_system : public Single_file_system
 			                     info.writeable ? Node_rwx::rw() : Node_rwx::ro(),
 			                     Genode::Xml_node("<data/>") },
 			_env(env),
-			_block_buffer(0),
-			_block_buffer_count(block_buffer_count),
 			_block(block),
 			_info(info),
-			_tx_source(_block.tx()),
-			_writeable(_info.writeable)
+			_writeable(_info.writeable),
+			_max_job_blocks(_init_max_job_blocks(block, info, block_buffer_count))
+		{ }
+
+		static char const *name()   { return "data"; }
+		char const *type() override { return "data"; }
+
+		/**
+		 * Handle I/O signal of the block session
+		 */
+		void handle_io()
 		{
-			_block_buffer = new (_env.alloc())
-				char[_block_buffer_count * _info.block_size];
+			{
+				Mutex::Guard guard(_mutex);
+				_update_jobs();
+			}
+
+			_handles.for_each([&] (Block_vfs_handle &handle) {
+				if (handle.waiting())
+					handle.io_progress_response(); });
 		}
 
-		~Data_file_system()
+
+		/************************
+		 ** Update_jobs_policy **
+		 ************************/
+
+		void produce_write_content(Job &job, Genode::off_t offset, char *dst, size_t length)
 		{
-			destroy(_env.alloc(), _block_buffer);
+			if (job.src)
+				Genode::memcpy(dst, job.src + offset, length);
+		}
+
+		void consume_read_result(Job &job, Genode::off_t offset,
+		                         char const *src, size_t length)
+		{
+			if (!job.dst)
+				return;
+
+			/* intersect received window with the requested range */
+			size_t const from = Genode::max((size_t)offset, job.skip);
+			size_t const to   = Genode::min((size_t)offset + length,
+			                                job.skip + job.length);
+			if (from < to)
+				Genode::memcpy(job.dst + (from - job.skip),
+				               src + (from - (size_t)offset), to - from);
+		}
+
+		void completed(Job &job, bool success)
+		{
+			job.done = true;
+
+			Block_vfs_handle *handle = static_cast<Block_vfs_handle *>(job.handle);
+
+			switch (job.operation().type) {
+
+			case Block::Operation::Type::READ:
+				if (!handle)
+					break;
+
+				if (job.dst == handle->rmw_buffer) {
+					handle->rmw = { .pending = false, .failed = !success };
+					break;
+				}
+
+				handle->queued_read.jobs--;
+				if (!success)
+					handle->queued_read.failed = true;
+				if (!handle->queued_read.jobs)
+					handle->queued_read.state = Block_vfs_handle::State::COMPLETE;
+				break;
+
+			case Block::Operation::Type::WRITE:
+				if (!success) {
+					Genode::error("error while writing block:",
+					              job.operation().block_number, " to block device");
+					_write_error = true;
+				}
+				break;
+
+			case Block::Operation::Type::SYNC:
+				if (!handle)
+					break;
+
+				handle->queued_sync.state   = Block_vfs_handle::State::COMPLETE;
+				handle->queued_sync.success = success;
+				break;
+
+			case Block::Operation::Type::TRIM:
+			case Block::Operation::Type::INVALID:
+				break;
+			}
 		}
 
-		static char const *name()   { return "data"; }
-		char const *type() override { return "data"; }
 
 		/*********************************
 		 ** Directory service interface **
@@ -394,23 +669,33 @@ class Vfs::Block_file_system::Data_file_system : public Single_file_system
 				return OPEN_ERR_UNACCESSIBLE;
 
 			try {
-				*out_handle = new (alloc) Block_vfs_handle(*this, *this,
-				                                           _env.env().ep(),
-				                                           alloc,
-				                                           _mutex,
-				                                           _block_buffer,
-				                                           _block_buffer_count,
-				                                           _block,
-				                                           _info.block_size,
-				                                           _info.block_count,
-				                                           _tx_source,
-				                                           _info.writeable);
+				Mutex::Guard guard(_mutex);
+
+				*out_handle = new (alloc) Block_vfs_handle(*this, alloc);
 				return OPEN_OK;
 			}
 			catch (Genode::Out_of_ram)  { return OPEN_ERR_OUT_OF_RAM; }
 			catch (Genode::Out_of_caps) { return OPEN_ERR_OUT_OF_CAPS; }
 		}
 
+		void close(Vfs_handle *handle) override
+		{
+			{
+				Mutex::Guard guard(_mutex);
+
+				/* let jobs of the handle complete without touching it */
+				_jobs.for_each([&] (Job &job) {
+					if (job.handle != handle)
+						return;
+
+					job.handle = nullptr;
+					job.dst    = nullptr;
+				});
+			}
+
+			Single_file_system::close(handle);
+		}
+
 		Stat_result stat(char const *path, Stat &out) override
 		{
 			Stat_result const result = Single_file_system::stat(path, out);
@@ -423,6 +708,13 @@ class Vfs::Block_file_system::Data_file_system : public Single_file_system
 		 ** File I/O service interface **
 		 ********************************/
 
+		bool queue_read(Vfs_handle *vfs_handle, file_size count) override
+		{
+			Block_vfs_handle *handle = static_cast<Block_vfs_handle *>(vfs_handle);
+
+			return handle ? _queue_read(*handle, count) : false;
+		}
+
 		Ftruncate_result ftruncate(Vfs_handle *, file_size) override
 		{
 			return FTRUNCATE_OK;
@@ -439,17 +731,19 @@ struct Vfs::Block_file_system::Local_factory : File_system_factory
 
 	Vfs::Env &_env;
 
+	size_t const _buffer_size;
+
 	Genode::Allocator_avl _tx_block_alloc { &_env.alloc() };
 
-	Block::Connection<> _block {
-		_env.env(), &_tx_block_alloc, 128*1024, _label.string() };
+	Block_connection _block {
+		_env.env(), &_tx_block_alloc, _buffer_size, _label.string() };
 
 	Block::Session::Info const _info { _block.info() };
 
 	Genode::Io_signal_handler<Local_factory> _block_signal_handler {
 		_env.env().ep(), *this, &Local_factory::_handle_block_signal };
 
-	void _handle_block_signal() { }
+	void _handle_block_signal() { _data_fs.handle_io(); }
 
 	Data_file_system _data_fs;
 	
@@ -475,9 +769,19 @@ struct Vfs::Block_file_system::Local_factory : File_system_factory
 		return config.attribute_value("name", Name("block"));
 	}
 
+	/**
+	 * Return maximal number of blocks per request, 0 selects the maximum
+	 * that allows for several requests in flight
+	 */
 	static unsigned buffer_count(Xml_node config)
 	{
-		return config.attribute_value("block_buffer_count", 1U);
+		return config.attribute_value("block_buffer_count", 0U);
+	}
+
+	static size_t buffer_size(Xml_node config)
+	{
+		return config.attribute_value("buffer_size",
+		                              Genode::Number_of_bytes(128*1024));
 	}
 
 	Local_factory(Vfs::Env &env, Xml_node config)
@@ -485,6 +789,7 @@ struct Vfs::Block_file_system::Local_factory : File_system_factory
 		_label   { config.attribute_value("label", Label("")) },
 		_name    { name(config) },
 		_env     { env },
+		_buffer_size { buffer_size(config) },
 		_data_fs { _env, _block, _info, name(config), buffer_count(config) }
 	{
 		_block.sigh(_block_signal_handler);
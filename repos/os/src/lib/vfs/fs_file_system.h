@@ -61,9 +61,11 @@ class Vfs::Fs_file_system : public File_system
 			enum class Queued_state { IDLE, QUEUED, ACK };
 			Queued_state queued_read_state = Queued_state::IDLE;
 			Queued_state queued_sync_state = Queued_state::IDLE;
+			Queued_state queued_write_state = Queued_state::IDLE;
 
 			::File_system::Packet_descriptor queued_read_packet { };
 			::File_system::Packet_descriptor queued_sync_packet { };
+			::File_system::Packet_descriptor queued_write_packet { };
 		};
 
 		struct Fs_vfs_handle;
@@ -127,6 +129,8 @@ class Vfs::Fs_file_system : public File_system
 			using Handle_state::queued_read_packet;
 			using Handle_state::queued_sync_packet;
 			using Handle_state::queued_sync_state;
+			using Handle_state::queued_write_packet;
+			using Handle_state::queued_write_state;
 			using Handle_state::read_ready_state;
 
 			::File_system::Connection &_fs;
@@ -196,6 +200,43 @@ class Vfs::Fs_file_system : public File_system
 				return result;
 			}
 
+			Read_result _complete_readv(Segment const *segments, unsigned count,
+			                            file_size &out_count)
+			{
+				if (queued_read_state != Handle_state::Queued_state::ACK)
+					return READ_QUEUED;
+
+				::File_system::Session::Tx::Source &source = *_fs.tx();
+
+				::File_system::Packet_descriptor const
+					packet = queued_read_packet;
+
+				Read_result result = packet.succeeded() ? READ_OK : READ_ERR_IO;
+
+				if (result == READ_OK) {
+
+					char const *src   = source.packet_content(packet);
+					file_size   avail = packet.length();
+
+					for (unsigned i = 0; i < count && avail; i++) {
+						file_size const n = min(segments[i].num_bytes, avail);
+
+						memcpy(segments[i].start, src, (size_t)n);
+
+						src       += n;
+						avail     -= n;
+						out_count += n;
+					}
+				}
+
+				queued_read_state  = Handle_state::Queued_state::IDLE;
+				queued_read_packet = ::File_system::Packet_descriptor();
+
+				source.release_packet(packet);
+
+				return result;
+			}
+
 			Fs_vfs_handle(File_system &fs, Allocator &alloc,
 			              int status_flags, Handle_space &space,
 			              ::File_system::Node_handle node_handle,
@@ -223,6 +264,17 @@ class Vfs::Fs_file_system : public File_system
 				return READ_ERR_INVALID;
 			}
 
+			virtual Read_result complete_readv(Segment const *segments,
+			                                   unsigned count,
+			                                   file_size &out_count)
+			{
+				if (!count)
+					return READ_OK;
+
+				return complete_read(segments[0].start, segments[0].num_bytes,
+				                     out_count);
+			}
+
 			bool queue_sync()
 			{
 				if (queued_sync_state != Handle_state::Queued_state::IDLE)
@@ -313,6 +365,12 @@ class Vfs::Fs_file_system : public File_system
 			{
 				return _complete_read(dst, count, out_count);
 			}
+
+			Read_result complete_readv(Segment const *segments, unsigned count,
+			                           file_size &out_count) override
+			{
+				return _complete_readv(segments, count, out_count);
+			}
 		};
 
 		struct Fs_vfs_dir_handle : Fs_vfs_handle
@@ -535,6 +593,57 @@ class Vfs::Fs_file_system : public File_system
 			return count;
 		}
 
+		/**
+		 * Gather segments into one write packet
+		 */
+		file_size _writev(Fs_vfs_handle &handle, Const_segment const *segments,
+		                  unsigned count, file_size seek_offset)
+		{
+			::File_system::Session::Tx::Source &source = *_fs.tx();
+			using ::File_system::Packet_descriptor;
+
+			file_size total = 0;
+			for (unsigned i = 0; i < count; i++)
+				total += segments[i].num_bytes;
+
+			file_size const max_packet_size = source.bulk_buffer_size() / 2;
+			total = min(max_packet_size, total);
+
+			if (!total)
+				return 0;
+
+			if (!source.ready_to_submit()) {
+				if (!handle.enqueued())
+					_congested_handles.enqueue(handle);
+				throw Insufficient_buffer();
+			}
+
+			try {
+				Packet_descriptor packet_in(source.alloc_packet((size_t)total),
+				                            handle.file_handle(),
+				                            Packet_descriptor::WRITE,
+				                            (size_t)total,
+				                            seek_offset);
+
+				char     *dst  = source.packet_content(packet_in);
+				file_size left = total;
+				for (unsigned i = 0; i < count && left; i++) {
+					file_size const n = min(segments[i].num_bytes, left);
+					memcpy(dst, segments[i].start, (size_t)n);
+					dst  += n;
+					left -= n;
+				}
+
+				/* pass packet to server side */
+				source.submit_packet(packet_in);
+			} catch (::File_system::Session::Tx::Source::Packet_alloc_failed) {
+				if (!handle.enqueued())
+					_congested_handles.enqueue(handle);
+				throw Insufficient_buffer();
+			}
+			return total;
+		}
+
 		void _handle_ack()
 		{
 			::File_system::Session::Tx::Source &source = *_fs.tx();
@@ -546,6 +655,8 @@ class Vfs::Fs_file_system : public File_system
 
 				Handle_space::Id const id(packet.handle());
 
+				bool queued_write = false;
+
 				auto handle_read = [&] (Fs_vfs_handle &handle) {
 
 					if (!packet.succeeded())
@@ -564,6 +675,14 @@ class Vfs::Fs_file_system : public File_system
 						break;
 
 					case Packet_descriptor::WRITE:
+						/* keep packet of a queued write for 'complete_write' */
+						if (handle.queued_write_state == Handle_state::Queued_state::QUEUED
+						 && handle.queued_write_packet.offset() == packet.offset()) {
+							handle.queued_write_packet = packet;
+							handle.queued_write_state  = Handle_state::Queued_state::ACK;
+							queued_write = true;
+						}
+
 						/*
 						 * Notify anyone who might have failed on
 						 * 'alloc_packet()'
@@ -598,7 +717,7 @@ class Vfs::Fs_file_system : public File_system
 				catch (Handle_space::Unknown_id) {
 					Genode::warning("ack for unknown File_system handle ", id); }
 
-				if (packet.operation() == Packet_descriptor::WRITE) {
+				if (packet.operation() == Packet_descriptor::WRITE && !queued_write) {
 					Mutex::Guard guard(_mutex);
 					source.release_packet(packet);
 				}
@@ -914,6 +1033,9 @@ class Vfs::Fs_file_system : public File_system
 			if (fs_handle->enqueued())
 				_congested_handles.remove(*fs_handle);
 
+			if (fs_handle->queued_write_state == Handle_state::Queued_state::ACK)
+				_fs.tx()->release_packet(fs_handle->queued_write_packet);
+
 			_fs.close(fs_handle->file_handle());
 			destroy(fs_handle->alloc(), fs_handle);
 		}
@@ -978,6 +1100,90 @@ class Vfs::Fs_file_system : public File_system
 			return WRITE_OK;
 		}
 
+		Write_result writev(Vfs_handle *vfs_handle, Const_segment const *segments,
+		                    unsigned count, file_size &out_count) override
+		{
+			Mutex::Guard guard(_mutex);
+
+			Fs_vfs_handle &handle = static_cast<Fs_vfs_handle &>(*vfs_handle);
+
+			out_count = _writev(handle, segments, count, handle.seek());
+			return WRITE_OK;
+		}
+
+		bool queue_write(Vfs_handle *vfs_handle, char const *src,
+		                 file_size count) override
+		{
+			Mutex::Guard guard(_mutex);
+
+			Fs_vfs_handle &handle = static_cast<Fs_vfs_handle &>(*vfs_handle);
+
+			if (handle.queued_write_state != Handle_state::Queued_state::IDLE)
+				return true;
+
+			::File_system::Session::Tx::Source &source = *_fs.tx();
+			using ::File_system::Packet_descriptor;
+
+			file_size const max_packet_size = source.bulk_buffer_size() / 2;
+			count = min(max_packet_size, count);
+
+			auto congested = [&] ()
+			{
+				if (!handle.enqueued())
+					_congested_handles.enqueue(handle);
+				return false;
+			};
+
+			if (!source.ready_to_submit())
+				return congested();
+
+			try {
+				Packet_descriptor const packet(source.alloc_packet((size_t)count),
+				                               handle.file_handle(),
+				                               Packet_descriptor::WRITE,
+				                               (size_t)count,
+				                               handle.seek());
+
+				memcpy(source.packet_content(packet), src, (size_t)count);
+
+				handle.queued_write_packet = packet;
+				handle.queued_write_state  = Handle_state::Queued_state::QUEUED;
+
+				/* pass packet to server side */
+				source.submit_packet(packet);
+			}
+			catch (::File_system::Session::Tx::Source::Packet_alloc_failed) {
+				return congested(); }
+
+			return true;
+		}
+
+		Write_result complete_write(Vfs_handle *vfs_handle, char const *,
+		                            file_size, file_size &out_count) override
+		{
+			Mutex::Guard guard(_mutex);
+
+			out_count = 0;
+
+			Fs_vfs_handle &handle = static_cast<Fs_vfs_handle &>(*vfs_handle);
+
+			if (handle.queued_write_state != Handle_state::Queued_state::ACK)
+				return WRITE_QUEUED;
+
+			::File_system::Packet_descriptor const packet = handle.queued_write_packet;
+
+			Write_result const result = packet.succeeded() ? WRITE_OK : WRITE_ERR_IO;
+			if (result == WRITE_OK)
+				out_count = packet.length();
+
+			handle.queued_write_state  = Handle_state::Queued_state::IDLE;
+			handle.queued_write_packet = ::File_system::Packet_descriptor();
+
+			_fs.tx()->release_packet(packet);
+
+			return result;
+		}
+
 		bool queue_read(Vfs_handle *vfs_handle, file_size count) override
 		{
 			Mutex::Guard guard(_mutex);
@@ -1005,6 +1211,21 @@ class Vfs::Fs_file_system : public File_system
 			return result;
 		}
 
+		Read_result complete_readv(Vfs_handle *vfs_handle, Segment const *segments,
+		                           unsigned count, file_size &out_count) override
+		{
+			Mutex::Guard guard(_mutex);
+
+			out_count = 0;
+
+			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
+
+			Read_result result = handle->complete_readv(segments, count, out_count);
+			if (result == READ_QUEUED && !handle->enqueued())
+				_congested_handles.enqueue(*handle);
+			return result;
+		}
+
 		bool read_ready(Vfs_handle *vfs_handle) override
 		{
 			Fs_vfs_handle *handle = static_cast<Fs_vfs_handle *>(vfs_handle);
@@ -0,0 +1,298 @@
+/*
+ * \brief  Page cache of the block cache
+ * \author Stefan Kalkowski
+ * \date   2022-07-18
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _BLOCK_CACHE__CACHE_H_
+#define _BLOCK_CACHE__CACHE_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <base/attached_ram_dataspace.h>
+#include <util/misc_math.h>
+
+namespace Block_cache {
+
+	using namespace Genode;
+
+	typedef Genode::uint64_t page_number_t;
+
+	class Cache;
+}
+
+
+/**
+ * Fixed number of equally-sized pages, looked up by their page number
+ *
+ * The pages are kept in a least-recently-used list. A page can only be
+ * evicted if its content is neither dirty nor in transfer from or to the
+ * backing device.
+ */
+class Block_cache::Cache : Noncopyable
+{
+	public:
+
+		enum { INVALID = ~0u };
+
+		struct Page
+		{
+			enum class State { FREE, LOADING, VALID };
+
+			State         state   { State::FREE };
+			page_number_t number  { 0 };
+			bool          dirty   { false };
+			bool          writing { false };
+
+			/* links of the LRU list and the hash chain */
+			unsigned prev { INVALID };
+			unsigned next { INVALID };
+			unsigned hash { INVALID };
+
+			bool present() const { return state == State::VALID; }
+
+			bool evictable() const
+			{
+				return state != State::LOADING && !dirty && !writing;
+			}
+		};
+
+	private:
+
+		Allocator &_alloc;
+
+		size_t   const _page_size;
+		unsigned const _num_pages;
+		unsigned const _num_buckets;
+
+		Attached_ram_dataspace _data;
+
+		Page     *const _pages;
+		unsigned *const _buckets;
+
+		/* LRU list, '_lru' is the least and '_mru' the most recently used */
+		unsigned _lru { INVALID };
+		unsigned _mru { INVALID };
+
+		unsigned _dirty { 0 };
+
+		unsigned long _evictions { 0 };
+
+		static unsigned _init_num_buckets(unsigned pages)
+		{
+			unsigned buckets = 1;
+			while (buckets < pages)
+				buckets <<= 1;
+
+			return buckets;
+		}
+
+		unsigned _bucket(page_number_t number) const
+		{
+			/* mix the bits to spread sequential page numbers */
+			uint64_t const h = number * 0x9e3779b97f4a7c15ull;
+			return (unsigned)(h >> 32) & (_num_buckets - 1);
+		}
+
+		void _unlink(unsigned index)
+		{
+			Page &p = _pages[index];
+
+			if (p.prev != INVALID) _pages[p.prev].next = p.next;
+			else                   _lru                = p.next;
+
+			if (p.next != INVALID) _pages[p.next].prev = p.prev;
+			else                   _mru                = p.prev;
+
+			p.prev = p.next = INVALID;
+		}
+
+		void _append(unsigned index)
+		{
+			Page &p = _pages[index];
+
+			p.prev = _mru;
+			p.next = INVALID;
+
+			if (_mru != INVALID) _pages[_mru].next = index;
+			else                 _lru              = index;
+
+			_mru = index;
+		}
+
+		void _hash_insert(unsigned index)
+		{
+			unsigned &head = _buckets[_bucket(_pages[index].number)];
+			_pages[index].hash = head;
+			head = index;
+		}
+
+		void _hash_remove(unsigned index)
+		{
+			unsigned *link = &_buckets[_bucket(_pages[index].number)];
+			while (*link != INVALID) {
+				if (*link == index) {
+					*link = _pages[index].hash;
+					break;
+				}
+				link = &_pages[*link].hash;
+			}
+			_pages[index].hash = INVALID;
+		}
+
+		/*
+		 * Noncopyable
+		 */
+		Cache(Cache const &);
+		Cache &operator = (Cache const &);
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param page_size  size of one page in bytes
+		 * \param size       RAM budget for the page content in bytes
+		 */
+		Cache(Ram_allocator &ram, Region_map &rm, Allocator &alloc,
+		      size_t page_size, size_t size)
+		:
+			_alloc(alloc), _page_size(page_size),
+			_num_pages((unsigned)max(size / page_size, (size_t)1)),
+			_num_buckets(_init_num_buckets(_num_pages)),
+			_data(ram, rm, _num_pages * _page_size),
+			_pages(new (_alloc) Page[_num_pages]),
+			_buckets(new (_alloc) unsigned[_num_buckets])
+		{
+			for (unsigned i = 0; i < _num_buckets; i++)
+				_buckets[i] = INVALID;
+
+			for (unsigned i = 0; i < _num_pages; i++)
+				_append(i);
+		}
+
+		~Cache()
+		{
+			destroy(_alloc, _buckets);
+			destroy(_alloc, _pages);
+		}
+
+		size_t   page_size()   const { return _page_size; }
+		unsigned num_pages()   const { return _num_pages; }
+		unsigned dirty_pages() const { return _dirty; }
+
+		unsigned long evictions() const { return _evictions; }
+
+		Page &page(unsigned index) { return _pages[index]; }
+
+		char *data(unsigned index)
+		{
+			return _data.local_addr<char>() + index * _page_size;
+		}
+
+		/**
+		 * Look up page
+		 *
+		 * \return  index of the page or INVALID if the page is not cached
+		 */
+		unsigned lookup(page_number_t number) const
+		{
+			for (unsigned i = _buckets[_bucket(number)]; i != INVALID; i = _pages[i].hash)
+				if (_pages[i].number == number && _pages[i].state != Page::State::FREE)
+					return i;
+
+			return INVALID;
+		}
+
+		/**
+		 * Mark page as most recently used
+		 */
+		void touch(unsigned index)
+		{
+			if (index == _mru)
+				return;
+
+			_unlink(index);
+			_append(index);
+		}
+
+		/**
+		 * Allocate page by evicting the least recently used evictable page
+		 *
+		 * The page is returned in LOADING state.
+		 *
+		 * \return  index of the page or INVALID if all pages are in use
+		 */
+		unsigned alloc(page_number_t number)
+		{
+			unsigned index = _lru;
+			while (index != INVALID && !_pages[index].evictable())
+				index = _pages[index].next;
+
+			if (index == INVALID)
+				return INVALID;
+
+			Page &p = _pages[index];
+			if (p.state != Page::State::FREE) {
+				_hash_remove(index);
+				_evictions++;
+			}
+
+			p.state  = Page::State::LOADING;
+			p.number = number;
+			_hash_insert(index);
+			touch(index);
+			return index;
+		}
+
+		/**
+		 * Return page to the free pages, used if loading failed
+		 */
+		void free(unsigned index)
+		{
+			Page &p = _pages[index];
+
+			_hash_remove(index);
+			mark_clean(index);
+			p.state = Page::State::FREE;
+
+			/* reuse free pages first */
+			_unlink(index);
+			p.next = _lru;
+			if (_lru != INVALID) _pages[_lru].prev = index;
+			else                 _mru              = index;
+			_lru = index;
+		}
+
+		void mark_dirty(unsigned index)
+		{
+			if (!_pages[index].dirty) _dirty++;
+			_pages[index].dirty = true;
+		}
+
+		void mark_clean(unsigned index)
+		{
+			if (_pages[index].dirty) _dirty--;
+			_pages[index].dirty = false;
+		}
+
+		/**
+		 * Call 'fn' with the index of each dirty page
+		 */
+		template <typename FN>
+		void for_each_dirty(FN const &fn)
+		{
+			for (unsigned i = 0; i < _num_pages && _dirty; i++)
+				if (_pages[i].dirty)
+					fn(i);
+		}
+};
+
+#endif /* _BLOCK_CACHE__CACHE_H_ */
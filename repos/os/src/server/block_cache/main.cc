@@ -0,0 +1,991 @@
+/*
+ * \brief  Block-session proxy that caches the content of the backing device
+ * \author Stefan Kalkowski
+ * \date   2022-07-18
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_rom_dataspace.h>
+#include <base/attached_ram_dataspace.h>
+#include <base/allocator_avl.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/registry.h>
+#include <block_session/connection.h>
+#include <block_session/rpc_object.h>
+#include <block/request_stream.h>
+#include <os/reporter.h>
+#include <os/session_policy.h>
+#include <root/root.h>
+#include <timer_session/connection.h>
+
+/* local includes */
+#include "cache.h"
+
+namespace Block_cache {
+
+	using namespace Block;
+
+	struct Job;
+	struct Pending;
+	class  Session_component;
+	class  Main;
+
+	typedef Block::Connection<Job>   Block_connection;
+	typedef Request_stream::Response Response;
+}
+
+
+/**
+ * Operation at the backing device
+ *
+ * A job covers a run of pages with consecutive page numbers.
+ */
+struct Block_cache::Job : Block_connection::Job
+{
+	enum { MAX_PAGES = 16 };
+
+	enum class Type { LOAD, WRITE_BACK, SYNC };
+
+	Registry<Job>::Element _element;
+
+	Type          const type;
+	page_number_t const first;
+	unsigned            count { 0 };
+	unsigned            pages[MAX_PAGES] { };
+
+	bool done    { false };
+	bool success { false };
+
+	Job(Block_connection &block, Registry<Job> &registry, Type type,
+	    Operation operation, page_number_t first, unsigned const *pages,
+	    unsigned count)
+	:
+		Block_connection::Job(block, operation),
+		_element(registry, *this), type(type), first(first), count(count)
+	{
+		for (unsigned i = 0; i < count; i++)
+			this->pages[i] = pages[i];
+	}
+};
+
+
+/**
+ * Client request that is accepted but not yet acknowledged
+ */
+struct Block_cache::Pending
+{
+	Request request { };
+
+	bool          in_use      { false };
+	bool          done        { false };
+	bool          visited     { false };  /* statistics are accounted */
+	bool          failed      { false };  /* loading of a page failed */
+	bool          sync_issued { false };
+	page_number_t next        { 0 };      /* first page not yet transferred */
+};
+
+
+class Block_cache::Session_component : public Rpc_object<Block::Session>,
+                                       public Request_stream
+{
+	public:
+
+		enum { MAX_PENDING = 32 };
+
+		Session_label const label;
+
+	private:
+
+		Env &_env;
+
+		Pending _pending[MAX_PENDING] { };
+
+	public:
+
+		unsigned long hits   { 0 };
+		unsigned long misses { 0 };
+
+		/* block number expected if the client reads sequentially */
+		block_number_t next_sequential { 0 };
+
+		Session_component(Env &env, Session_label const &label,
+		                  Attached_ram_dataspace &ds,
+		                  Signal_context_capability sigh, Info info)
+		:
+			Request_stream(env.rm(), ds.cap(), env.ep(), sigh, info),
+			label(label), _env(env)
+		{
+			_env.ep().manage(*this);
+		}
+
+		~Session_component() { _env.ep().dissolve(*this); }
+
+		Info info() const override { return Request_stream::info(); }
+
+		Capability<Tx> tx_cap() override { return Request_stream::tx_cap(); }
+
+		Pending *alloc_pending()
+		{
+			for (Pending &p : _pending)
+				if (!p.in_use) {
+					p = Pending { };
+					p.in_use = true;
+					return &p;
+				}
+
+			return nullptr;
+		}
+
+		template <typename FN>
+		void for_each_pending(FN const &fn)
+		{
+			for (Pending &p : _pending)
+				if (p.in_use)
+					fn(p);
+		}
+
+		/**
+		 * Acknowledge all completed requests
+		 *
+		 * \return  true if at least one request got acknowledged
+		 */
+		bool acknowledge_done()
+		{
+			bool progress = false;
+
+			try_acknowledge([&] (Ack &ack) {
+				for (Pending &p : _pending) {
+					if (!p.in_use || !p.done)
+						continue;
+
+					ack.submit(p.request);
+					p.in_use = false;
+					progress = true;
+					return;
+				}
+			});
+
+			return progress;
+		}
+};
+
+
+class Block_cache::Main : Rpc_object<Typed_root<Block::Session>>
+{
+	private:
+
+		Env &_env;
+
+		Attached_rom_dataspace _config { _env, "config" };
+
+		Heap _heap { _env.ram(), _env.rm() };
+
+		Number_of_bytes const _io_buffer_size =
+			_config.xml().attribute_value("io_buffer",
+			                              Number_of_bytes(4*1024*1024));
+
+		Allocator_avl          _block_alloc { &_heap };
+		Block_connection       _block       { _env, &_block_alloc, _io_buffer_size };
+		Block::Session::Info   _info        { _block.info() };
+
+		Signal_handler<Main>    _request_handler { _env.ep(), *this, &Main::_handle };
+		Io_signal_handler<Main> _io_handler      { _env.ep(), *this, &Main::_handle };
+
+		size_t _init_page_size()
+		{
+			size_t const page_size =
+				_config.xml().attribute_value("page_size", Number_of_bytes(4096));
+
+			if (page_size < _info.block_size || page_size % _info.block_size) {
+				warning("page size ", page_size, " is no multiple of the block "
+				        "size, use block size ", _info.block_size);
+				return _info.block_size;
+			}
+			return page_size;
+		}
+
+		size_t const _page_size { _init_page_size() };
+
+		/* number of blocks per page */
+		block_count_t const _page_blocks { _page_size / _info.block_size };
+
+		Cache _cache { _env.ram(), _env.rm(), _heap, _page_size,
+		               _config.xml().attribute_value("cache_size",
+		                                             Number_of_bytes(16*1024*1024)) };
+
+		/* number of pages loaded ahead of sequential reads */
+		unsigned const _readahead =
+			_config.xml().attribute_value("readahead", 32u);
+
+		/* start write-back if more dirty pages are present */
+		unsigned const _dirty_limit { _cache.num_pages() / 2 };
+
+		enum { MAX_JOBS = 64 };
+
+		Registry<Job> _jobs { };
+
+		unsigned _jobs_in_flight        { 0 };
+		unsigned _write_backs_in_flight { 0 };
+		bool     _sync_in_flight        { false };
+
+		enum { MAX_SESSIONS = 32 };
+
+		Session_component      *_sessions[MAX_SESSIONS] { };
+		Attached_ram_dataspace *_buffers[MAX_SESSIONS]  { };
+
+		template <typename FN>
+		void _for_each_session(FN const &fn)
+		{
+			for (Session_component *s : _sessions)
+				if (s) fn(*s);
+		}
+
+		/*
+		 * Statistics
+		 */
+
+		bool _statistics_enabled()
+		{
+			bool result = false;
+			_config.xml().with_sub_node("report", [&] (Xml_node const &report) {
+				result = report.attribute_value("statistics", false); });
+			return result;
+		}
+
+		Constructible<Expanding_reporter> _statistics { };
+
+		unsigned long _closed_hits   { 0 };
+		unsigned long _closed_misses { 0 };
+		unsigned long _written_back  { 0 };  /* pages */
+
+		void _report_statistics()
+		{
+			if (!_statistics.constructed())
+				return;
+
+			_statistics->generate([&] (Xml_generator &xml) {
+
+				unsigned long hits   = _closed_hits;
+				unsigned long misses = _closed_misses;
+
+				_for_each_session([&] (Session_component &s) {
+					xml.node("session", [&] () {
+						xml.attribute("label",  s.label);
+						xml.attribute("hits",   s.hits);
+						xml.attribute("misses", s.misses);
+					});
+					hits   += s.hits;
+					misses += s.misses;
+				});
+
+				xml.attribute("pages",  _cache.num_pages());
+				xml.attribute("dirty",  _cache.dirty_pages());
+				xml.attribute("hits",   hits);
+				xml.attribute("misses", misses);
+				xml.attribute("evicted",      _cache.evictions());
+				xml.attribute("written_back", _written_back);
+			});
+		}
+
+		/*
+		 * Periodic write-back
+		 */
+
+		Timer::Connection _timer { _env };
+
+		void _handle_timeout(Duration)
+		{
+			_flush();
+			_handle();
+			_report_statistics();
+		}
+
+		Timer::Periodic_timeout<Main> _flush_timeout {
+			_timer, *this, &Main::_handle_timeout,
+			Microseconds { 1000UL * max(_config.xml().attribute_value("flush_interval_ms",
+			                                                          1000UL), 10UL) } };
+
+		/**
+		 * Return number of blocks of the page 'number'
+		 *
+		 * Only the last page may be smaller than '_page_blocks' if the
+		 * device size is not a multiple of the page size.
+		 */
+		block_count_t _blocks_of_page(page_number_t number) const
+		{
+			block_number_t const start = number * _page_blocks;
+			return min(_page_blocks, _info.block_count - start);
+		}
+
+		bool _page_exists(page_number_t number) const
+		{
+			return number * _page_blocks < _info.block_count;
+		}
+
+		/**
+		 * Run of pages with consecutive numbers that is transferred by
+		 * one job
+		 */
+		struct Run
+		{
+			page_number_t first { 0 };
+			unsigned      count { 0 };
+			unsigned      pages[Job::MAX_PAGES] { };
+
+			bool extends(page_number_t number) const
+			{
+				return count && count < Job::MAX_PAGES && first + count == number;
+			}
+		};
+
+		void _submit(Job::Type type, Run &run)
+		{
+			if (!run.count)
+				return;
+
+			page_number_t const last = run.first + run.count - 1;
+
+			Operation const operation {
+				.type = (type == Job::Type::LOAD) ? Operation::Type::READ
+				                                  : Operation::Type::WRITE,
+				.block_number = run.first * _page_blocks,
+				.count        = (run.count - 1) * _page_blocks + _blocks_of_page(last) };
+
+			new (_heap) Job(_block, _jobs, type, operation, run.first,
+			                run.pages, run.count);
+
+			_jobs_in_flight++;
+			if (type == Job::Type::WRITE_BACK) {
+				_write_backs_in_flight++;
+				_written_back += run.count;
+			}
+
+			run.count = 0;
+		}
+
+		/**
+		 * Allocate page and add it to the run of pages to be loaded
+		 *
+		 * \return  false if no page could be allocated
+		 */
+		bool _load(Run &run, page_number_t number)
+		{
+			if (!run.extends(number))
+				_submit(Job::Type::LOAD, run);
+
+			if (!run.count && _jobs_in_flight >= MAX_JOBS)
+				return false;
+
+			unsigned const index = _cache.alloc(number);
+			if (index == Cache::INVALID)
+				return false;
+
+			if (!run.count)
+				run.first = number;
+
+			run.pages[run.count++] = index;
+			return true;
+		}
+
+		void _readahead_from(page_number_t number)
+		{
+			Run run { };
+
+			for (unsigned i = 0; i < _readahead && _page_exists(number + i); i++) {
+
+				if (_cache.lookup(number + i) != Cache::INVALID) {
+					_submit(Job::Type::LOAD, run);
+					continue;
+				}
+
+				/* prefetching never forces the write-back of dirty pages */
+				if (!_load(run, number + i))
+					break;
+			}
+			_submit(Job::Type::LOAD, run);
+		}
+
+		/**
+		 * Write back dirty pages
+		 *
+		 * Pages are clean as soon as their write-back is issued. A client
+		 * write that happens in the meantime marks the page dirty again.
+		 */
+		void _flush()
+		{
+			_cache.for_each_dirty([&] (unsigned index) {
+
+				if (_jobs_in_flight >= MAX_JOBS)
+					return;
+
+				Cache::Page const &page = _cache.page(index);
+				if (page.writing)
+					return;
+
+				/* start runs at their lowest page only */
+				if (page.number) {
+					unsigned const prev = _cache.lookup(page.number - 1);
+					if (prev != Cache::INVALID && _cache.page(prev).dirty
+					 && !_cache.page(prev).writing)
+						return;
+				}
+
+				Run run { };
+				run.first = page.number;
+
+				for (unsigned i = index; i != Cache::INVALID; ) {
+
+					Cache::Page &p = _cache.page(i);
+					if (!p.dirty || p.writing)
+						break;
+
+					_cache.mark_clean(i);
+					p.writing = true;
+					run.pages[run.count++] = i;
+
+					if (run.count == Job::MAX_PAGES)
+						break;
+
+					i = _cache.lookup(p.number + 1);
+				}
+				_submit(Job::Type::WRITE_BACK, run);
+			});
+		}
+
+		bool _sync_requested()
+		{
+			bool result = false;
+			_for_each_session([&] (Session_component &s) {
+				s.for_each_pending([&] (Pending const &p) {
+					result |= (p.request.operation.type == Operation::Type::SYNC); }); });
+			return result;
+		}
+
+		/**
+		 * Copy between the request payload and the page 'index'
+		 */
+		void _transfer(Session_component &s, Request const &request,
+		               page_number_t number, unsigned index)
+		{
+			block_number_t const start = request.operation.block_number;
+			block_number_t const end   = start + request.operation.count;
+			block_number_t const page  = number * _page_blocks;
+			block_number_t const from  = max(start, page);
+			block_number_t const to    = min(end, page + _page_blocks);
+
+			size_t const block_size = _info.block_size;
+
+			s.with_content(request, [&] (void *addr, size_t) {
+
+				char *payload = (char *)addr + (from - start) * block_size;
+				char *data    = _cache.data(index) + (from - page) * block_size;
+				size_t const length = (to - from) * block_size;
+
+				if (request.operation.type == Operation::Type::WRITE) {
+					memcpy(data, payload, length);
+					_cache.mark_dirty(index);
+				} else {
+					memcpy(payload, data, length);
+				}
+			});
+		}
+
+		/**
+		 * Advance read or write request
+		 *
+		 * The pages of the request are transferred in ascending order.
+		 * Missing pages are loaded in runs. Pages that are completely
+		 * overwritten are not loaded at all.
+		 *
+		 * \return  true if the request is completed
+		 */
+		bool _process_read_write(Session_component &s, Pending &p)
+		{
+			Request       &request = p.request;
+			Operation const op     = request.operation;
+			bool      const write  = (op.type == Operation::Type::WRITE);
+
+			if (p.failed) {
+				request.success = false;
+				return true;
+			}
+
+			block_number_t const start = op.block_number;
+			block_number_t const end   = start + op.count;
+			page_number_t  const first = start / _page_blocks;
+			page_number_t  const last  = (end - 1) / _page_blocks;
+
+			bool const first_visit = !p.visited;
+			if (first_visit) {
+				for (page_number_t n = first; n <= last; n++) {
+					unsigned const index = _cache.lookup(n);
+					if (index != Cache::INVALID && _cache.page(index).present())
+						s.hits++;
+					else
+						s.misses++;
+				}
+				p.visited = true;
+				p.next    = first;
+			}
+
+			Run  run     { };
+			bool waiting = false;
+
+			for (page_number_t n = p.next; n <= last; n++) {
+
+				unsigned index = _cache.lookup(n);
+
+				block_number_t const page = n * _page_blocks;
+				bool const complete = write && (start <= page)
+				                   && (end >= page + _blocks_of_page(n));
+
+				if (index == Cache::INVALID && complete) {
+
+					/* allocate page not before it gets overwritten */
+					if (waiting)
+						continue;
+
+					index = _cache.alloc(n);
+					if (index == Cache::INVALID) {
+						_flush();
+						break;
+					}
+					_cache.page(index).state = Cache::Page::State::VALID;
+				}
+
+				if (index == Cache::INVALID) {
+					waiting = true;
+					if (_load(run, n))
+						continue;
+
+					/* make pages evictable */
+					_flush();
+					break;
+				}
+
+				_submit(Job::Type::LOAD, run);
+
+				if (!_cache.page(index).present()) {
+					waiting = true;
+					continue;
+				}
+
+				_cache.touch(index);
+
+				if (waiting)
+					continue;
+
+				_transfer(s, request, n, index);
+				p.next = n + 1;
+			}
+			_submit(Job::Type::LOAD, run);
+
+			if (first_visit && !write && _readahead && s.next_sequential == start)
+				_readahead_from(last + 1);
+
+			if (first_visit && !write)
+				s.next_sequential = end;
+
+			if (p.next <= last)
+				return false;
+
+			request.success = true;
+			return true;
+		}
+
+		/**
+		 * Advance sync request
+		 *
+		 * The sync is passed to the backing device after all dirty pages
+		 * are written back. It is completed by '_finish'.
+		 */
+		bool _process_sync(Pending &p)
+		{
+			if (p.sync_issued)
+				return false;
+
+			if (_cache.dirty_pages()) {
+				_flush();
+				return false;
+			}
+
+			if (_write_backs_in_flight || _sync_in_flight || _jobs_in_flight >= MAX_JOBS)
+				return false;
+
+			Operation const operation { .type         = Operation::Type::SYNC,
+			                            .block_number = 0,
+			                            .count        = _info.block_count };
+
+			new (_heap) Job(_block, _jobs, Job::Type::SYNC, operation, 0, nullptr, 0);
+
+			_jobs_in_flight++;
+			_sync_in_flight = true;
+			p.sync_issued   = true;
+			return false;
+		}
+
+		bool _process(Session_component &s, Pending &p)
+		{
+			switch (p.request.operation.type) {
+			case Operation::Type::READ:
+			case Operation::Type::WRITE:
+				return _process_read_write(s, p);
+			case Operation::Type::SYNC:
+				return _process_sync(p);
+			case Operation::Type::TRIM:
+				p.request.success = true;
+				return true;
+			case Operation::Type::INVALID:
+				break;
+			}
+			p.request.success = false;
+			return true;
+		}
+
+		/**
+		 * Apply the results of completed jobs
+		 *
+		 * \return  true if at least one job got completed
+		 */
+		bool _finish()
+		{
+			bool progress = false;
+
+			_jobs.for_each([&] (Job &job) {
+
+				if (!job.done)
+					return;
+
+				switch (job.type) {
+
+				case Job::Type::LOAD:
+
+					for (unsigned i = 0; i < job.count; i++) {
+						if (job.success)
+							_cache.page(job.pages[i]).state = Cache::Page::State::VALID;
+						else
+							_cache.free(job.pages[i]);
+					}
+
+					if (job.success)
+						break;
+
+					error("loading blocks ", job.operation().block_number, "-",
+					      job.operation().block_number + job.operation().count - 1,
+					      " failed");
+
+					_fail_requests(job.first, job.count);
+					break;
+
+				case Job::Type::WRITE_BACK:
+
+					for (unsigned i = 0; i < job.count; i++) {
+						_cache.page(job.pages[i]).writing = false;
+						if (!job.success)
+							_cache.mark_dirty(job.pages[i]);
+					}
+
+					if (!job.success)
+						error("write-back of blocks ", job.operation().block_number,
+						      "-", job.operation().block_number + job.operation().count - 1,
+						      " failed");
+
+					_write_backs_in_flight--;
+					break;
+
+				case Job::Type::SYNC:
+
+					_for_each_session([&] (Session_component &s) {
+						s.for_each_pending([&] (Pending &p) {
+							if (!p.sync_issued || p.done)
+								return;
+
+							p.request.success = job.success;
+							p.done            = true;
+						});
+					});
+
+					_sync_in_flight = false;
+					break;
+				}
+
+				_jobs_in_flight--;
+				destroy(_heap, &job);
+				progress = true;
+			});
+
+			return progress;
+		}
+
+		/**
+		 * Fail all requests covering pages that could not be loaded
+		 */
+		void _fail_requests(page_number_t first, unsigned count)
+		{
+			_for_each_session([&] (Session_component &s) {
+				s.for_each_pending([&] (Pending &p) {
+
+					Operation const &op = p.request.operation;
+					if (!Operation::has_payload(op.type))
+						return;
+
+					page_number_t const from = op.block_number / _page_blocks;
+					page_number_t const to   = (op.block_number + op.count - 1) / _page_blocks;
+
+					if (from < first + count && to >= first)
+						p.failed = true;
+				});
+			});
+		}
+
+		/**
+		 * Advance pending requests and accept new requests of session 's'
+		 *
+		 * \return  true if progress was made
+		 */
+		bool _handle_requests(Session_component &s)
+		{
+			bool progress = false;
+
+			s.for_each_pending([&] (Pending &p) {
+				if (!p.done && _process(s, p)) {
+					p.done   = true;
+					progress = true;
+				}
+			});
+
+			s.with_requests([&] (Request request) {
+
+				Operation const &op = request.operation;
+
+				if (Operation::has_payload(op.type)) {
+
+					if (!op.count || op.block_number + op.count > _info.block_count)
+						return Response::REJECTED;
+
+					bool valid_payload = false;
+					s.with_content(request, [&] (void *, size_t) {
+						valid_payload = true; });
+
+					if (!valid_payload)
+						return Response::REJECTED;
+
+					if (op.type == Operation::Type::WRITE) {
+
+						if (!s.info().writeable)
+							return Response::REJECTED;
+
+						/* let pending syncs not starve by new writes */
+						if (_sync_requested())
+							return Response::RETRY;
+					}
+				}
+
+				Pending *p = s.alloc_pending();
+				if (!p)
+					return Response::RETRY;
+
+				p->request = request;
+				p->done    = _process(s, *p);
+				progress   = true;
+				return Response::ACCEPTED;
+			});
+
+			if (s.acknowledge_done())
+				progress = true;
+
+			return progress;
+		}
+
+		void _handle()
+		{
+			for (;;) {
+
+				bool progress = false;
+
+				if (_block.update_jobs(*this)) progress = true;
+				if (_finish())                 progress = true;
+
+				_for_each_session([&] (Session_component &s) {
+					if (_handle_requests(s))
+						progress = true; });
+
+				if (_cache.dirty_pages() > _dirty_limit)
+					_flush();
+
+				if (!progress)
+					break;
+			}
+
+			_for_each_session([&] (Session_component &s) {
+				s.wakeup_client_if_needed(); });
+		}
+
+		/*
+		 * Noncopyable
+		 */
+		Main(Main const &);
+		Main &operator = (Main const &);
+
+	public:
+
+		Main(Env &env) : _env(env)
+		{
+			_block.sigh(_io_handler);
+
+			if (_statistics_enabled()) {
+				_statistics.construct(_env, "statistics", "statistics");
+				_report_statistics();
+			}
+
+			log("cache of ", _cache.num_pages(), " pages of ", _page_size,
+			    " bytes for ", _info.block_count, " blocks of ",
+			    _info.block_size, " bytes");
+
+			_env.parent().announce(_env.ep().manage(*this));
+		}
+
+
+		/************************
+		 ** Update_jobs_policy **
+		 ************************/
+
+		template <typename FN>
+		void _with_pages(Job &job, off_t offset, size_t length, FN const &fn)
+		{
+			while (length) {
+				unsigned const i = (unsigned)(offset / _page_size);
+				size_t   const o = offset % _page_size;
+				size_t   const n = min(length, _page_size - o);
+
+				if (i >= job.count)
+					return;
+
+				fn(_cache.data(job.pages[i]) + o, n);
+
+				offset += n;
+				length -= n;
+			}
+		}
+
+		void consume_read_result(Job &job, off_t offset,
+		                         char const *src, size_t length)
+		{
+			_with_pages(job, offset, length, [&] (char *data, size_t n) {
+				memcpy(data, src, n);
+				src += n;
+			});
+		}
+
+		void produce_write_content(Job &job, off_t offset,
+		                           char *dst, size_t length)
+		{
+			_with_pages(job, offset, length, [&] (char const *data, size_t n) {
+				memcpy(dst, data, n);
+				dst += n;
+			});
+		}
+
+		void completed(Job &job, bool success)
+		{
+			job.success = success;
+			job.done    = true;
+		}
+
+
+		/********************
+		 ** Root interface **
+		 ********************/
+
+		Genode::Session_capability session(Root::Session_args const &args,
+		                            Affinity const &) override
+		{
+			Session_label const label = label_from_args(args.string());
+
+			bool writeable = false;
+			try {
+				Session_policy policy(label, _config.xml());
+				writeable = policy.attribute_value("writeable", false);
+			} catch (Session_policy::No_policy_defined) {
+				error("rejecting session request, no matching policy for '",
+				      label, "'");
+				throw Service_denied();
+			}
+
+			unsigned slot = 0;
+			for (; slot < MAX_SESSIONS && _sessions[slot]; slot++);
+
+			if (slot == MAX_SESSIONS) {
+				error("session limit reached for '", label, "'");
+				throw Service_denied();
+			}
+
+			size_t const tx_buf_size =
+				Arg_string::find_arg(args.string(), "tx_buf_size").ulong_value(0);
+
+			if (!tx_buf_size)
+				throw Service_denied();
+
+			Ram_quota const ram_quota = ram_quota_from_args(args.string());
+
+			size_t const session_size = max((size_t)4096,
+			                                sizeof(Session_component));
+			if (ram_quota.value < session_size
+			 || tx_buf_size > ram_quota.value - session_size) {
+				error("insufficient 'ram_quota', got ", ram_quota, ", need ",
+				      tx_buf_size + session_size);
+				throw Insufficient_ram_quota();
+			}
+
+			Block::Session::Info const info {
+				.block_size  = _info.block_size,
+				.block_count = _info.block_count,
+				.align_log2  = 0,
+				.writeable   = writeable && _info.writeable };
+
+			_buffers[slot] = new (_heap)
+				Attached_ram_dataspace(_env.ram(), _env.rm(), tx_buf_size);
+
+			_sessions[slot] = new (_heap)
+				Session_component(_env, label, *_buffers[slot],
+				                  _request_handler, info);
+
+			return _sessions[slot]->cap();
+		}
+
+		void upgrade(Genode::Session_capability, Root::Upgrade_args const &) override { }
+
+		void close(Genode::Session_capability cap) override
+		{
+			for (unsigned slot = 0; slot < MAX_SESSIONS; slot++) {
+
+				if (!_sessions[slot] || !(cap == _sessions[slot]->cap()))
+					continue;
+
+				_closed_hits   += _sessions[slot]->hits;
+				_closed_misses += _sessions[slot]->misses;
+
+				destroy(_heap, _sessions[slot]);
+				destroy(_heap, _buffers[slot]);
+				_sessions[slot] = nullptr;
+				_buffers[slot]  = nullptr;
+
+				_report_statistics();
+				return;
+			}
+		}
+};
+
+
+void Component::construct(Genode::Env &env)
+{
+	static Block_cache::Main main(env);
+}
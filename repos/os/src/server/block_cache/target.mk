@@ -0,0 +1,3 @@
+TARGET = block_cache
+LIBS   = base
+SRC_CC = main.cc
@@ -0,0 +1,312 @@
+/*
+ * \brief  Minimal io_uring interface of the Linux kernel
+ * \author Josef Soentgen
+ * \date   2022-07-11
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU General Public License version 2.
+ */
+
+#ifndef _IO_URING_H_
+#define _IO_URING_H_
+
+/* Genode includes */
+#include <base/log.h>
+#include <util/noncopyable.h>
+
+/* libc includes */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+#include <errno.h>
+#include <string.h> /* strerror */
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h> /* iovec */
+#include <linux/io_uring.h>
+#pragma GCC diagnostic pop  /* restore -Wconversion warnings */
+
+namespace Lx_block { class Io_uring; }
+
+
+/**
+ * Submission and completion ring shared with the kernel
+ *
+ * The rings are driven via the raw system calls to not depend on liburing.
+ * The object is used by one thread only, which submits requests and reaps
+ * their completions. Hence, only the indices that are shared with the
+ * kernel need to be accessed with acquire/release semantics.
+ */
+class Lx_block::Io_uring : Genode::Noncopyable
+{
+	public:
+
+		struct Setup_failed : Genode::Exception { };
+
+		enum class Opcode { READ, WRITE, FSYNC };
+
+		struct Io
+		{
+			Opcode           opcode;
+			void            *buffer;
+			unsigned         length;
+			Genode::uint64_t offset;
+			Genode::uint64_t user_data;
+		};
+
+		struct Completion
+		{
+			Genode::uint64_t user_data;
+			int              result;    /* bytes transferred or -errno */
+		};
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Io_uring(Io_uring const &);
+		Io_uring &operator = (Io_uring const &);
+
+		int      const  _file_fd;
+		int             _fd         { -1 };
+		io_uring_params _params     { };
+		void           *_sq_ring    { MAP_FAILED };
+		void           *_cq_ring    { MAP_FAILED };
+		size_t          _sq_size    { 0 };
+		size_t          _cq_size    { 0 };
+		io_uring_sqe   *_sqes       { (io_uring_sqe *)MAP_FAILED };
+		unsigned        _pending    { 0 };    /* queued but not yet entered */
+		bool            _fixed_buf  { false };
+
+		template <typename T>
+		T *_sq(unsigned offset) { return (T *)((char *)_sq_ring + offset); }
+
+		template <typename T>
+		T *_cq(unsigned offset) { return (T *)((char *)_cq_ring + offset); }
+
+		unsigned *_sq_head()  { return _sq<unsigned>(_params.sq_off.head); }
+		unsigned *_sq_tail()  { return _sq<unsigned>(_params.sq_off.tail); }
+		unsigned *_sq_array() { return _sq<unsigned>(_params.sq_off.array); }
+		unsigned  _sq_mask()  { return *_sq<unsigned>(_params.sq_off.ring_mask); }
+		unsigned *_cq_head()  { return _cq<unsigned>(_params.cq_off.head); }
+		unsigned *_cq_tail()  { return _cq<unsigned>(_params.cq_off.tail); }
+		unsigned  _cq_mask()  { return *_cq<unsigned>(_params.cq_off.ring_mask); }
+
+		io_uring_cqe *_cqes() { return _cq<io_uring_cqe>(_params.cq_off.cqes); }
+
+		int _register(unsigned opcode, void *arg, unsigned nr_args)
+		{
+			return (int)syscall(__NR_io_uring_register, _fd, opcode, arg, nr_args);
+		}
+
+		void _release()
+		{
+			if (_sqes != MAP_FAILED)
+				munmap(_sqes, _params.sq_entries * sizeof(io_uring_sqe));
+
+			if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring)
+				munmap(_cq_ring, _cq_size);
+
+			if (_sq_ring != MAP_FAILED)
+				munmap(_sq_ring, _sq_size);
+
+			if (_fd != -1)
+				close(_fd);
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param file_fd  file descriptor targeted by all operations
+		 * \param entries  minimal number of submission-queue entries
+		 *
+		 * \throw Setup_failed
+		 */
+		Io_uring(int file_fd, unsigned entries) : _file_fd(file_fd)
+		{
+			_fd = (int)syscall(__NR_io_uring_setup, entries, &_params);
+			if (_fd < 0) {
+				Genode::error("io_uring_setup failed: ", Genode::Cstring(strerror(errno)));
+				throw Setup_failed();
+			}
+
+			_sq_size = _params.sq_off.array + _params.sq_entries * sizeof(unsigned);
+			_cq_size = _params.cq_off.cqes  + _params.cq_entries * sizeof(io_uring_cqe);
+
+			bool const single_mmap = _params.features & IORING_FEAT_SINGLE_MMAP;
+			if (single_mmap)
+				_sq_size = _cq_size = Genode::max(_sq_size, _cq_size);
+
+			_sq_ring = mmap(nullptr, _sq_size, PROT_READ | PROT_WRITE,
+			                MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+
+			_cq_ring = single_mmap
+			         ? _sq_ring
+			         : mmap(nullptr, _cq_size, PROT_READ | PROT_WRITE,
+			                MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+
+			_sqes = (io_uring_sqe *)
+				mmap(nullptr, _params.sq_entries * sizeof(io_uring_sqe),
+				     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+				     IORING_OFF_SQES);
+
+			if (_sq_ring == MAP_FAILED || _cq_ring == MAP_FAILED || _sqes == MAP_FAILED) {
+				Genode::error("failed to map io_uring rings");
+				_release();
+				throw Setup_failed();
+			}
+		}
+
+		~Io_uring() { _release(); }
+
+		unsigned entries() const { return _params.sq_entries; }
+
+		/**
+		 * Let the kernel signal each completion at the eventfd 'efd'
+		 */
+		bool register_eventfd(int efd)
+		{
+			return _register(IORING_REGISTER_EVENTFD, &efd, 1) == 0;
+		}
+
+		/**
+		 * Register the memory range as fixed buffer
+		 *
+		 * The kernel pins the pages once instead of for each request. All
+		 * subsequent reads and writes must target this range.
+		 */
+		bool register_buffer(void *base, size_t size)
+		{
+			iovec iov { .iov_base = base, .iov_len = size };
+			_fixed_buf = (_register(IORING_REGISTER_BUFFERS, &iov, 1) == 0);
+			return _fixed_buf;
+		}
+
+		void unregister_buffer()
+		{
+			if (_fixed_buf)
+				_register(IORING_UNREGISTER_BUFFERS, nullptr, 0);
+
+			_fixed_buf = false;
+		}
+
+		/**
+		 * Queue I/O operation
+		 *
+		 * The operation is passed to the kernel by the next call of 'enter'.
+		 *
+		 * \return  false if the submission queue is full
+		 */
+		bool queue(Io const &io)
+		{
+			unsigned const head = __atomic_load_n(_sq_head(), __ATOMIC_ACQUIRE);
+			unsigned const tail = *_sq_tail();
+			if (tail - head >= _params.sq_entries)
+				return false;
+
+			unsigned const idx = tail & _sq_mask();
+			io_uring_sqe  &sqe = _sqes[idx];
+			memset(&sqe, 0, sizeof(sqe));
+
+			switch (io.opcode) {
+			case Opcode::READ:
+				sqe.opcode = _fixed_buf ? IORING_OP_READ_FIXED  : IORING_OP_READ;
+				break;
+			case Opcode::WRITE:
+				sqe.opcode = _fixed_buf ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+				break;
+			case Opcode::FSYNC:
+				sqe.opcode = IORING_OP_FSYNC;
+				break;
+			}
+
+			sqe.fd        = _file_fd;
+			sqe.off       = io.offset;
+			sqe.user_data = io.user_data;
+
+			if (io.opcode != Opcode::FSYNC) {
+				sqe.addr = (Genode::uint64_t)io.buffer;
+				sqe.len  = io.length;
+			}
+
+			_sq_array()[idx] = idx;
+			__atomic_store_n(_sq_tail(), tail + 1, __ATOMIC_RELEASE);
+			_pending++;
+			return true;
+		}
+
+		enum class Enter_result { OK, BUSY, FAILED };
+
+		/**
+		 * Pass all queued operations to the kernel with one system call
+		 *
+		 * \return  BUSY if the kernel cannot take further operations before
+		 *          completions are reaped, i.e., the completion queue is full
+		 *          (EBUSY) or the kernel lacks resources temporarily
+		 *          (EAGAIN). The remaining operations stay queued and the
+		 *          caller is expected to reap completions before calling
+		 *          'enter' again.
+		 */
+		Enter_result enter()
+		{
+			while (_pending) {
+				int const ret = (int)syscall(__NR_io_uring_enter, _fd, _pending,
+				                             0, 0, nullptr, 0);
+				if (ret < 0) {
+					if (errno == EINTR)
+						continue;
+
+					if (errno == EAGAIN || errno == EBUSY)
+						return Enter_result::BUSY;
+
+					Genode::error("io_uring_enter failed: ", Genode::Cstring(strerror(errno)));
+					return Enter_result::FAILED;
+				}
+				if (!ret)
+					return Enter_result::BUSY;
+
+				_pending -= Genode::min((unsigned)ret, _pending);
+			}
+			return Enter_result::OK;
+		}
+
+		/**
+		 * Number of operations queued but not yet passed to the kernel
+		 */
+		unsigned pending() const { return _pending; }
+
+		/**
+		 * Block until at least 'count' operations are completed
+		 */
+		void wait(unsigned count)
+		{
+			while ((int)syscall(__NR_io_uring_enter, _fd, 0, count,
+			                    IORING_ENTER_GETEVENTS, nullptr, 0) < 0
+			       && errno == EINTR);
+		}
+
+		/**
+		 * Call 'fn' for each completion that is available
+		 */
+		template <typename FN>
+		void for_each_completion(FN const &fn)
+		{
+			unsigned       head = *_cq_head();
+			unsigned const tail = __atomic_load_n(_cq_tail(), __ATOMIC_ACQUIRE);
+
+			for (; head != tail; head++) {
+				io_uring_cqe const &cqe = _cqes()[head & _cq_mask()];
+				fn(Completion { .user_data = cqe.user_data, .result = cqe.res });
+			}
+			__atomic_store_n(_cq_head(), head, __ATOMIC_RELEASE);
+		}
+};
+
+#endif /* _IO_URING_H_ */
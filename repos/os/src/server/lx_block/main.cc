@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (C) 2017 Genode Labs GmbH
+ * Copyright (C) 2017-2022 Genode Labs GmbH
  *
  * This file is part of the Genode OS framework, which is distributed
  * under the terms of the GNU General Public License version 2.
@@ -16,8 +16,9 @@
 #include <base/component.h>
 #include <base/heap.h>
 #include <base/log.h>
-#include <block/component.h>
-#include <block/driver.h>
+#include <base/thread.h>
+#include <block/request_stream.h>
+#include <root/root.h>
 #include <util/string.h>
 
 /* libc includes */
@@ -25,178 +26,624 @@
 #pragma GCC diagnostic ignored "-Wconversion"
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <stdio.h> /* perror */
 #pragma GCC diagnostic pop  /* restore -Wconversion warnings */
 
-static bool xml_attr_ok(Genode::Xml_node node, char const *attr)
-{
-	return node.attribute_value(attr, false);
+/* local includes */
+#include <io_uring.h>
+
+namespace Lx_block {
+
+	using namespace Genode;
+
+	class Completion_notifier;
+	class Driver;
+	struct Block_session_component;
+	struct Main;
 }
 
 
-class Lx_block_driver : public Block::Driver
+/**
+ * Thread that turns io_uring completions into signals
+ *
+ * The kernel increments the eventfd for each completion. The entrypoint
+ * reaps all completions available when handling the signal.
+ */
+class Lx_block::Completion_notifier : public Thread
 {
 	private:
 
-		Genode::Env &_env;
+		enum { STACK_SIZE = 4 * 1024 * sizeof(long) };
+
+		int                       const _eventfd;
+		Signal_context_capability const _sigh;
 
-		Block::Session::Info const _info;
+	public:
 
-		typedef Genode::String<256> File_name;
+		Completion_notifier(Env &env, int eventfd, Signal_context_capability sigh)
+		:
+			Thread(env, "completion", STACK_SIZE),
+			_eventfd(eventfd), _sigh(sigh)
+		{ }
 
-		static File_name _file_name(Genode::Xml_node const &config)
+		void entry() override
 		{
-			return config.attribute_value("file", File_name());
+			for (;;) {
+				Genode::uint64_t value = 0;
+				ssize_t const n = read(_eventfd, &value, sizeof(value));
+				if (n != sizeof(value)) {
+					if (n == -1 && errno == EINTR)
+						continue;
+
+					perror("read eventfd");
+					return;
+				}
+				Signal_transmitter(_sigh).submit();
+			}
 		}
+};
 
-		static Block::Session::Info _init_info(Genode::Xml_node const &config)
-		{
-			Genode::Number_of_bytes const default_block_size(512);
 
+/**
+ * Backend that keeps up to 'queue_depth' requests in flight via io_uring
+ */
+class Lx_block::Driver : Noncopyable
+{
+	public:
+
+		struct Could_not_open_file : Exception { };
+
+		using Response = Block::Request_stream::Response;
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Driver(Driver const &);
+		Driver &operator = (Driver const &);
+
+		struct Job
+		{
+			enum class State { FREE, IN_FLIGHT, COMPLETE };
+
+			State          state   { State::FREE };
+			Block::Request request { };
+			char          *buffer  { nullptr };
+			size_t         size    { 0 };
+			size_t         done    { 0 };
+		};
+
+		typedef String<256> File_name;
+
+		enum { DEFAULT_QUEUE_DEPTH = 64, MAX_QUEUE_DEPTH = 4096 };
+
+		Allocator                  &_alloc;
+		File_name            const  _file_name;
+		bool                 const  _direct_io;
+		bool                 const  _registered_buffer;
+		unsigned             const  _queue_depth;
+		Block::Session::Info const  _info;
+		int                  const  _fd;
+		Lx_block::Io_uring          _ring;
+		int                  const  _eventfd;
+		Completion_notifier         _notifier;
+		Job                 *const  _jobs;
+		unsigned            *const  _free_ids;
+		unsigned            *const  _completed_ids;
+		unsigned                    _free_cnt      { _queue_depth };
+		unsigned                    _completed_cnt { 0 };
+		unsigned                    _in_flight     { 0 };
+		bool                        _syncing       { false };
+
+		static File_name _init_file_name(Xml_node const &config)
+		{
 			if (!config.has_attribute("file")) {
-				Genode::error("mandatory file attribute missing");
+				error("mandatory file attribute missing");
 				throw Could_not_open_file();
 			}
+			return config.attribute_value("file", File_name());
+		}
+
+		static unsigned _init_queue_depth(Xml_node const &config)
+		{
+			unsigned const depth =
+				config.attribute_value("queue_depth", (unsigned)DEFAULT_QUEUE_DEPTH);
+
+			return min(max(depth, 1U), (unsigned)MAX_QUEUE_DEPTH);
+		}
+
+		Block::Session::Info _init_info(Xml_node const &config) const
+		{
+			Number_of_bytes const default_block_size(512);
 
 			struct stat st;
-			if (stat(_file_name(config).string(), &st)) {
+			if (stat(_file_name.string(), &st)) {
 				perror("stat");
 				throw Could_not_open_file();
 			}
 
 			if (!config.has_attribute("block_size"))
-				Genode::warning("block size missing, assuming ", default_block_size);
+				warning("block size missing, assuming ", default_block_size);
 
-			Genode::size_t const block_size =
+			size_t const block_size =
 				config.attribute_value("block_size", default_block_size);
 
 			return {
 				.block_size  = block_size,
 				.block_count = st.st_size / block_size,
-				.align_log2  = Genode::log2(block_size),
-				.writeable   = xml_attr_ok(config, "writeable")
+				.align_log2  = log2(block_size),
+				.writeable   = config.attribute_value("writeable", false)
 			};
 		}
 
-		int _fd { -1 };
+		int _init_fd() const
+		{
+			int const flags = (_info.writeable ? O_RDWR : O_RDONLY)
+			                | (_direct_io ? O_DIRECT : 0);
 
-	public:
+			int const fd = open(_file_name.string(), flags);
+			if (fd == -1) {
+				error("open ", _file_name);
+				throw Could_not_open_file();
+			}
+			return fd;
+		}
 
-		struct Could_not_open_file : Genode::Exception { };
+		int _init_eventfd()
+		{
+			int const efd = eventfd(0, EFD_CLOEXEC);
+			if (efd == -1 || !_ring.register_eventfd(efd)) {
+				error("failed to set up completion eventfd");
+				throw Io_uring::Setup_failed();
+			}
+			return efd;
+		}
 
-		Lx_block_driver(Genode::Env &env, Genode::Xml_node config)
-		:
-			Block::Driver(env.ram()),
-			_env(env),
-			_info(_init_info(config))
-		{
-			/* open file */
-			File_name const file_name = _file_name(config);
-			_fd = open(file_name.string(), _info.writeable ? O_RDWR : O_RDONLY);
-			if (_fd == -1) {
-				Genode::error("open ", file_name.string());
-				throw Could_not_open_file();
+		/**
+		 * Return true if the request overlaps with a write in flight or
+		 * is a write overlapping with any request in flight
+		 *
+		 * Requests in flight are executed by the kernel in any order. So,
+		 * a request must not be passed to the kernel before conflicting
+		 * requests submitted earlier are completed.
+		 */
+		bool _overlap_check(Block::Operation const &op) const
+		{
+			using Type = Block::Operation::Type;
+
+			bool const write = (op.type == Type::WRITE);
+
+			for (unsigned i = 0; i < _queue_depth; i++) {
+
+				Block::Operation const &pending = _jobs[i].request.operation;
+
+				if (_jobs[i].state != Job::State::IN_FLIGHT
+				 || !Block::Operation::has_payload(pending.type))
+					continue;
+
+				if (!write && pending.type != Type::WRITE)
+					continue;
+
+				if (op.block_number < pending.block_number + pending.count
+				 && pending.block_number < op.block_number + op.count)
+					return true;
 			}
+			return false;
+		}
+
+		void _complete(unsigned id, bool success)
+		{
+			Job &job = _jobs[id];
+
+			if (job.request.operation.type == Block::Operation::Type::SYNC)
+				_syncing = false;
 
-			Genode::log("Provide '", file_name, "' as block device "
-			            "block_size:  ", _info.block_size, " "
-			            "block_count: ", _info.block_count, " "
-			            "writeable:   ", _info.writeable ? "yes" : "no");
+			job.request.success = success;
+			job.state           = Job::State::COMPLETE;
+			_completed_ids[_completed_cnt++] = id;
 		}
 
-		~Lx_block_driver() { close(_fd); }
+		void _queue(unsigned id)
+		{
+			Job &job = _jobs[id];
+
+			using Opcode = Io_uring::Opcode;
+			using Type   = Block::Operation::Type;
+
+			Opcode opcode = Opcode::FSYNC;
+			switch (job.request.operation.type) {
+			case Type::READ:  opcode = Opcode::READ;  break;
+			case Type::WRITE: opcode = Opcode::WRITE; break;
+			case Type::SYNC:  opcode = Opcode::FSYNC; break;
+
+			/* completed by 'submit' right away */
+			case Type::TRIM:
+			case Type::INVALID:
+				_complete(id, false);
+				return;
+			}
+
+			Genode::uint64_t const offset = job.request.operation.block_number
+			                      * _info.block_size + job.done;
+
+			Io_uring::Io const io {
+				.opcode    = opcode,
+				.buffer    = job.buffer + job.done,
+				.length    = (unsigned)(job.size - job.done),
+				.offset    = offset,
+				.user_data = id };
+
+			/* the ring has at least as many entries as jobs exist */
+			if (!_ring.queue(io)) {
+				error("io_uring submission queue exhausted");
+				_complete(id, false);
+				return;
+			}
+			job.state = Job::State::IN_FLIGHT;
+			_in_flight++;
+		}
 
+		bool _reap()
+		{
+			bool progress = false;
+			_ring.for_each_completion([&] (Io_uring::Completion const &c) {
+
+				unsigned const id = (unsigned)c.user_data;
+				if (id >= _queue_depth || _jobs[id].state != Job::State::IN_FLIGHT)
+					return;
+
+				Job &job = _jobs[id];
+				_in_flight--;
+				progress = true;
+
+				if (c.result < 0) {
+					error(job.request.operation, " failed: ",
+					      Cstring(strerror(-c.result)));
+					_complete(id, false);
+					return;
+				}
+				job.done += (size_t)c.result;
+
+				/* continue a short read or write with the remainder */
+				if (job.done < job.size && c.result > 0) {
+					_queue(id);
+					return;
+				}
+				_complete(id, job.done == job.size);
+			});
+			return progress;
+		}
 
-		/*****************************
-		 ** Block::Driver interface **
-		 *****************************/
+	public:
 
-		Dma_buffer alloc_dma_buffer(Genode::size_t size, Genode::Cache) override
+		Driver(Env &env, Allocator &alloc, Xml_node const &config,
+		       Signal_context_capability sigh)
+		:
+			_alloc(alloc),
+			_file_name(_init_file_name(config)),
+			_direct_io(config.attribute_value("direct_io", false)),
+			_registered_buffer(config.attribute_value("registered_buffer", false)),
+			_queue_depth(_init_queue_depth(config)),
+			_info(_init_info(config)),
+			_fd(_init_fd()),
+			_ring(_fd, _queue_depth),
+			_eventfd(_init_eventfd()),
+			_notifier(env, _eventfd, sigh),
+			_jobs(new (_alloc) Job[_queue_depth]),
+			_free_ids(new (_alloc) unsigned[_queue_depth]),
+			_completed_ids(new (_alloc) unsigned[_queue_depth])
 		{
-			return { .ds = _env.ram().alloc(size), .dma_addr = 0 };
+			for (unsigned i = 0; i < _queue_depth; i++)
+				_free_ids[i] = _queue_depth - 1 - i;
+
+			_notifier.start();
+
+			log("Provide '", _file_name, "' as block device "
+			    "block_size: ",  _info.block_size, " "
+			    "block_count: ", _info.block_count, " "
+			    "writeable: ",   _info.writeable ? "yes" : "no", " "
+			    "queue_depth: ", _queue_depth, " "
+			    "direct_io: ",   _direct_io ? "yes" : "no");
 		}
 
-		Block::Session::Info info() const override { return _info; }
+		Block::Session::Info info() const { return _info; }
 
-		void read(Block::sector_t           block_number,
-		          Genode::size_t            block_count,
-		          char                     *buffer,
-		          Block::Packet_descriptor &packet) override
+		Response acceptable(Block::Request const &request) const
 		{
-			Block::sector_t const offset = block_number * _info.block_size;
-			size_t          const count  = block_count  * _info.block_size;
+			Block::Operation const &op = request.operation;
+
+			if (!op.valid())
+				return Response::REJECTED;
 
-			ssize_t const n = pread(_fd, buffer, count, (off_t)offset);
-			if (n == -1) {
-				perror("pread");
-				throw Io_error();
+			if (!_info.writeable && (op.type == Block::Operation::Type::WRITE ||
+			                         op.type == Block::Operation::Type::TRIM))
+				return Response::REJECTED;
+
+			if (Block::Operation::has_payload(op.type)) {
+				if (op.count == 0 || op.block_number >= _info.block_count
+				 || op.count > _info.block_count - op.block_number)
+					return Response::REJECTED;
 			}
 
-			ack_packet(packet);
+			/*
+			 * A sync covers all writes acknowledged before. Hence, it is
+			 * passed to the kernel not before all requests in flight are
+			 * completed, and new requests wait for the sync to complete.
+			 */
+			bool const sync = (op.type == Block::Operation::Type::SYNC);
+			if ((sync && _in_flight) || _syncing)
+				return Response::RETRY;
+
+			if (Block::Operation::has_payload(op.type) && _overlap_check(op))
+				return Response::RETRY;
+
+			return _free_cnt ? Response::ACCEPTED : Response::RETRY;
+		}
+
+		/**
+		 * Start the operation of an acceptable request
+		 *
+		 * \param buffer  payload of the request, or nullptr if the request
+		 *                does not carry payload
+		 */
+		void submit(Block::Request const &request, void *buffer, size_t size)
+		{
+			unsigned const id = _free_ids[--_free_cnt];
+
+			Job &job = _jobs[id];
+			job.request = request;
+			job.buffer  = (char *)buffer;
+			job.size    = size;
+			job.done    = 0;
+
+			switch (request.operation.type) {
+
+			/* trimming is not passed to the file, acknowledge right away */
+			case Block::Operation::Type::TRIM:
+				_complete(id, true);
+				return;
+
+			case Block::Operation::Type::SYNC:
+				_syncing = true;
+				break;
+
+			case Block::Operation::Type::READ:
+			case Block::Operation::Type::WRITE:
+			case Block::Operation::Type::INVALID:
+				break;
+			}
+			_queue(id);
 		}
 
-		void write(Block::sector_t           block_number,
-		           Genode::size_t            block_count,
-		           char const               *buffer,
-		           Block::Packet_descriptor &packet) override
+		/**
+		 * Pass queued operations to the kernel and collect completions
+		 *
+		 * \return  true if at least one operation got completed
+		 */
+		bool execute()
 		{
-			/* range check is done by Block::Driver */
-			if (!_info.writeable) {
-				throw Io_error();
+			using Enter_result = Io_uring::Enter_result;
+
+			bool progress = false;
+			for (;;) {
+				Enter_result const result = _ring.enter();
+				if (result == Enter_result::FAILED)
+					return progress;
+
+				bool const reaped = _reap();
+				progress |= reaped;
+
+				/* pass continuations of short reads or writes */
+				if (result == Enter_result::OK && !_ring.pending())
+					return progress;
+
+				/*
+				 * If the kernel is busy and no completion could be reaped,
+				 * the remaining operations are entered once the next
+				 * completion is signalled. Without operations in flight at
+				 * the kernel, no such signal will come, so retry.
+				 */
+				if (result == Enter_result::BUSY && !reaped
+				 && _in_flight > _ring.pending())
+					return progress;
 			}
+		}
+
+		template <typename FN>
+		void with_any_completed_job(FN const &fn)
+		{
+			if (!_completed_cnt)
+				return;
+
+			unsigned const id = _completed_ids[--_completed_cnt];
+			Job &job = _jobs[id];
+			fn(job.request);
 
-			Block::sector_t  const offset = block_number * _info.block_size;
-			size_t           const count  = block_count  * _info.block_size;
+			job.state = Job::State::FREE;
+			_free_ids[_free_cnt++] = id;
+		}
+
+		/**
+		 * Wait for all operations in flight and drop all jobs
+		 *
+		 * Used before the buffer of a closed session is released.
+		 */
+		void drain()
+		{
+			while (_in_flight) {
+				_ring.enter();
+
+				/* wait only for operations the kernel has taken already */
+				unsigned const entered = _in_flight - _ring.pending();
+				if (entered)
+					_ring.wait(entered);
 
-			ssize_t const n = pwrite(_fd, buffer, count, (off_t)offset);
-			if (n == -1) {
-				perror("pwrite");
-				throw Io_error();
+				_reap();
 			}
+			while (_completed_cnt)
+				with_any_completed_job([] (Block::Request const &) { });
+		}
+
+		/**
+		 * Register the communication buffer of a session at the kernel
+		 */
+		void buffer(addr_t base, size_t size)
+		{
+			if (!_registered_buffer)
+				return;
 
-			ack_packet(packet);
+			if (!_ring.register_buffer((void *)base, size))
+				warning("failed to register I/O buffer, "
+				        "check RLIMIT_MEMLOCK");
 		}
 
-		void sync() override { }
+		void release_buffer() { _ring.unregister_buffer(); }
+};
+
+
+struct Lx_block::Block_session_component : Rpc_object<Block::Session>,
+                                           Block::Request_stream
+{
+	Env &_env;
+
+	Block_session_component(Env &env, Dataspace_capability ds,
+	                        Signal_context_capability sigh,
+	                        Block::Session::Info info)
+	:
+		Request_stream(env.rm(), ds, env.ep(), sigh, info), _env(env)
+	{
+		_env.ep().manage(*this);
+	}
+
+	~Block_session_component() { _env.ep().dissolve(*this); }
+
+	Info info() const override { return Request_stream::info(); }
+
+	Capability<Tx> tx_cap() override { return Request_stream::tx_cap(); }
 };
 
 
-struct Main
+struct Lx_block::Main : Rpc_object<Typed_root<Block::Session>>
 {
-	Genode::Env  &_env;
-	Genode::Heap  _heap { _env.ram(), _env.rm() };
+	Env  &_env;
+	Heap  _heap { _env.ram(), _env.rm() };
+
+	Attached_rom_dataspace _config_rom { _env, "config" };
+
+	Signal_handler<Main> _request_handler { _env.ep(), *this, &Main::_handle_requests };
+
+	Driver _driver { _env, _heap, _config_rom.xml(), _request_handler };
 
-	Genode::Attached_rom_dataspace _config_rom { _env, "config" };
+	Ram_dataspace_capability               _block_ds_cap  { };
+	Constructible<Block_session_component> _block_session { };
 
-	struct Factory : Block::Driver_factory
+	void _handle_requests()
 	{
-		Genode::Constructible<Lx_block_driver> _driver { };
+		if (!_block_session.constructed())
+			return;
 
-		Factory(Genode::Env &env, Genode::Xml_node config)
-		{
-			_driver.construct(env, config);
+		Block_session_component &block_session = *_block_session;
+
+		for (;;) {
+
+			bool progress = false;
+
+			/* import new requests */
+			block_session.with_requests([&] (Block::Request request) {
+
+				Driver::Response response = _driver.acceptable(request);
+				if (response != Driver::Response::ACCEPTED)
+					return response;
+
+				if (!Block::Operation::has_payload(request.operation.type)) {
+					_driver.submit(request, nullptr, 0);
+					progress = true;
+					return response;
+				}
+
+				response = Driver::Response::REJECTED;
+				block_session.with_content(request, [&] (void *ptr, size_t size) {
+					_driver.submit(request, ptr, size);
+					response = Driver::Response::ACCEPTED;
+				});
+				progress = true;
+				return response;
+			});
+
+			/* pass requests to the kernel and reap completions */
+			progress |= _driver.execute();
+
+			/* acknowledge finished jobs */
+			block_session.try_acknowledge([&] (Block_session_component::Ack &ack) {
+
+				_driver.with_any_completed_job([&] (Block::Request request) {
+
+					ack.submit(request);
+					progress = true;
+				});
+			});
+
+			if (!progress) { break; }
 		}
 
-		~Factory() { _driver.destruct(); }
+		block_session.wakeup_client_if_needed();
+	}
+
+
+	/********************
+	 ** Root interface **
+	 ********************/
+
+	Capability<Session> session(Root::Session_args const &args,
+	                            Affinity const &) override
+	{
+		if (_block_session.constructed()) {
+			error("only one block session is supported");
+			throw Service_denied();
+		}
+
+		size_t const tx_buf_size =
+			Arg_string::find_arg(args.string(), "tx_buf_size").ulong_value(0);
+
+		Ram_quota const ram_quota = ram_quota_from_args(args.string());
 
-		/***********************
-		 ** Factory interface **
-		 ***********************/
+		if (tx_buf_size > ram_quota.value) {
+			error("insufficient 'ram_quota', got ", ram_quota,
+			      ", need ", tx_buf_size);
+			throw Insufficient_ram_quota();
+		}
+
+		_block_ds_cap = _env.ram().alloc(tx_buf_size);
+		_block_session.construct(_env, _block_ds_cap, _request_handler,
+		                         _driver.info());
+
+		_block_session->with_buffer([&] (addr_t base, size_t size) {
+			_driver.buffer(base, size); });
+
+		return _block_session->cap();
+	}
+
+	void upgrade(Capability<Session>, Root::Upgrade_args const &) override { }
 
-		Block::Driver *create() override { return &*_driver; }
-		void destroy(Block::Driver *) override { }
-	} factory { _env, _config_rom.xml() };
+	void close(Capability<Session>) override
+	{
+		/* the kernel must not access the buffer after its release */
+		_driver.drain();
+		_driver.release_buffer();
 
-	Block::Root root { _env.ep(), _heap, _env.rm(), factory,
-	                   xml_attr_ok(_config_rom.xml(), "writeable") };
+		_block_session.destruct();
+		_env.ram().free(_block_ds_cap);
+	}
 
-	Main(Genode::Env &env) : _env(env)
+	Main(Env &env) : _env(env)
 	{
-		_env.parent().announce(_env.ep().manage(root));
+		_env.parent().announce(_env.ep().manage(*this));
 	}
 };
 
 
-void Component::construct(Genode::Env &env) { static Main main(env); }
+void Component::construct(Genode::Env &env) { static Lx_block::Main main(env); }
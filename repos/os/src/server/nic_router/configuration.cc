@@ -32,10 +32,13 @@ Configuration::Configuration(Xml_node const  node,
 :
 	_alloc                          { alloc },
 	_max_packets_per_signal         { 0 },
+	_poll_spins                     { 0 },
+	_transmit_threads               { 0 },
 	_verbose                        { false },
 	_verbose_packets                { false },
 	_verbose_packet_drop            { false },
 	_verbose_domain_state           { false },
+	_verify_checksums               { false },
 	_icmp_echo_server               { false },
 	_icmp_type_3_code_on_fragm_ipv4 { 0 },
 	_dhcp_discover_timeout          { 0 },
@@ -102,20 +105,26 @@ Configuration::_init_icmp_type_3_code_on_fragm_ipv4(Xml_node const &node) const
 }
 
 
-Configuration::Configuration(Env               &env,
-                             Xml_node    const  node,
-                             Allocator         &alloc,
-                             Timer::Connection &timer,
-                             Configuration     &old_config,
-                             Quota       const &shared_quota,
-                             Interface_list    &interfaces)
+Configuration::Configuration(Env                     &env,
+                             Xml_node          const  node,
+                             Allocator               &alloc,
+                             Timer::Connection       &timer,
+                             Configuration           &old_config,
+                             Quota             const &shared_quota,
+                             Interface_list          &interfaces,
+                             Wakeup_batch            &wakeup_batch,
+                             Domain_transmitter_pool &transmitters)
 :
 	_alloc                          { alloc },
 	_max_packets_per_signal         { node.attribute_value("max_packets_per_signal",    (unsigned long)32) },
+	_poll_spins                     { node.attribute_value("poll_spins",                0U) },
+	_transmit_threads               { min(node.attribute_value("transmit_threads",      0U),
+	                                      Domain_transmitter_pool::max_transmitters()) },
 	_verbose                        { node.attribute_value("verbose",                   false) },
 	_verbose_packets                { node.attribute_value("verbose_packets",           false) },
 	_verbose_packet_drop            { node.attribute_value("verbose_packet_drop",       false) },
 	_verbose_domain_state           { node.attribute_value("verbose_domain_state",      false) },
+	_verify_checksums               { node.attribute_value("verify_checksums",          false) },
 	_icmp_echo_server               { node.attribute_value("icmp_echo_server",          true) },
 	_icmp_type_3_code_on_fragm_ipv4 { _init_icmp_type_3_code_on_fragm_ipv4(node) },
 	_dhcp_discover_timeout          { read_sec_attr(node,  "dhcp_discover_timeout_sec", 10) },
@@ -173,6 +182,15 @@ Configuration::Configuration(Env               &env,
 		}
 		break;
 	}
+	/* distribute the domains round-robin among the transmitters */
+	if (_transmit_threads) {
+		unsigned idx { 0 };
+		_domains.for_each([&] (Domain &domain) {
+			domain.transmitter(transmitters.transmitter(idx++ % _transmit_threads));
+			if (_verbose) {
+				log("[", domain, "] transmitter: ", domain.transmitter()()); }
+		});
+	}
 	try {
 		/* check whether we shall create a report generator */
 		Xml_node const report_node = node.sub_node("report");
@@ -198,7 +216,7 @@ Configuration::Configuration(Env               &env,
 		try {
 			Nic_client &nic_client = *new (_alloc)
 				Nic_client { node, alloc, old_config._nic_clients, env, timer,
-				             interfaces, *this };
+				             interfaces, wakeup_batch, *this };
 
 			try { _nic_clients.insert(nic_client); }
 			catch (Nic_client_tree::Name_not_unique exception) {
@@ -35,10 +35,13 @@ class Net::Configuration
 
 		Genode::Allocator          &_alloc;
 		unsigned long        const  _max_packets_per_signal;
+		unsigned             const  _poll_spins;
+		unsigned             const  _transmit_threads;
 		bool                 const  _verbose;
 		bool                 const  _verbose_packets;
 		bool                 const  _verbose_packet_drop;
 		bool                 const  _verbose_domain_state;
+		bool                 const  _verify_checksums;
 		bool                 const  _icmp_echo_server;
 		Icmp_packet::Code    const  _icmp_type_3_code_on_fragm_ipv4;
 		Genode::Microseconds const  _dhcp_discover_timeout;
@@ -68,13 +71,15 @@ class Net::Configuration
 		Configuration(Genode::Xml_node const  node,
 		              Genode::Allocator      &alloc);
 
-		Configuration(Genode::Env            &env,
-		              Genode::Xml_node const  node,
-		              Genode::Allocator      &alloc,
-		              Timer::Connection      &timer,
-		              Configuration          &old_config,
-		              Quota            const &shared_quota,
-		              Interface_list         &interfaces);
+		Configuration(Genode::Env             &env,
+		              Genode::Xml_node const   node,
+		              Genode::Allocator       &alloc,
+		              Timer::Connection       &timer,
+		              Configuration           &old_config,
+		              Quota            const  &shared_quota,
+		              Interface_list          &interfaces,
+		              Wakeup_batch            &wakeup_batch,
+		              Domain_transmitter_pool &transmitters);
 
 		~Configuration();
 
@@ -88,10 +93,13 @@ class Net::Configuration
 		 ***************/
 
 		unsigned long         max_packets_per_signal()         const { return _max_packets_per_signal; }
+		unsigned              poll_spins()                     const { return _poll_spins; }
+		unsigned              transmit_threads()               const { return _transmit_threads; }
 		bool                  verbose()                        const { return _verbose; }
 		bool                  verbose_packets()                const { return _verbose_packets; }
 		bool                  verbose_packet_drop()            const { return _verbose_packet_drop; }
 		bool                  verbose_domain_state()           const { return _verbose_domain_state; }
+		bool                  verify_checksums()               const { return _verify_checksums; }
 		bool                  icmp_echo_server()               const { return _icmp_echo_server; }
 		Icmp_packet::Code     icmp_type_3_code_on_fragm_ipv4() const { return _icmp_type_3_code_on_fragm_ipv4; }
 		Genode::Microseconds  dhcp_discover_timeout()          const { return _dhcp_discover_timeout; }
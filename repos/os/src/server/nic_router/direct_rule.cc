@@ -22,7 +22,7 @@ Direct_rule_base::Direct_rule_base(Xml_node const node)
 :
 	_dst(node.attribute_value("dst", Ipv4_address_prefix()))
 {
-	if (!_dst.valid()) {
+	if (!_dst.valid() || _dst.prefix > 32) {
 		throw Invalid(); }
 }
 
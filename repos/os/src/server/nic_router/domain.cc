@@ -166,7 +166,8 @@ void Domain::_read_transport_rules(Cstring  const      &protocol,
 	node.for_each_sub_node(type, [&] (Xml_node const node) {
 		try {
 			rules.insert(*new (_alloc)
-				Transport_rule(domains, node, _alloc, protocol, _config, *this));
+				Transport_rule(domains, node, _alloc, protocol, _config, *this),
+				_alloc);
 		}
 		catch (Transport_rule::Invalid)     { _invalid("invalid transport rule"); }
 		catch (Permit_any_rule::Invalid)    { _invalid("invalid permit-any rule"); }
@@ -192,6 +193,11 @@ Domain::Domain(Configuration &config, Xml_node const node, Allocator &alloc)
 	_node                { node },
 	_alloc               { alloc },
 	_ip_config           { node, alloc },
+	_link_buckets        { node.attribute_value("link_buckets",
+	                                            (unsigned long)Link_side_table::DEFAULT_NR_OF_BUCKETS) },
+	_tcp_links           { alloc, _link_buckets },
+	_udp_links           { alloc, _link_buckets },
+	_icmp_links          { alloc, _link_buckets },
 	_verbose_packets     { node.attribute_value("verbose_packets",
 	                                            config.verbose_packets()) },
 	_verbose_packet_drop { node.attribute_value("verbose_packet_drop",
@@ -212,7 +218,7 @@ Domain::Domain(Configuration &config, Xml_node const node, Allocator &alloc)
 }
 
 
-Link_side_tree &Domain::links(L3_protocol const protocol)
+Link_side_table &Domain::links(L3_protocol const protocol)
 {
 	switch (protocol) {
 	case L3_protocol::TCP:  return _tcp_links;
@@ -311,12 +317,12 @@ void Domain::init(Domain_tree &domains)
 	});
 	/* read ICMP rules */
 	_node.for_each_sub_node("icmp", [&] (Xml_node const node) {
-		try { _icmp_rules.insert(*new (_alloc) Ip_rule(domains, node)); }
+		try { _icmp_rules.insert(*new (_alloc) Ip_rule(domains, node), _alloc); }
 		catch (Ip_rule::Invalid) { _invalid("invalid ICMP rule"); }
 	});
 	/* read IP rules */
 	_node.for_each_sub_node("ip", [&] (Xml_node const node) {
-		try { _ip_rules.insert(*new (_alloc) Ip_rule(domains, node)); }
+		try { _ip_rules.insert(*new (_alloc) Ip_rule(domains, node), _alloc); }
 		catch (Ip_rule::Invalid) { _invalid("invalid IP rule"); }
 	});
 }
@@ -0,0 +1,132 @@
+/*
+ * \brief  Thread that copies forwarded packets into the sessions of a domain
+ * \author Martin Stein
+ * \date   2022-06-22
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* local includes */
+#include <domain_transmitter.h>
+#include <interface.h>
+
+/* Genode includes */
+#include <base/env.h>
+
+using namespace Net;
+using namespace Genode;
+
+
+/************************
+ ** Domain_transmitter **
+ ************************/
+
+void Domain_transmitter::_handle_jobs()
+{
+	/*
+	 * The sleeping flag and the job queue form a Dekker-style handshake with
+	 * '_submit': either the producer observes that we went to sleep and
+	 * signals us, or we observe the job it enqueued.
+	 */
+	while (true) {
+		Job job { };
+		while (_jobs.try_dequeue(job)) {
+			if (!job.interface->transmit(job)) {
+				_failed++; }
+
+			__atomic_store_n(&_completed, _completed + 1, __ATOMIC_RELEASE);
+		}
+		__atomic_store_n(&_sleeping, true, __ATOMIC_SEQ_CST);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (_jobs.empty()) {
+			break; }
+
+		__atomic_store_n(&_sleeping, false, __ATOMIC_SEQ_CST);
+	}
+	/* release the router entrypoint if it waits for us */
+	if (__atomic_exchange_n(&_joining, false, __ATOMIC_SEQ_CST)) {
+		_idle_blockade.wakeup(); }
+}
+
+
+void Domain_transmitter::_submit(Job const &job)
+{
+	/*
+	 * If the queue is full, let the transmitter catch up. Jobs that fail
+	 * meanwhile stay accounted in '_failed' and are reported by the next
+	 * '_join'.
+	 */
+	while (!_jobs.try_enqueue(job)) {
+		_wait_idle(); }
+
+	_submitted++;
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_exchange_n(&_sleeping, false, __ATOMIC_SEQ_CST)) {
+		Signal_transmitter(_jobs_handler).submit(); }
+}
+
+
+void Domain_transmitter::_wait_idle()
+{
+	while (__atomic_load_n(&_completed, __ATOMIC_ACQUIRE) != _submitted) {
+
+		__atomic_store_n(&_joining, true, __ATOMIC_SEQ_CST);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&_completed, __ATOMIC_ACQUIRE) == _submitted) {
+			__atomic_store_n(&_joining, false, __ATOMIC_SEQ_CST);
+			break;
+		}
+		/*
+		 * A wakeup that is left over from an earlier join merely causes
+		 * another iteration.
+		 */
+		_idle_blockade.block();
+	}
+}
+
+
+unsigned long Domain_transmitter::_join()
+{
+	_wait_idle();
+
+	unsigned long const failed { _failed };
+	_failed = 0;
+	return failed;
+}
+
+
+Domain_transmitter::Domain_transmitter(Env                &env,
+                                       unsigned            idx,
+                                       Affinity::Location  location)
+:
+	_name         { "tx_", idx },
+	_ep           { env, STACK_SIZE, _name.string(), location },
+	_jobs_handler { _ep, *this, &Domain_transmitter::_handle_jobs }
+{ }
+
+
+/*****************************
+ ** Domain_transmitter_pool **
+ *****************************/
+
+Domain_transmitter &Domain_transmitter_pool::transmitter(unsigned idx)
+{
+	idx %= MAX_TRANSMITTERS;
+	if (!_transmitters[idx].constructed()) {
+
+		/* leave the first CPU to the router entrypoint */
+		Affinity::Space    const space { _env.cpu().affinity_space() };
+		Affinity::Location const location {
+			space.total() > 1 ?
+				space.location_of_index((int)(1 + idx % (space.total() - 1))) :
+				Affinity::Location() };
+
+		_transmitters[idx].construct(_env, idx, location);
+	}
+	return *_transmitters[idx];
+}
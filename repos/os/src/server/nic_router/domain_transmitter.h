@@ -0,0 +1,146 @@
+/*
+ * \brief  Thread that copies forwarded packets into the sessions of a domain
+ * \author Martin Stein
+ * \date   2022-06-22
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _DOMAIN_TRANSMITTER_H_
+#define _DOMAIN_TRANSMITTER_H_
+
+/* local includes */
+#include <spsc_queue.h>
+
+/* Genode includes */
+#include <base/entrypoint.h>
+#include <base/blockade.h>
+#include <util/list.h>
+#include <util/reconstructible.h>
+#include <net/mac_address.h>
+
+namespace Net {
+
+	class Interface;
+	class Wakeup_batch;
+	class Domain_transmitter;
+	class Domain_transmitter_pool;
+	using Domain_transmitter_list_element = Genode::List_element<Domain_transmitter>;
+}
+
+
+/**
+ * Entrypoint that transmits packets on behalf of the router entrypoint
+ *
+ * The router entrypoint does all packet inspection, routing, and state
+ * tracking. When it decides to pass a packet to an interface of a domain
+ * that has a transmitter, it merely hands a job over to the transmitter.
+ * The transmitter then allocates the packet at the interface, copies the
+ * frame, and submits it. Thus, the copying into different sessions can be
+ * done in parallel to the routing of further packets and to each other.
+ *
+ * The router entrypoint is the only producer of jobs. The frame of a job
+ * is the received packet that remains unacknowledged until the router
+ * entrypoint joined the transmitter (see 'Wakeup_batch').
+ */
+class Net::Domain_transmitter : Genode::Noncopyable
+{
+	friend class Wakeup_batch;
+
+	public:
+
+		struct Job
+		{
+			Interface      *interface { nullptr };
+			void     const *eth_base  { nullptr };
+			Genode::size_t  eth_size  { 0 };
+			Mac_address     eth_src   { };
+			Mac_address     eth_dst   { };
+		};
+
+	private:
+
+		enum { STACK_SIZE          = 4 * 1024 * sizeof(long) };
+		enum { JOB_QUEUE_SIZE_LOG2 = 8 };
+
+		using Name           = Genode::String<32>;
+		using Signal_handler = Genode::Signal_handler<Domain_transmitter>;
+
+		Name                           const  _name;
+		Genode::Entrypoint                    _ep;
+		Signal_handler                        _jobs_handler;
+		Spsc_queue<Job, JOB_QUEUE_SIZE_LOG2>  _jobs          { };
+		Genode::Blockade                      _idle_blockade { };
+		unsigned long                         _submitted     { 0 };
+		unsigned long                         _completed     { 0 };
+		unsigned long                         _failed        { 0 };
+		bool                                  _sleeping      { true };
+		bool                                  _joining       { false };
+		Domain_transmitter_list_element       _batch_le      { this };
+		bool                                  _in_batch      { false };
+
+		void _handle_jobs();
+
+		/**
+		 * Pass 'job' to the transmitter, called by the router entrypoint
+		 */
+		void _submit(Job const &job);
+
+		/**
+		 * Wait until all submitted jobs are completed
+		 */
+		void _wait_idle();
+
+		/**
+		 * Wait until all submitted jobs are completed
+		 *
+		 * \return  number of jobs that failed since the last call
+		 */
+		unsigned long _join();
+
+	public:
+
+		Domain_transmitter(Genode::Env                &env,
+		                   unsigned                    idx,
+		                   Genode::Affinity::Location  location);
+
+
+		/*********
+		 ** log **
+		 *********/
+
+		void print(Genode::Output &output) const { Genode::print(output, _name); }
+};
+
+
+/**
+ * Transmitters get created on first use and are kept for the lifetime of
+ * the router so that re-configurations do not churn threads
+ */
+class Net::Domain_transmitter_pool : Genode::Noncopyable
+{
+	private:
+
+		enum { MAX_TRANSMITTERS = 16 };
+
+		Genode::Env                               &_env;
+		Genode::Constructible<Domain_transmitter>  _transmitters[MAX_TRANSMITTERS];
+
+	public:
+
+		Domain_transmitter_pool(Genode::Env &env) : _env(env) { }
+
+		/**
+		 * Return transmitter 'idx', pinned to CPU 'idx + 1' if possible
+		 */
+		Domain_transmitter &transmitter(unsigned idx);
+
+		static unsigned max_transmitters() { return MAX_TRANSMITTERS; }
+};
+
+#endif /* _DOMAIN_TRANSMITTER_H_ */
@@ -16,6 +16,7 @@
 #include <net/udp.h>
 #include <net/icmp.h>
 #include <net/arp.h>
+#include <net/internet_checksum.h>
 #include <base/quota_guard.h>
 
 /* local includes */
@@ -26,10 +27,13 @@
 using namespace Net;
 using Genode::Deallocator;
 using Genode::size_t;
+using Genode::uint16_t;
 using Genode::uint32_t;
 using Genode::addr_t;
 using Genode::log;
 using Genode::error;
+using Genode::warning;
+using Genode::Hex;
 using Genode::Exception;
 using Genode::Out_of_ram;
 using Genode::Out_of_caps;
@@ -179,6 +183,37 @@ static void _update_checksum(L3_protocol   const prot,
 }
 
 
+static void _update_checksum(L3_protocol            const  prot,
+                             void                  *const  prot_base,
+                             Internet_checksum_diff const &ip_icd,
+                             Internet_checksum_diff        prot_icd)
+{
+	switch (prot) {
+	case L3_protocol::TCP:
+		prot_icd.add_up_diff(ip_icd);
+		((Tcp_packet *)prot_base)->update_checksum(prot_icd);
+		return;
+	case L3_protocol::UDP:
+		prot_icd.add_up_diff(ip_icd);
+		((Udp_packet *)prot_base)->update_checksum(prot_icd);
+		return;
+	case L3_protocol::ICMP:
+		((Icmp_packet *)prot_base)->update_checksum(prot_icd);
+		return;
+	default: throw Interface::Bad_transport_protocol(); }
+}
+
+
+static uint16_t _checksum(L3_protocol const prot, void *const prot_base)
+{
+	switch (prot) {
+	case L3_protocol::TCP:  return ((Tcp_packet *)prot_base)->checksum();
+	case L3_protocol::UDP:  return ((Udp_packet *)prot_base)->checksum();
+	case L3_protocol::ICMP: return ((Icmp_packet *)prot_base)->checksum();
+	default: throw Interface::Bad_transport_protocol(); }
+}
+
+
 static Port _dst_port(L3_protocol const prot, void *const prot_base)
 {
 	switch (prot) {
@@ -201,6 +236,19 @@ static void _dst_port(L3_protocol  const prot,
 }
 
 
+static void _dst_port(L3_protocol             const  prot,
+                      void                   *const  prot_base,
+                      Port                    const  port,
+                      Internet_checksum_diff        &icd)
+{
+	switch (prot) {
+	case L3_protocol::TCP:  (*(Tcp_packet *)prot_base).dst_port(port, icd);  return;
+	case L3_protocol::UDP:  (*(Udp_packet *)prot_base).dst_port(port, icd);  return;
+	case L3_protocol::ICMP: (*(Icmp_packet *)prot_base).query_id(port.value, icd); return;
+	default: throw Interface::Bad_transport_protocol(); }
+}
+
+
 static Port _src_port(L3_protocol const prot, void *const prot_base)
 {
 	switch (prot) {
@@ -223,6 +271,19 @@ static void _src_port(L3_protocol  const prot,
 }
 
 
+static void _src_port(L3_protocol             const  prot,
+                      void                   *const  prot_base,
+                      Port                    const  port,
+                      Internet_checksum_diff        &icd)
+{
+	switch (prot) {
+	case L3_protocol::TCP:  ((Tcp_packet *)prot_base)->src_port(port, icd);        return;
+	case L3_protocol::UDP:  ((Udp_packet *)prot_base)->src_port(port, icd);        return;
+	case L3_protocol::ICMP: ((Icmp_packet *)prot_base)->query_id(port.value, icd); return;
+	default: throw Interface::Bad_transport_protocol(); }
+}
+
+
 static void *_prot_base(L3_protocol const  prot,
                         Size_guard        &size_guard,
                         Ipv4_packet       &ip)
@@ -293,28 +354,172 @@ void Interface::_destroy_link(Link &link)
 }
 
 
-void Interface::_pass_prot(Ethernet_frame       &eth,
-                           Size_guard           &size_guard,
-                           Ipv4_packet          &ip,
-                           L3_protocol    const  prot,
-                           void          *const  prot_base,
-                           size_t         const  prot_size)
+void Interface::_update_checksums(Ipv4_packet                  &ip,
+                                  Internet_checksum_diff const &ip_icd,
+                                  L3_protocol            const  prot,
+                                  void                  *const  prot_base,
+                                  size_t                 const  prot_size,
+                                  Internet_checksum_diff const &prot_icd)
 {
-	eth.src(_router_mac);
-	if (!_domain().use_arp()) {
-		eth.dst(_router_mac);
-	}
+	_update_checksum(prot, prot_base, ip_icd, prot_icd);
+	ip.update_checksum(ip_icd);
+	if (!_config().verify_checksums()) {
+		return; }
+
+	/* compare the incremental update with a full re-computation */
+	uint16_t const prot_sum { _checksum(prot, prot_base) };
+	uint16_t const ip_sum   { ip.checksum() };
 	_update_checksum(prot, prot_base, prot_size, ip.src(), ip.dst(), ip.total_length());
-	_pass_ip(eth, size_guard, ip);
+	ip.update_checksum();
+
+	/* a zero UDP checksum stays untouched by the incremental update */
+	bool const udp_sum_unused { prot == L3_protocol::UDP && !prot_sum };
+	if ((prot_sum != _checksum(prot, prot_base) && !udp_sum_unused) ||
+	    ip_sum != ip.checksum())
+	{
+		warning("incremental checksum update differs from full re-computation"
+		        " (", l3_protocol_name(prot), " ", Hex(prot_sum), "/",
+		        Hex(_checksum(prot, prot_base)), ", IPv4 ", Hex(ip_sum), "/",
+		        Hex(ip.checksum()), ")");
+	}
 }
 
 
-void Interface::_pass_ip(Ethernet_frame &eth,
-                         Size_guard     &size_guard,
-                         Ipv4_packet    &ip)
+void Interface::_pass_prot_to_domain(Domain                       &domain,
+                                     Ethernet_frame               &eth,
+                                     Size_guard                   &size_guard,
+                                     Ipv4_packet                  &ip,
+                                     Internet_checksum_diff const &ip_icd,
+                                     L3_protocol            const  prot,
+                                     void                  *const  prot_base,
+                                     size_t                 const  prot_size,
+                                     Internet_checksum_diff const &prot_icd)
 {
-	ip.update_checksum();
-	send(eth, size_guard);
+	/*
+	 * Update checksums only once as the packet is the same for all
+	 * interfaces and the incremental update must not be applied twice.
+	 */
+	_update_checksums(ip, ip_icd, prot, prot_base, prot_size, prot_icd);
+	_pass_eth_to_domain(domain, eth, size_guard, true);
+}
+
+
+void Interface::_pass_ip_to_domain(Domain         &domain,
+                                   Ethernet_frame &eth,
+                                   Size_guard     &size_guard,
+                                   Ipv4_packet    &ip)
+{
+	/*
+	 * The IPv4 header is passed unmodified, so, its checksum is not updated.
+	 * When verifying checksums, a packet with a bad checksum is dropped
+	 * instead of being forwarded.
+	 */
+	if (_config().verify_checksums() && ip.checksum_error()) {
+		throw Drop_packet("bad IPv4 checksum"); }
+
+	_pass_eth_to_domain(domain, eth, size_guard, false);
+}
+
+
+void Interface::_pass_eth_to_domain(Domain         &domain,
+                                    Ethernet_frame &eth,
+                                    Size_guard     &size_guard,
+                                    bool            adapt_eth)
+{
+	/*
+	 * If the domain has a transmitter, the frame is not modified in place
+	 * because the transmitter reads it asynchronously. Instead, the
+	 * addresses for each interface go with the job and are applied to the
+	 * copy. Verbose packet logging implies sending directly so that the
+	 * log shows the frame as sent.
+	 */
+	if (domain.transmitter().valid() &&
+	    _wakeup_batch.active() &&
+	    !domain.verbose_packets())
+	{
+		Domain_transmitter &transmitter { domain.transmitter()() };
+		domain.interfaces().for_each([&] (Interface &interface) {
+
+			Mac_address const eth_src {
+				adapt_eth ? interface._router_mac : eth.src() };
+
+			Mac_address const eth_dst {
+				adapt_eth && !domain.use_arp() ?
+					interface._router_mac : eth.dst() };
+
+			_hand_off_eth(transmitter, interface, eth, size_guard, eth_src,
+			              eth_dst);
+		});
+		return;
+	}
+	domain.interfaces().for_each([&] (Interface &interface) {
+		if (adapt_eth) {
+			eth.src(interface._router_mac);
+			if (!domain.use_arp()) {
+				eth.dst(interface._router_mac);
+			}
+		}
+		interface.send(eth, size_guard);
+	});
+}
+
+
+void Interface::_hand_off_eth(Domain_transmitter &transmitter,
+                              Interface          &interface,
+                              Ethernet_frame     &eth,
+                              Size_guard         &size_guard,
+                              Mac_address  const &eth_src,
+                              Mac_address  const &eth_dst)
+{
+	if (!interface.link_state()) {
+		interface._failed_to_send_packet_link();
+		return;
+	}
+	size_t const eth_size { size_guard.total_size() };
+	interface._domain().raise_tx_bytes(eth_size);
+
+	Domain_transmitter::Job job { };
+	job.interface = &interface;
+	job.eth_base  = &eth;
+	job.eth_size  = eth_size;
+	job.eth_src   = eth_src;
+	job.eth_dst   = eth_dst;
+	_wakeup_batch.hand_off(transmitter, job);
+
+	/* the received packet must not be acknowledged before the job is done */
+	_pkt_handed_off = true;
+	interface._wakeup_peer();
+}
+
+
+void Interface::_join_handoffs()
+{
+	unsigned long const failed { _wakeup_batch.join_handoffs() };
+	if (failed && _config().verbose()) {
+		log("failed to send ", failed, " handed-off packet(s)"); }
+}
+
+
+bool Interface::transmit(Domain_transmitter::Job const &job)
+{
+	Genode::Mutex::Guard guard { _source_mutex };
+	try {
+		Packet_descriptor const pkt { _source.alloc_packet(job.eth_size) };
+		void *const pkt_base { _source.packet_content(pkt) };
+		Genode::memcpy(pkt_base, job.eth_base, job.eth_size);
+
+		Size_guard size_guard(job.eth_size);
+		Ethernet_frame &eth { Ethernet_frame::cast_from(pkt_base, size_guard) };
+		eth.src(job.eth_src);
+		eth.dst(job.eth_dst);
+
+		if (!_source.try_submit_packet(pkt)) {
+			_source.release_packet(pkt);
+			return false;
+		}
+		return true;
+	}
+	catch (Packet_stream_source::Packet_alloc_failed) { return false; }
 }
 
 
@@ -577,15 +782,17 @@ void Interface::_adapt_eth(Ethernet_frame          &eth,
 }
 
 
-void Interface::_nat_link_and_pass(Ethernet_frame        &eth,
-                                   Size_guard            &size_guard,
-                                   Ipv4_packet           &ip,
-                                   L3_protocol     const  prot,
-                                   void           *const  prot_base,
-                                   size_t          const  prot_size,
-                                   Link_side_id    const &local_id,
-                                   Domain                &local_domain,
-                                   Domain                &remote_domain)
+void Interface::_nat_link_and_pass(Ethernet_frame         &eth,
+                                   Size_guard             &size_guard,
+                                   Ipv4_packet            &ip,
+                                   Internet_checksum_diff &ip_icd,
+                                   L3_protocol      const  prot,
+                                   void            *const  prot_base,
+                                   size_t           const  prot_size,
+                                   Internet_checksum_diff &prot_icd,
+                                   Link_side_id     const &local_id,
+                                   Domain                 &local_domain,
+                                   Domain                 &remote_domain)
 {
 	try {
 		Pointer<Port_allocator_guard> remote_port_alloc;
@@ -594,17 +801,16 @@ void Interface::_nat_link_and_pass(Ethernet_frame        &eth,
 			if(_config().verbose()) {
 				log("[", local_domain, "] using NAT rule: ", nat); }
 
-			_src_port(prot, prot_base, nat.port_alloc(prot).alloc());
-			ip.src(remote_domain.ip_config().interface().address);
+			_src_port(prot, prot_base, nat.port_alloc(prot).alloc(), prot_icd);
+			ip.src(remote_domain.ip_config().interface().address, ip_icd);
 			remote_port_alloc = nat.port_alloc(prot);
 		}
 		catch (Nat_rule_tree::No_match) { }
 		Link_side_id const remote_id = { ip.dst(), _dst_port(prot, prot_base),
 		                                 ip.src(), _src_port(prot, prot_base) };
 		_new_link(prot, local_id, remote_port_alloc, remote_domain, remote_id);
-		remote_domain.interfaces().for_each([&] (Interface &interface) {
-			interface._pass_prot(eth, size_guard, ip, prot, prot_base, prot_size);
-		});
+		_pass_prot_to_domain(remote_domain, eth, size_guard, ip, ip_icd, prot,
+		                     prot_base, prot_size, prot_icd);
 	} catch (Port_allocator_guard::Out_of_indices) {
 		switch (prot) {
 		case L3_protocol::TCP:  _tcp_stats.refused_for_ports++;  break;
@@ -989,18 +1195,19 @@ void Interface::_handle_icmp_query(Ethernet_frame          &eth,
 			    " link: ", link);
 		}
 		_adapt_eth(eth, remote_side.src_ip(), pkt, remote_domain);
-		ip.src(remote_side.dst_ip());
-		ip.dst(remote_side.src_ip());
-		_src_port(prot, prot_base, remote_side.dst_port());
-		_dst_port(prot, prot_base, remote_side.src_port());
-
-		remote_domain.interfaces().for_each([&] (Interface &interface) {
-			interface._pass_prot(eth, size_guard, ip, prot, prot_base, prot_size);
-		});
+		Internet_checksum_diff ip_icd { };
+		Internet_checksum_diff prot_icd { };
+		ip.src(remote_side.dst_ip(), ip_icd);
+		ip.dst(remote_side.src_ip(), ip_icd);
+		_src_port(prot, prot_base, remote_side.dst_port(), prot_icd);
+		_dst_port(prot, prot_base, remote_side.src_port(), prot_icd);
+
+		_pass_prot_to_domain(remote_domain, eth, size_guard, ip, ip_icd, prot,
+		                     prot_base, prot_size, prot_icd);
 		_link_packet(prot, prot_base, link, client);
 		return;
 	}
-	catch (Link_side_tree::No_match) { }
+	catch (Link_side_table::No_match) { }
 
 	/* try to route via ICMP rules */
 	try {
@@ -1012,8 +1219,11 @@ void Interface::_handle_icmp_query(Ethernet_frame          &eth,
 
 		Domain &remote_domain = rule.domain();
 		_adapt_eth(eth, local_id.dst_ip, pkt, remote_domain);
-		_nat_link_and_pass(eth, size_guard, ip, prot, prot_base, prot_size,
-		                   local_id, local_domain, remote_domain);
+		Internet_checksum_diff ip_icd { };
+		Internet_checksum_diff prot_icd { };
+		_nat_link_and_pass(eth, size_guard, ip, ip_icd, prot, prot_base,
+		                   prot_size, prot_icd, local_id, local_domain,
+		                   remote_domain);
 
 		return;
 	}
@@ -1081,7 +1291,7 @@ void Interface::_handle_icmp_error(Ethernet_frame          &eth,
 			_link_packet(embed_prot, embed_prot_base, link, client); }
 	}
 	/* drop packet if there is no matching link */
-	catch (Link_side_tree::No_match) {
+	catch (Link_side_table::No_match) {
 		throw Drop_packet("no link that matches packet embedded in ICMP error"); }
 }
 
@@ -1217,18 +1427,19 @@ void Interface::_handle_ip(Ethernet_frame          &eth,
 				    " link: ", link);
 			}
 			_adapt_eth(eth, remote_side.src_ip(), pkt, remote_domain);
-			ip.src(remote_side.dst_ip());
-			ip.dst(remote_side.src_ip());
-			_src_port(prot, prot_base, remote_side.dst_port());
-			_dst_port(prot, prot_base, remote_side.src_port());
-
-			remote_domain.interfaces().for_each([&] (Interface &interface) {
-				interface._pass_prot(eth, size_guard, ip, prot, prot_base, prot_size);
-			});
+			Internet_checksum_diff ip_icd { };
+			Internet_checksum_diff prot_icd { };
+			ip.src(remote_side.dst_ip(), ip_icd);
+			ip.dst(remote_side.src_ip(), ip_icd);
+			_src_port(prot, prot_base, remote_side.dst_port(), prot_icd);
+			_dst_port(prot, prot_base, remote_side.src_port(), prot_icd);
+
+			_pass_prot_to_domain(remote_domain, eth, size_guard, ip, ip_icd,
+			                     prot, prot_base, prot_size, prot_icd);
 			_link_packet(prot, prot_base, link, client);
 			return;
 		}
-		catch (Link_side_tree::No_match) { }
+		catch (Link_side_table::No_match) { }
 
 		/* try to route via forward rules */
 		if (local_id.dst_ip == local_intf.address) {
@@ -1242,12 +1453,15 @@ void Interface::_handle_ip(Ethernet_frame          &eth,
 				}
 				Domain &remote_domain = rule.domain();
 				_adapt_eth(eth, rule.to_ip(), pkt, remote_domain);
-				ip.dst(rule.to_ip());
+				Internet_checksum_diff ip_icd { };
+				Internet_checksum_diff prot_icd { };
+				ip.dst(rule.to_ip(), ip_icd);
 				if (!(rule.to_port() == Port(0))) {
-					_dst_port(prot, prot_base, rule.to_port());
+					_dst_port(prot, prot_base, rule.to_port(), prot_icd);
 				}
-				_nat_link_and_pass(eth, size_guard, ip, prot, prot_base,
-				                   prot_size, local_id, local_domain, remote_domain);
+				_nat_link_and_pass(eth, size_guard, ip, ip_icd, prot, prot_base,
+				                   prot_size, prot_icd, local_id, local_domain,
+				                   remote_domain);
 				return;
 			}
 			catch (Forward_rule_tree::No_match) { }
@@ -1266,8 +1480,11 @@ void Interface::_handle_ip(Ethernet_frame          &eth,
 			}
 			Domain &remote_domain = permit_rule.domain();
 			_adapt_eth(eth, local_id.dst_ip, pkt, remote_domain);
-			_nat_link_and_pass(eth, size_guard, ip, prot, prot_base, prot_size,
-			                   local_id, local_domain, remote_domain);
+			Internet_checksum_diff ip_icd { };
+			Internet_checksum_diff prot_icd { };
+			_nat_link_and_pass(eth, size_guard, ip, ip_icd, prot, prot_base,
+			                   prot_size, prot_icd, local_id, local_domain,
+			                   remote_domain);
 			return;
 		}
 		catch (Transport_rule_list::No_match) { }
@@ -1285,9 +1502,7 @@ void Interface::_handle_ip(Ethernet_frame          &eth,
 
 		Domain &remote_domain = rule.domain();
 		_adapt_eth(eth, ip.dst(), pkt, remote_domain);
-		remote_domain.interfaces().for_each([&] (Interface &interface) {
-			interface._pass_ip(eth, size_guard, ip);
-		});
+		_pass_ip_to_domain(remote_domain, eth, size_guard, ip);
 
 		return;
 	}
@@ -1469,11 +1684,11 @@ void Interface::_handle_arp(Ethernet_frame &eth,
 
 void Interface::_handle_pkt()
 {
-	Packet_descriptor const pkt = _sink.get_packet();
+	Packet_descriptor const pkt = _sink.try_get_packet();
 	Size_guard size_guard(pkt.size());
 	try {
 		_handle_eth(_sink.packet_content(pkt), size_guard, pkt);
-		_ack_packet(pkt);
+		_ack_or_defer_packet(pkt);
 	}
 	catch (Packet_postponed) { }
 	catch (Genode::Packet_descriptor::Invalid_packet) { }
@@ -1483,40 +1698,61 @@ void Interface::_handle_pkt()
 void Interface::_handle_pkt_stream_signal()
 {
 	/*
-	 * Release all sent packets that were already acknowledged by the counter
-	 * side. Doing this first frees packet-stream memory which facilitates
-	 * sending new packets in the subsequent steps of this handler.
-	 */
-	while (_source.ack_avail()) {
-		_source.release_packet(_source.get_acked_packet());
-	}
-
-	/*
-	 * Handle packets received from the counter side. If the user configured
-	 * a limit for the number of packets to be handled at once, this limit gets
-	 * applied. If there is no such limit, received packets are handled until
-	 * none is left.
+	 * Handle all available packets as one batch. The packet-stream API is
+	 * used in a non-blocking way, so, submitting, acknowledging, or taking
+	 * packets doesn't signal the respective peer immediately. Instead, each
+	 * interface that was involved signals its peer only once at the end of
+	 * the batch.
 	 */
-	unsigned long const max_pkts = _config().max_packets_per_signal();
-	if (max_pkts) {
-		for (unsigned long i = 0; _sink.packet_avail(); i++) {
+	_wakeup_batch.apply([&] () {
 
-			if (i >= max_pkts) {
-
-				/*
-				 * Ensure that this handler is called again in order to handle
-				 * the packets left unhandled due to the configured limit.
-				 */
-				Signal_transmitter(_pkt_stream_signal_handler).submit();
-				break;
+		/*
+		 * Release all sent packets that were already acknowledged by the
+		 * counter side. Doing this first frees packet-stream memory which
+		 * facilitates sending new packets in the subsequent steps of this
+		 * handler.
+		 */
+		{
+			Genode::Mutex::Guard guard { _source_mutex };
+			while (_source.ack_avail()) {
+				_source.release_packet(_source.try_get_acked_packet());
 			}
-			_handle_pkt();
 		}
-	} else {
-		while (_sink.packet_avail()) {
-			_handle_pkt();
+
+		/*
+		 * Handle packets received from the counter side. If the user
+		 * configured a limit for the number of packets to be handled at
+		 * once, this limit gets applied. If there is no such limit, received
+		 * packets are handled until none is left.
+		 */
+		unsigned long const max_pkts = _config().max_packets_per_signal();
+		_sink.adaptive_polling(_config().poll_spins());
+		if (max_pkts) {
+			for (unsigned long i = 0; _sink_pkt_avail(); i++) {
+
+				if (i >= max_pkts) {
+
+					/*
+					 * Ensure that this handler is called again in order to
+					 * handle the packets left unhandled due to the
+					 * configured limit.
+					 */
+					Signal_transmitter(_pkt_stream_signal_handler).submit();
+					break;
+				}
+				_handle_pkt();
+			}
+		} else {
+			while (_sink_pkt_avail()) {
+				_handle_pkt();
+			}
 		}
-	}
+		/* acknowledge the packets that were handed off to transmitters */
+		_ack_deferred_packets();
+
+		/* signal space that was freed in the queues of this interface */
+		_wakeup_peer();
+	});
 }
 
 
@@ -1534,6 +1770,10 @@ void Interface::_continue_handle_eth(Domain            const &domain,
 			log("[", domain, "] invalid Nic packet received");
 		}
 	}
+	if (_pkt_handed_off) {
+		_pkt_handed_off = false;
+		_join_handoffs();
+	}
 	_ack_packet(pkt);
 }
 
@@ -1741,6 +1981,7 @@ void Interface::_send_alloc_pkt(Packet_descriptor &pkt,
                                 void            * &pkt_base,
                                 size_t             pkt_size)
 {
+	Genode::Mutex::Guard guard { _source_mutex };
 	pkt      = _source.alloc_packet(pkt_size);
 	pkt_base = _source.packet_content(pkt);
 }
@@ -1760,7 +2001,41 @@ void Interface::_send_submit_pkt(Packet_descriptor &pkt,
 		}
 		catch (Size_guard::Exceeded) { log("[", local_domain, "] snd ?"); }
 	}
-	_source.submit_packet(pkt);
+	bool submitted;
+	{
+		Genode::Mutex::Guard guard { _source_mutex };
+		submitted = _source.try_submit_packet(pkt);
+		if (!submitted) {
+			_source.release_packet(pkt); }
+	}
+	if (!submitted) {
+		_failed_to_send_packet_submit();
+		return;
+	}
+	_wakeup_peer();
+}
+
+
+void Interface::_wakeup_peer()
+{
+	if (!_wakeup_batch.active()) {
+		wakeup_peer();
+		return;
+	}
+	if (!_wakeup_deferred) {
+		_wakeup_batch.defer(_wakeup_batch_le);
+		_wakeup_deferred = true;
+	}
+}
+
+
+void Interface::wakeup_peer()
+{
+	_wakeup_deferred = false;
+	_source.wakeup_packet_avail();
+	_source.wakeup_ready_to_ack();
+	_sink.wakeup_ack_avail();
+	_sink.wakeup_ready_to_submit();
 }
 
 
@@ -1771,6 +2046,7 @@ Interface::Interface(Genode::Entrypoint     &ep,
                      Mac_address      const  mac,
                      Configuration          &config,
                      Interface_list         &interfaces,
+                     Wakeup_batch           &wakeup_batch,
                      Packet_stream_sink     &sink,
                      Packet_stream_source   &source,
                      Interface_policy       &policy)
@@ -1784,7 +2060,8 @@ Interface::Interface(Genode::Entrypoint     &ep,
 	_policy                    { policy },
 	_timer                     { timer },
 	_alloc                     { alloc },
-	_interfaces                { interfaces }
+	_interfaces                { interfaces },
+	_wakeup_batch              { wakeup_batch }
 {
 	_interfaces.insert(this);
 }
@@ -2049,6 +2326,13 @@ void Interface::_failed_to_send_packet_alloc()
 }
 
 
+void Interface::_failed_to_send_packet_submit()
+{
+	if (_config().verbose()) {
+		log("[", _domain(), "] failed to send packet (submit queue full)"); }
+}
+
+
 void Interface::handle_config_2()
 {
 	Domain_name const &new_domain_name = _policy.determine_domain_name();
@@ -2160,14 +2444,41 @@ void Interface::handle_config_3()
 
 void Interface::_ack_packet(Packet_descriptor const &pkt)
 {
-	if (!_sink.ready_to_ack()) {
+	if (!_sink.try_ack_packet(pkt)) {
 		if (_config().verbose()) {
 			log("[", _domain(), "] leak packet (sink not ready to "
 			    "acknowledge)");
 		}
 		return;
 	}
-	_sink.acknowledge_packet(pkt);
+	_wakeup_peer();
+}
+
+
+void Interface::_ack_or_defer_packet(Packet_descriptor const &pkt)
+{
+	if (!_pkt_handed_off) {
+		_ack_packet(pkt);
+		return;
+	}
+	_pkt_handed_off = false;
+	if (_deferred_acks_cnt == MAX_DEFERRED_ACKS) {
+		_ack_deferred_packets(); }
+
+	_deferred_acks[_deferred_acks_cnt++] = pkt;
+}
+
+
+void Interface::_ack_deferred_packets()
+{
+	if (!_deferred_acks_cnt) {
+		return; }
+
+	_join_handoffs();
+	for (unsigned idx = 0; idx < _deferred_acks_cnt; idx++) {
+		_ack_packet(_deferred_acks[idx]); }
+
+	_deferred_acks_cnt = 0;
 }
 
 
@@ -2191,6 +2502,8 @@ Interface::~Interface()
 {
 	_detach_from_domain();
 	_interfaces.remove(this);
+	if (_wakeup_deferred) {
+		_wakeup_batch.withdraw(_wakeup_batch_le); }
 }
 
 
@@ -22,8 +22,10 @@
 #include <dhcp_server.h>
 #include <list.h>
 #include <report.h>
+#include <wakeup_batch.h>
 
 /* Genode includes */
+#include <base/mutex.h>
 #include <nic_session/nic_session.h>
 #include <net/dhcp.h>
 #include <net/icmp.h>
@@ -41,6 +43,7 @@ namespace Net {
 	class Transport_rule_list;
 	class Ethernet_frame;
 	class Arp_packet;
+	class Internet_checksum_diff;
 	class Interface_policy;
 	class Interface;
 	using Interface_list = List<Interface>;
@@ -116,6 +119,7 @@ class Net::Interface : private Interface_list::Element
 
 		enum { IPV4_TIME_TO_LIVE          = 64 };
 		enum { MAX_FREE_OPS_PER_EMERGENCY = 1024 };
+		enum { MAX_DEFERRED_ACKS          = 64 };
 
 		struct Dismiss_link       : Genode::Exception { };
 		struct Dismiss_arp_waiter : Genode::Exception { };
@@ -135,6 +139,7 @@ class Net::Interface : private Interface_list::Element
 
 		Packet_stream_sink                   &_sink;
 		Packet_stream_source                 &_source;
+		Genode::Mutex                         _source_mutex              { };
 		Signal_handler                        _pkt_stream_signal_handler;
 		Mac_address                    const  _router_mac;
 		Mac_address                    const  _mac;
@@ -154,6 +159,12 @@ class Net::Interface : private Interface_list::Element
 		Dhcp_allocation_list                  _released_dhcp_allocations { };
 		Genode::Constructible<Dhcp_client>    _dhcp_client               { };
 		Interface_list                       &_interfaces;
+		Wakeup_batch                         &_wakeup_batch;
+		Wakeup_batch_list_element             _wakeup_batch_le           { this };
+		bool                                  _wakeup_deferred           { false };
+		bool                                  _pkt_handed_off            { false };
+		Packet_descriptor                     _deferred_acks[MAX_DEFERRED_ACKS] { };
+		unsigned                              _deferred_acks_cnt         { 0 };
 		Genode::Constructible<Update_domain>  _update_domain             { };
 		Interface_link_stats                  _udp_stats                 { };
 		Interface_link_stats                  _tcp_stats                 { };
@@ -262,9 +273,11 @@ class Net::Interface : private Interface_list::Element
 		void _nat_link_and_pass(Ethernet_frame         &eth,
 		                        Size_guard             &size_guard,
 		                        Ipv4_packet            &ip,
+		                        Internet_checksum_diff &ip_icd,
 		                        L3_protocol      const  prot,
 		                        void            *const  prot_base,
 		                        Genode::size_t   const  prot_size,
+		                        Internet_checksum_diff &prot_icd,
 		                        Link_side_id     const &local_id,
 		                        Domain                 &local_domain,
 		                        Domain                 &remote_domain);
@@ -276,19 +289,50 @@ class Net::Interface : private Interface_list::Element
 		                       Size_guard     &size_guard,
 		                       Domain         &local_domain);
 
-		void _pass_prot(Ethernet_frame         &eth,
-		                Size_guard             &size_guard,
-		                Ipv4_packet            &ip,
-		                L3_protocol      const  prot,
-		                void            *const  prot_base,
-		                Genode::size_t   const  prot_size);
-
-		void _pass_ip(Ethernet_frame       &eth,
-		              Size_guard           &size_guard,
-		              Ipv4_packet          &ip);
+		void _update_checksums(Ipv4_packet                  &ip,
+		                       Internet_checksum_diff const &ip_icd,
+		                       L3_protocol            const  prot,
+		                       void                  *const  prot_base,
+		                       Genode::size_t         const  prot_size,
+		                       Internet_checksum_diff const &prot_icd);
+
+		void _pass_prot_to_domain(Domain                       &domain,
+		                          Ethernet_frame               &eth,
+		                          Size_guard                   &size_guard,
+		                          Ipv4_packet                  &ip,
+		                          Internet_checksum_diff const &ip_icd,
+		                          L3_protocol            const  prot,
+		                          void                  *const  prot_base,
+		                          Genode::size_t         const  prot_size,
+		                          Internet_checksum_diff const &prot_icd);
+
+		void _pass_ip_to_domain(Domain         &domain,
+		                        Ethernet_frame &eth,
+		                        Size_guard     &size_guard,
+		                        Ipv4_packet    &ip);
+
+		void _pass_eth_to_domain(Domain         &domain,
+		                         Ethernet_frame &eth,
+		                         Size_guard     &size_guard,
+		                         bool            adapt_eth);
+
+		void _hand_off_eth(Domain_transmitter &transmitter,
+		                   Interface          &interface,
+		                   Ethernet_frame     &eth,
+		                   Size_guard         &size_guard,
+		                   Mac_address  const &eth_src,
+		                   Mac_address  const &eth_dst);
+
+		void _join_handoffs();
 
 		void _handle_pkt();
 
+		/**
+		 * Return whether a packet is available, polling if the sink is drained
+		 */
+		bool _sink_pkt_avail() {
+			return _sink.packet_avail() || _sink.poll_packet_avail(); }
+
 		void _continue_handle_eth(Domain            const &domain,
 		                          Packet_descriptor const &pkt);
 
@@ -305,6 +349,12 @@ class Net::Interface : private Interface_list::Element
 
 		void _ack_packet(Packet_descriptor const &pkt);
 
+		void _ack_or_defer_packet(Packet_descriptor const &pkt);
+
+		void _ack_deferred_packets();
+
+		void _wakeup_peer();
+
 		void _send_alloc_pkt(Genode::Packet_descriptor   &pkt,
 		                     void                      * &pkt_base,
 		                     Genode::size_t               pkt_size);
@@ -347,6 +397,8 @@ class Net::Interface : private Interface_list::Element
 
 		void _failed_to_send_packet_alloc();
 
+		void _failed_to_send_packet_submit();
+
 		void _send_icmp_dst_unreachable(Ipv4_address_prefix const &local_intf,
 		                                Ethernet_frame      const &req_eth,
 		                                Ipv4_packet         const &req_ip,
@@ -379,6 +431,7 @@ class Net::Interface : private Interface_list::Element
 		          Mac_address      const  mac,
 		          Configuration          &config,
 		          Interface_list         &interfaces,
+		          Wakeup_batch           &wakeup_batch,
 		          Packet_stream_sink     &sink,
 		          Packet_stream_source   &source,
 		          Interface_policy       &policy);
@@ -411,6 +464,21 @@ class Net::Interface : private Interface_list::Element
 		void send(Ethernet_frame &eth,
 		          Size_guard     &size_guard);
 
+		/**
+		 * Send a copy of the frame of 'job', called by a domain transmitter
+		 *
+		 * Only the packet-stream source is touched, which is protected by a
+		 * mutex, so this may run concurrently to the router entrypoint.
+		 *
+		 * \return  false if the packet couldn't be sent
+		 */
+		bool transmit(Domain_transmitter::Job const &job);
+
+		/**
+		 * Signal the packet-stream peer about all pending stream conditions
+		 */
+		void wakeup_peer();
+
 		Link_list &dissolved_links(L3_protocol const protocol);
 
 		Link_list &links(L3_protocol const protocol);
@@ -13,6 +13,8 @@
 
 /* Genode includes */
 #include <net/tcp.h>
+#include <util/construct_at.h>
+#include <util/misc_math.h>
 
 /* local includes */
 #include <link.h>
@@ -39,9 +41,21 @@ bool Link_side_id::operator == (Link_side_id const &id) const
 }
 
 
-bool Link_side_id::operator > (Link_side_id const &id) const
+uint32_t Link_side_id::hash() const
 {
-	return memcmp(id.data_base(), data_base(), data_size()) > 0;
+	/*
+	 * Multiplicative hashing of the three 32-bit words of the ID, the
+	 * caller is expected to use the most significant bits of the result
+	 */
+	enum : uint32_t { GOLDEN_RATIO = 0x9e3779b1 };
+	static_assert(data_size() == 3 * sizeof(uint32_t), "unexpected ID size");
+
+	uint32_t words[3];
+	memcpy(words, data_base(), data_size());
+	uint32_t result { words[0] * GOLDEN_RATIO };
+	result = (result ^ words[1]) * GOLDEN_RATIO;
+	result = (result ^ words[2]) * GOLDEN_RATIO;
+	return result;
 }
 
 
@@ -62,44 +76,73 @@ Link_side::Link_side(Domain             &domain,
 }
 
 
-Link_side const &Link_side::find_by_id(Link_side_id const &id) const
+void Link_side::print(Output &output) const
 {
-	if (id == _id) {
-		return *this; }
+	Genode::print(output, "src ", src_ip(), ":", src_port(),
+	                     " dst ", dst_ip(), ":", dst_port());
+}
 
-	bool const side = id > _id;
-	Link_side *const link_side = Avl_node<Link_side>::child(side);
-	if (!link_side) {
-		throw Link_side_tree::No_match(); }
 
-	return link_side->find_by_id(id);
+bool Link_side::is_client() const
+{
+	return this == &_link.client();
 }
 
 
-void Link_side::print(Output &output) const
+/*********************
+ ** Link_side_table **
+ *********************/
+
+static unsigned nr_of_buckets_log2(unsigned long nr_of_buckets)
 {
-	Genode::print(output, "src ", src_ip(), ":", src_port(),
-	                     " dst ", dst_ip(), ":", dst_port());
+	nr_of_buckets = min(max(nr_of_buckets, 2UL),
+	                    (unsigned long)Link_side_table::MAX_NR_OF_BUCKETS);
+
+	unsigned const result = (unsigned)log2(nr_of_buckets);
+	return (1UL << result) < nr_of_buckets ? result + 1 : result;
 }
 
 
-bool Link_side::is_client() const
+Link_side_table::Bucket *Link_side_table::_alloc_buckets()
 {
-	return this == &_link.client();
+	Bucket *buckets = (Bucket *)_alloc.alloc(_buckets_size());
+	for (unsigned long i = 0; i < 1UL << _nr_of_buckets_log2; i++)
+		construct_at<Bucket>(&buckets[i]);
+
+	return buckets;
 }
 
 
-/********************
- ** Link_side_tree **
- ********************/
+Link_side_table::Link_side_table(Allocator &alloc, unsigned long nr_of_buckets)
+:
+	_alloc              { alloc },
+	_nr_of_buckets_log2 { nr_of_buckets_log2(nr_of_buckets) },
+	_buckets            { _alloc_buckets() }
+{ }
+
+
+Link_side_table::~Link_side_table()
+{
+	_alloc.free(_buckets, _buckets_size());
+}
+
 
-Link_side const &Link_side_tree::find_by_id(Link_side_id const &id) const
+Link_side const &Link_side_table::find_by_id(Link_side_id const &id)
 {
-	Link_side *const link_side = first();
-	if (!link_side) {
-		throw No_match(); }
+	Genode::List<Link_side> &bucket { _bucket(id) };
+	for (Link_side *side = bucket.first(); side; side = side->next()) {
 
-	return link_side->find_by_id(id);
+		if (!(side->_id == id)) {
+			continue; }
+
+		/* move to front in order to speed up successive lookups */
+		if (side != bucket.first()) {
+			bucket.remove(side);
+			bucket.insert(side);
+		}
+		return *side;
+	}
+	throw No_match();
 }
 
 
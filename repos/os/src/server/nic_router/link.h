@@ -32,7 +32,6 @@
 
 /* Genode includes */
 #include <timer_session/connection.h>
-#include <util/avl_tree.h>
 #include <util/list.h>
 #include <net/ipv4.h>
 #include <net/port.h>
@@ -53,7 +52,7 @@ namespace Net {
 	class  Interface;
 	class  Link_side_id;
 	class  Link_side;
-	class  Link_side_tree;
+	class  Link_side_table;
 	class  Link;
 	struct Link_list : List<Link> { };
 	class  Tcp_link;
@@ -73,21 +72,23 @@ struct Net::Link_side_id
 
 	void *data_base() const { return (void *)&src_ip; }
 
+	Genode::uint32_t hash() const;
+
 
 	/************************
 	 ** Standard operators **
 	 ************************/
 
 	bool operator == (Link_side_id const &id) const;
-
-	bool operator > (Link_side_id const &id) const;
 }
 __attribute__((__packed__));
 
 
-class Net::Link_side : public Genode::Avl_node<Link_side>
+class Net::Link_side : private Genode::List<Link_side>::Element
 {
 	friend class Link;
+	friend class Link_side_table;
+	friend class Genode::List<Link_side>;
 
 	private:
 
@@ -101,18 +102,9 @@ class Net::Link_side : public Genode::Avl_node<Link_side>
 		          Link_side_id const &id,
 		          Link               &link);
 
-		Link_side const &find_by_id(Link_side_id const &id) const;
-
 		bool is_client() const;
 
 
-		/**************
-		 ** Avl_node **
-		 **************/
-
-		bool higher(Link_side *side) { return side->_id > _id; }
-
-
 		/*********
 		 ** Log **
 		 *********/
@@ -133,11 +125,74 @@ class Net::Link_side : public Genode::Avl_node<Link_side>
 };
 
 
-struct Net::Link_side_tree : Genode::Avl_tree<Link_side>
+/**
+ * Hash table for looking up the link side of a packet
+ *
+ * Each bucket is a list of link sides chained through the link objects. Thus,
+ * the memory for the entries is accounted to the session that created the
+ * link and the table itself consists only of the list heads. A lookup moves
+ * the found link side to the front of its bucket, so, the link sides of
+ * active connections are found first.
+ *
+ * The number of buckets is configured per domain via the 'link_buckets'
+ * attribute. The list heads are allocated together with the domain from the
+ * memory of the router and, thus, the table does not grow with the number of
+ * links created by the sessions. The number of link sides per table is
+ * bounded by the quota of these sessions and, for link sides of NAT-ed
+ * traffic, by the port allocator of the NAT rule. The bucket count should be
+ * chosen such that the expected number of links per bucket stays small.
+ * Beyond that, the lookup costs grow linearly with the number of links per
+ * bucket.
+ */
+class Net::Link_side_table
 {
-	struct No_match : Genode::Exception { };
+	public:
+
+		enum { DEFAULT_NR_OF_BUCKETS = 1024, MAX_NR_OF_BUCKETS = 65536 };
+
+	private:
+
+		using Bucket = Genode::List<Link_side>;
+
+		Genode::Allocator &_alloc;
+		unsigned    const  _nr_of_buckets_log2;
+		Bucket     *const  _buckets;
+
+		Genode::size_t _buckets_size() const {
+			return sizeof(Bucket) << _nr_of_buckets_log2; }
+
+		Bucket *_alloc_buckets();
+
+		Bucket &_bucket(Link_side_id const &id)
+		{
+			return _buckets[id.hash() >> (32 - _nr_of_buckets_log2)];
+		}
+
+		/*
+		 * Noncopyable
+		 */
+		Link_side_table(Link_side_table const &);
+		Link_side_table &operator = (Link_side_table const &);
+
+	public:
+
+		struct No_match : Genode::Exception { };
+
+		/**
+		 * Constructor
+		 *
+		 * \param nr_of_buckets  rounded up to a power of two within
+		 *                       [2, MAX_NR_OF_BUCKETS]
+		 */
+		Link_side_table(Genode::Allocator &alloc, unsigned long nr_of_buckets);
+
+		~Link_side_table();
+
+		Link_side const &find_by_id(Link_side_id const &id);
+
+		void insert(Link_side *side) { _bucket(side->_id).insert(side); }
 
-	Link_side const &find_by_id(Link_side_id const &id) const;
+		void remove(Link_side *side) { _bucket(side->_id).remove(side); }
 };
 
 
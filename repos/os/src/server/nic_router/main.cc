@@ -35,13 +35,15 @@ class Net::Main
 		Genode::Env                    &_env;
 		Quota                           _shared_quota        { };
 		Interface_list                  _interfaces          { };
+		Wakeup_batch                    _wakeup_batch        { };
+		Domain_transmitter_pool         _transmitters        { _env };
 		Timer::Connection               _timer               { _env };
 		Genode::Heap                    _heap                { &_env.ram(), &_env.rm() };
 		Genode::Attached_rom_dataspace  _config_rom          { _env, "config" };
 		Reference<Configuration>        _config              { *new (_heap) Configuration { _config_rom.xml(), _heap } };
 		Signal_handler<Main>            _config_handler      { _env.ep(), *this, &Main::_handle_config };
-		Nic_session_root                _nic_session_root    { _env, _timer, _heap, _config(), _shared_quota, _interfaces };
-		Uplink_session_root             _uplink_session_root { _env, _timer, _heap, _config(), _shared_quota, _interfaces };
+		Nic_session_root                _nic_session_root    { _env, _timer, _heap, _config(), _shared_quota, _interfaces, _wakeup_batch };
+		Uplink_session_root             _uplink_session_root { _env, _timer, _heap, _config(), _shared_quota, _interfaces, _wakeup_batch };
 
 		void _handle_config();
 
@@ -78,20 +80,25 @@ void Net::Main::_handle_config()
 	_config().stop_reporting();
 
 	_config_rom.update();
-	Configuration &old_config = _config();
-	Configuration &new_config = *new (_heap)
-		Configuration(_env, _config_rom.xml(), _heap, _timer, old_config,
-		              _shared_quota, _interfaces);
 
-	_nic_session_root.handle_config(new_config);
-	_uplink_session_root.handle_config(new_config);
-	_for_each_interface([&] (Interface &intf) { intf.handle_config_1(new_config); });
-	_for_each_interface([&] (Interface &intf) { intf.handle_config_2(); });
-	_config = Reference<Configuration>(new_config);
-	_for_each_interface([&] (Interface &intf) { intf.handle_config_3(); });
+	/* signal each packet-stream peer at most once for the whole update */
+	_wakeup_batch.apply([&] () {
 
-	destroy(_heap, &old_config);
+		Configuration &old_config = _config();
+		Configuration &new_config = *new (_heap)
+			Configuration(_env, _config_rom.xml(), _heap, _timer, old_config,
+			              _shared_quota, _interfaces, _wakeup_batch,
+			              _transmitters);
 
+		_nic_session_root.handle_config(new_config);
+		_uplink_session_root.handle_config(new_config);
+		_for_each_interface([&] (Interface &intf) { intf.handle_config_1(new_config); });
+		_for_each_interface([&] (Interface &intf) { intf.handle_config_2(); });
+		_config = Reference<Configuration>(new_config);
+		_for_each_interface([&] (Interface &intf) { intf.handle_config_3(); });
+
+		destroy(_heap, &old_config);
+	});
 	_config().start_reporting();
 }
 
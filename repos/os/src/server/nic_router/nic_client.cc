@@ -52,6 +52,7 @@ Net::Nic_client::Nic_client(Xml_node    const &node,
                             Env               &env,
                             Timer::Connection &timer,
                             Interface_list    &interfaces,
+                            Wakeup_batch      &wakeup_batch,
                             Configuration     &config)
 :
 	Nic_client_base { node },
@@ -74,8 +75,9 @@ Net::Nic_client::Nic_client(Xml_node    const &node,
 
 		try {
 			_interface = *new (_alloc)
-				Nic_client_interface { env, timer, alloc, interfaces, config,
-				                       domain(), label() };
+				Nic_client_interface { env, timer, alloc, interfaces,
+				                       wakeup_batch, config, domain(),
+				                       label() };
 		}
 		catch (Insufficient_ram_quota) { _invalid("NIC session RAM quota"); }
 		catch (Insufficient_cap_quota) { _invalid("NIC session CAP quota"); }
@@ -148,18 +150,19 @@ Net::Nic_client_interface::Nic_client_interface(Env                 &env,
                                                 Timer::Connection   &timer,
                                                 Genode::Allocator   &alloc,
                                                 Interface_list      &interfaces,
+                                                Wakeup_batch        &wakeup_batch,
                                                 Configuration       &config,
                                                 Domain_name   const &domain_name,
                                                 Session_label const &label)
 :
 	Nic_client_interface_base   { domain_name, label, _session_link_state },
-	Nic::Packet_allocator       { &alloc },
+	Nic::Buddy_packet_allocator { &alloc },
 	Nic::Connection             { env, this, BUF_SIZE, BUF_SIZE, label.string() },
 	_session_link_state_handler { env.ep(), *this,
 	                              &Nic_client_interface::_handle_session_link_state },
 	_interface                  { env.ep(), timer, mac_address(), alloc,
-	                              Mac_address(), config, interfaces, *rx(), *tx(),
-	                              *this }
+	                              Mac_address(), config, interfaces,
+	                              wakeup_batch, *rx(), *tx(), *this }
 {
 	/* install packet stream signal handlers */
 	rx_channel()->sigh_packet_avail(_interface.pkt_stream_signal_handler());
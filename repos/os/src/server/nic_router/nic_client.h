@@ -87,6 +87,7 @@ class Net::Nic_client : public  Nic_client_base,
 		           Genode::Env            &env,
 		           Timer::Connection      &timer,
 		           Interface_list         &interfaces,
+		           Wakeup_batch           &wakeup_batch,
 		           Configuration          &config);
 
 		~Nic_client();
@@ -139,13 +140,13 @@ class Net::Nic_client_interface_base : public Interface_policy
 
 
 class Net::Nic_client_interface : public Nic_client_interface_base,
-                                  public Nic::Packet_allocator,
+                                  public Nic::Buddy_packet_allocator,
                                   public Nic::Connection
 {
 	private:
 
 		enum {
-			PKT_SIZE = Nic::Packet_allocator::DEFAULT_PACKET_SIZE,
+			PKT_SIZE = Nic::Buddy_packet_allocator::DEFAULT_PACKET_SIZE,
 			BUF_SIZE = Nic::Session::QUEUE_SIZE * PKT_SIZE,
 		};
 
@@ -163,6 +164,7 @@ class Net::Nic_client_interface : public Nic_client_interface_base,
 		                     Timer::Connection           &timer,
 		                     Genode::Allocator           &alloc,
 		                     Interface_list              &interfaces,
+		                     Wakeup_batch                &wakeup_batch,
 		                     Configuration               &config,
 		                     Domain_name           const &domain_name,
 		                     Genode::Session_label const &label);
@@ -239,6 +239,7 @@ Nic_session_component(Session_env                    &session_env,
                       Mac_address              const &router_mac,
                       Session_label            const &label,
                       Interface_list                 &interfaces,
+                      Wakeup_batch                   &wakeup_batch,
                       Configuration                  &config,
                       Ram_dataspace_capability const  ram_ds)
 :
@@ -247,8 +248,9 @@ Nic_session_component(Session_env                    &session_env,
 	                             &_packet_alloc, _session_env.ep().rpc_ep() },
 	_interface_policy          { label, _session_env, config },
 	_interface                 { _session_env.ep(), timer, router_mac, _alloc,
-	                             mac, config, interfaces, *_tx.sink(),
-	                             *_rx.source(), _interface_policy },
+	                             mac, config, interfaces, wakeup_batch,
+	                             *_tx.sink(), *_rx.source(),
+	                             _interface_policy },
 	_ram_ds                    { ram_ds }
 {
 	_interface.attach_to_domain();
@@ -281,7 +283,8 @@ Net::Nic_session_root::Nic_session_root(Env               &env,
                                         Allocator         &alloc,
                                         Configuration     &config,
                                         Quota             &shared_quota,
-                                        Interface_list    &interfaces)
+                                        Interface_list    &interfaces,
+                                        Wakeup_batch      &wakeup_batch)
 :
 	Root_component<Nic_session_component> { &env.ep().rpc_ep(), &alloc },
 	_env                                  { env },
@@ -290,7 +293,8 @@ Net::Nic_session_root::Nic_session_root(Env               &env,
 	_router_mac                           { _mac_alloc.alloc() },
 	_config                               { config },
 	_shared_quota                         { shared_quota },
-	_interfaces                           { interfaces }
+	_interfaces                           { interfaces },
+	_wakeup_batch                         { wakeup_batch }
 { }
 
 
@@ -322,7 +326,7 @@ Nic_session_component *Net::Nic_session_root::_create_session(char const *args)
 						Arg_string::find_arg(args, "tx_buf_size").ulong_value(0),
 						Arg_string::find_arg(args, "rx_buf_size").ulong_value(0),
 						_timer, mac, _router_mac, label, _interfaces,
-						_config(), ram_ds);
+						_wakeup_batch, _config(), ram_ds);
 				}
 				catch (Out_of_ram) {
 					_mac_alloc.free(mac);
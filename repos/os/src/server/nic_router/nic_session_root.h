@@ -137,6 +137,7 @@ class Net::Nic_session_component : private Nic_session_component_base,
 		                      Mac_address                      const &router_mac,
 		                      Genode::Session_label            const &label,
 		                      Interface_list                         &interfaces,
+		                      Wakeup_batch                           &wakeup_batch,
 		                      Configuration                          &config,
 		                      Genode::Ram_dataspace_capability const  ram_ds);
 
@@ -175,6 +176,7 @@ class Net::Nic_session_root
 		Reference<Configuration>  _config;
 		Quota                    &_shared_quota;
 		Interface_list           &_interfaces;
+		Wakeup_batch             &_wakeup_batch;
 
 		void _invalid_downlink(char const *reason);
 
@@ -193,7 +195,8 @@ class Net::Nic_session_root
 		                 Genode::Allocator &alloc,
 		                 Configuration     &config,
 		                 Quota             &shared_quota,
-		                 Interface_list    &interfaces);
+		                 Interface_list    &interfaces,
+		                 Wakeup_batch      &wakeup_batch);
 
 		void handle_config(Configuration &config) { _config = Reference<Configuration>(config); }
 };
@@ -0,0 +1,181 @@
+/*
+ * \brief  Path-compressed binary trie for IPv4 longest-prefix matching
+ * \author Martin Stein
+ * \date   2022-06-20
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _PREFIX_TRIE_H_
+#define _PREFIX_TRIE_H_
+
+/* local includes */
+#include <ipv4_address_prefix.h>
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <util/noncopyable.h>
+
+namespace Net { template <typename> class Prefix_trie; }
+
+
+/**
+ * Maps IPv4 address prefixes to objects of type T
+ *
+ * Each node stores a prefix that is a real prefix of the prefixes of all
+ * nodes in its sub-trie. Nodes that do not correspond to an inserted prefix
+ * exist only where two branches diverge. Thus, there are at most two nodes
+ * per inserted prefix and a lookup takes at most 33 steps independent of
+ * the number of entries.
+ */
+template <typename T>
+class Net::Prefix_trie : Genode::Noncopyable
+{
+	private:
+
+		struct Node
+		{
+			Genode::uint32_t const  key;
+			Genode::uint8_t  const  prefix;
+			T                const *value    { nullptr };
+			Node                   *child[2] { nullptr, nullptr };
+
+			Node(Genode::uint32_t key,
+			     Genode::uint8_t  prefix,
+			     T const         *value)
+			:
+				key(key), prefix(prefix), value(value)
+			{ }
+		};
+
+		Node *_root { nullptr };
+
+		static Genode::uint32_t _mask(Genode::uint8_t prefix)
+		{
+			return prefix ? ~(Genode::uint32_t)0 << (32 - prefix) : 0;
+		}
+
+		static unsigned _bit(Genode::uint32_t key, Genode::uint8_t idx)
+		{
+			return (key >> (31 - idx)) & 1;
+		}
+
+		static Genode::uint8_t _common_prefix(Genode::uint32_t key_1,
+		                                      Genode::uint32_t key_2,
+		                                      Genode::uint8_t  max)
+		{
+			Genode::uint32_t const diff = key_1 ^ key_2;
+			if (!diff) {
+				return max; }
+
+			Genode::uint8_t const common = (Genode::uint8_t)__builtin_clz(diff);
+			return common < max ? common : max;
+		}
+
+		static void _destroy(Genode::Deallocator &dealloc, Node *node)
+		{
+			if (!node) {
+				return; }
+
+			_destroy(dealloc, node->child[0]);
+			_destroy(dealloc, node->child[1]);
+			destroy(dealloc, node);
+		}
+
+	public:
+
+		/**
+		 * Map 'prefix' to 'value'
+		 *
+		 * If the prefix is already present, the former value gets replaced.
+		 */
+		void insert(Ipv4_address_prefix const &prefix,
+		            T                   const &value,
+		            Genode::Allocator         &alloc)
+		{
+			Genode::uint32_t const key {
+				prefix.address.to_uint32_little_endian() &
+				_mask(prefix.prefix) };
+
+			Node **slot { &_root };
+			while (Node *node = *slot) {
+
+				Genode::uint8_t const common {
+					_common_prefix(key, node->key,
+					               node->prefix < prefix.prefix ?
+					               node->prefix : prefix.prefix) };
+
+				if (common == node->prefix) {
+
+					/* the node prefix covers the new prefix */
+					if (common == prefix.prefix) {
+						node->value = &value;
+						return;
+					}
+					slot = &node->child[_bit(key, common)];
+					continue;
+				}
+				/*
+				 * The new prefix is shorter than the node prefix or both
+				 * diverge. Allocate everything before modifying the trie
+				 * so that a failed allocation leaves the trie intact.
+				 */
+				if (common == prefix.prefix) {
+
+					Node &parent { *new (alloc) Node(key, common, &value) };
+					parent.child[_bit(node->key, common)] = node;
+					*slot = &parent;
+					return;
+				}
+				Node &leaf { *new (alloc) Node(key, prefix.prefix, &value) };
+				Node *parent_ptr { nullptr };
+				try { parent_ptr = new (alloc) Node(key & _mask(common), common, nullptr); }
+				catch (...) {
+					destroy(alloc, &leaf);
+					throw;
+				}
+				Node &parent { *parent_ptr };
+				parent.child[_bit(node->key, common)] = node;
+				parent.child[_bit(key, common)] = &leaf;
+				*slot = &parent;
+				return;
+			}
+			*slot = new (alloc) Node(key, prefix.prefix, &value);
+		}
+
+		/**
+		 * Return the value of the longest prefix matching 'ip' or nullptr
+		 */
+		T const *longest_prefix_match(Ipv4_address const &ip) const
+		{
+			Genode::uint32_t const key { ip.to_uint32_little_endian() };
+			T const *match { nullptr };
+			for (Node const *node = _root; node; ) {
+
+				if ((key & _mask(node->prefix)) != node->key) {
+					break; }
+
+				if (node->value) {
+					match = node->value; }
+
+				if (node->prefix == 32) {
+					break; }
+
+				node = node->child[_bit(key, node->prefix)];
+			}
+			return match;
+		}
+
+		void destroy_nodes(Genode::Deallocator &dealloc)
+		{
+			_destroy(dealloc, _root);
+			_root = nullptr;
+		}
+};
+
+#endif /* _PREFIX_TRIE_H_ */
@@ -0,0 +1,86 @@
+/*
+ * \brief  Lock-free queue with a single producer and a single consumer
+ * \author Martin Stein
+ * \date   2022-06-22
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+/* Genode includes */
+#include <util/noncopyable.h>
+
+namespace Net { template <typename, unsigned> class Spsc_queue; }
+
+
+/**
+ * Ring buffer of 2^CAPACITY_LOG2 elements of type T
+ *
+ * Each counter is written by only one side, so the only synchronization
+ * needed is that an element gets published by the producer with release
+ * semantics and observed by the consumer with acquire semantics (and vice
+ * versa for freed slots).
+ */
+template <typename T, unsigned CAPACITY_LOG2>
+class Net::Spsc_queue : Genode::Noncopyable
+{
+	private:
+
+		enum : unsigned long {
+			CAPACITY = 1UL << CAPACITY_LOG2,
+			MASK     = CAPACITY - 1,
+		};
+
+		T             _slots[CAPACITY] { };
+		unsigned long _head            { 0 };
+		unsigned long _tail            { 0 };
+
+	public:
+
+		/**
+		 * Append 'elem', must be called by the producer only
+		 *
+		 * \return  false if the queue is full
+		 */
+		bool try_enqueue(T const &elem)
+		{
+			unsigned long const head { _head };
+			if (head - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE) == CAPACITY) {
+				return false; }
+
+			_slots[head & MASK] = elem;
+			__atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
+			return true;
+		}
+
+		/**
+		 * Remove the oldest element, must be called by the consumer only
+		 *
+		 * \return  false if the queue is empty
+		 */
+		bool try_dequeue(T &elem)
+		{
+			unsigned long const tail { _tail };
+			if (__atomic_load_n(&_head, __ATOMIC_ACQUIRE) == tail) {
+				return false; }
+
+			elem = _slots[tail & MASK];
+			__atomic_store_n(&_tail, tail + 1, __ATOMIC_RELEASE);
+			return true;
+		}
+
+		bool empty() const
+		{
+			return __atomic_load_n(&_head, __ATOMIC_ACQUIRE) ==
+			       __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+		}
+};
+
+#endif /* _SPSC_QUEUE_H_ */
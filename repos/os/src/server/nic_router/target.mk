@@ -29,6 +29,8 @@ SRC_CC += \
 	xml_node.cc \
 	uplink_session_root.cc \
 	communication_buffer.cc \
+	wakeup_batch.cc \
+	domain_transmitter.cc \
 
 INC_DIR += $(PRG_DIR)
 
@@ -0,0 +1,59 @@
+/*
+ * \brief  Coalesce the wakeups of packet-stream peers per batch of packets
+ * \author Martin Stein
+ * \date   2022-03-14
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* local includes */
+#include <wakeup_batch.h>
+#include <interface.h>
+
+using namespace Net;
+
+
+void Wakeup_batch::_wakeup_deferred()
+{
+	while (Wakeup_batch_list_element *le = _deferred.first()) {
+		_deferred.remove(le);
+		le->object()->wakeup_peer();
+	}
+}
+
+
+void Wakeup_batch::hand_off(Domain_transmitter            &transmitter,
+                            Domain_transmitter::Job const &job)
+{
+	transmitter._submit(job);
+	if (!transmitter._in_batch) {
+		transmitter._in_batch = true;
+		_handoffs.insert(&transmitter._batch_le);
+	}
+}
+
+
+void Wakeup_batch::_join_transmitters()
+{
+	while (Domain_transmitter_list_element *le = _handoffs.first()) {
+		_handoffs.remove(le);
+		Domain_transmitter &transmitter { *le->object() };
+		transmitter._in_batch = false;
+		_failed += transmitter._join();
+	}
+}
+
+
+unsigned long Wakeup_batch::join_handoffs()
+{
+	_join_transmitters();
+
+	unsigned long const failed { _failed };
+	_failed = 0;
+	return failed;
+}
@@ -0,0 +1,112 @@
+/*
+ * \brief  Coalesce the wakeups of packet-stream peers per batch of packets
+ * \author Martin Stein
+ * \date   2022-03-14
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _WAKEUP_BATCH_H_
+#define _WAKEUP_BATCH_H_
+
+/* local includes */
+#include <domain_transmitter.h>
+
+/* Genode includes */
+#include <util/list.h>
+#include <util/noncopyable.h>
+
+namespace Net {
+
+	class Interface;
+	class Wakeup_batch;
+	using Wakeup_batch_list_element = Genode::List_element<Interface>;
+}
+
+
+/**
+ * While a batch is active, interfaces don't signal their packet-stream peers
+ * on each packet that they submit or acknowledge. Instead, they get
+ * remembered and each of them signals its peers only once at the end of the
+ * batch.
+ *
+ * Furthermore, the batch keeps track of the transmitters that jobs were
+ * handed to and joins them at the latest when the batch ends.
+ */
+class Net::Wakeup_batch : Genode::Noncopyable
+{
+	private:
+
+		Genode::List<Wakeup_batch_list_element>       _deferred { };
+		Genode::List<Domain_transmitter_list_element> _handoffs { };
+		bool                                          _active   { false };
+		unsigned long                                 _failed   { 0 };
+
+		void _wakeup_deferred();
+
+		/**
+		 * Join all transmitters that received jobs during the batch
+		 *
+		 * Failed jobs are accumulated in '_failed' until the next call of
+		 * 'join_handoffs' reports them.
+		 */
+		void _join_transmitters();
+
+	public:
+
+		/**
+		 * Call 'functor' with wakeups deferred until it returned
+		 *
+		 * Nested calls are part of the outermost batch.
+		 */
+		template <typename FUNC>
+		void apply(FUNC && functor)
+		{
+			if (_active) {
+				functor();
+				return;
+			}
+			struct Guard
+			{
+				Wakeup_batch &batch;
+
+				Guard(Wakeup_batch &batch) : batch(batch) { batch._active = true; }
+
+				~Guard()
+				{
+					batch._join_transmitters();
+					batch._active = false;
+					batch._wakeup_deferred();
+				}
+			} guard { *this };
+
+			functor();
+		}
+
+		bool active() const { return _active; }
+
+		void defer(Wakeup_batch_list_element &le) { _deferred.insert(&le); }
+
+		void withdraw(Wakeup_batch_list_element &le) { _deferred.remove(&le); }
+
+		/**
+		 * Pass 'job' to 'transmitter', only allowed while the batch is active
+		 */
+		void hand_off(Domain_transmitter            &transmitter,
+		              Domain_transmitter::Job const &job);
+
+		/**
+		 * Wait until all jobs that were handed off are completed
+		 *
+		 * \return  number of jobs that failed, including those of earlier
+		 *          batches that were not reported yet
+		 */
+		unsigned long join_handoffs();
+};
+
+#endif /* _WAKEUP_BATCH_H_ */
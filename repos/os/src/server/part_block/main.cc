@@ -19,7 +19,9 @@
 #include <base/heap.h>
 #include <block_session/rpc_object.h>
 #include <block/request_stream.h>
+#include <os/packet_stream_window.h>
 #include <os/session_policy.h>
+#include <timer_session/connection.h>
 #include <util/bit_allocator.h>
 
 #include "gpt.h"
@@ -27,6 +29,7 @@
 
 namespace Block {
 	class  Session_component;
+	class  Session_buffer;
 	struct Session_handler;
 	struct Dispatch;
 	class  Main;
@@ -75,16 +78,90 @@ struct Block::Dispatch : Interface
 };
 
 
+/**
+ * Communication buffer of a client session
+ *
+ * In zero-copy mode, the buffer shares its payload with the packet-stream
+ * buffer of the back-end session. Hence, a request can be passed to the back
+ * end without copying its payload.
+ */
+class Block::Session_buffer : Noncopyable
+{
+	public:
+
+		using Window_unavailable = Packet_stream_window::Window_unavailable;
+
+	private:
+
+		Env &_env;
+
+		Constructible<Packet_stream_window> _window { };
+
+		Ram_dataspace_capability const _ram;
+
+		Ram_dataspace_capability _alloc_ram(size_t size, bool shared)
+		{
+			return shared ? Ram_dataspace_capability()
+			              : _env.ram().alloc(align_addr(size, 12));
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param block_ds    packet-stream buffer of the back end, or an
+		 *                    invalid capability to not share the payload
+		 * \param align_log2  alignment of the window in the back-end buffer
+		 *
+		 * \throw Window_unavailable
+		 */
+		Session_buffer(Env &env, Range_allocator &block_alloc, size_t size,
+		               Dataspace_capability block_ds, unsigned align_log2)
+		:
+			_env(env), _ram(_alloc_ram(size, block_ds.valid()))
+		{
+			if (block_ds.valid())
+				_window.construct(env, block_alloc, block_ds, size,
+				                  Packet_stream_window::queues_size<Session::Tx_policy>(),
+				                  align_log2);
+		}
+
+		~Session_buffer()
+		{
+			if (_ram.valid())
+				_env.ram().free(_ram);
+		}
+
+		Dataspace_capability ds()
+		{
+			if (shared())
+				return _window->dataspace();
+
+			return _ram;
+		}
+
+		bool shared() const { return _window.constructed(); }
+
+		/**
+		 * Window into the back-end buffer, valid if 'shared' returns true
+		 */
+		Packet_stream_window       &window()       { return *_window; }
+		Packet_stream_window const &window() const { return *_window; }
+};
+
+
 struct Block::Session_handler : Interface
 {
-	Env                   &env;
-	Attached_ram_dataspace ds;
+	Env           &env;
+	Session_buffer buffer;
 
 	Signal_handler<Session_handler> request_handler
 	  { env.ep(), *this, &Session_handler::handle };
 
-	Session_handler(Env &env, size_t buffer_size)
-	: env(env), ds(env.ram(), env.rm(), buffer_size)
+	Session_handler(Env &env, Range_allocator &block_alloc, size_t buffer_size,
+	                Dataspace_capability block_ds, unsigned align_log2)
+	: env(env), buffer(env, block_alloc, buffer_size, block_ds, align_log2)
 	{ }
 
 	virtual void handle_requests()= 0;
@@ -109,11 +186,18 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 
 		bool syncing { false };
 
-		Session_component(Env &env, long number, size_t buffer_size,
-		                  Session::Info info, Dispatch &dispatcher)
-		: Session_handler(env, buffer_size),
-		  Request_stream(env.rm(), ds.cap(), env.ep(), request_handler, info),
-		  _number(number), _dispatcher(dispatcher)
+		Scheduler::Client client;
+
+		Session_component(Env &env, long number, Range_allocator &block_alloc,
+		                  size_t buffer_size, Dataspace_capability block_ds,
+		                  Session::Info info, Dispatch &dispatcher,
+		                  Scheduler &scheduler, Session_label const &label,
+		                  Scheduler::Policy const &policy)
+		: Session_handler(env, block_alloc, buffer_size, block_ds,
+		                  (unsigned)info.align_log2),
+		  Request_stream(env.rm(), buffer.ds(), env.ep(), request_handler, info),
+		  _number(number), _dispatcher(dispatcher),
+		  client(scheduler, label, policy)
 		{
 			env.ep().manage(*this);
 		}
@@ -129,7 +213,7 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 
 		long number() const { return _number; }
 
-		bool acknowledge(Request &request)
+		bool acknowledge(Request const &request)
 		{
 			bool progress = false;
 			try_acknowledge([&] (Ack &ack) {
@@ -219,6 +303,21 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			_config.xml().attribute_value("io_buffer",
 			                              Number_of_bytes(4*1024*1024));
 
+		/*
+		 * Share the payload of client requests with the back end
+		 */
+		bool const _zero_copy = _config.xml().attribute_value("zero_copy", false);
+
+		/*
+		 * Number of batches of the request scheduler in flight at the back end
+		 */
+		unsigned const _queue_depth =
+			max(_config.xml().attribute_value("queue_depth", 32u), 1u);
+
+		Number_of_bytes const _max_transfer =
+			_config.xml().attribute_value("max_transfer",
+			                              Number_of_bytes(1024*1024));
+
 		Allocator_avl           _block_alloc { &_heap };
 		Block_connection        _block    { _env, &_block_alloc, _io_buffer_size };
 		Io_signal_handler<Main> _io_sigh  { _env.ep(), *this, &Main::_handle_io };
@@ -231,6 +330,148 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 		Job_queue<128>       _job_queue { };
 		Registry<Block::Job> _job_registry { };
 
+		Scheduler _scheduler { _block.info().block_size,
+		                       _max_transfer / _block.info().block_size };
+
+		/*
+		 * Window of a closed zero-copy session with jobs still in flight
+		 */
+		struct Retained_window
+		{
+			Packet_stream_window::Window const window;
+			unsigned long          const client;  /* scheduler client ID */
+			unsigned                     in_flight;
+
+			Retained_window(Packet_stream_window::Window window,
+			                unsigned long client, unsigned in_flight)
+			: window(window), client(client), in_flight(in_flight) { }
+
+			virtual ~Retained_window() { }
+		};
+
+		Registry<Registered<Retained_window> > _retained_windows { };
+
+		/*
+		 * The timer is only needed for deadlines and the scheduler statistics
+		 */
+		Constructible<Timer::Connection>             _timer { };
+		Constructible<Timer::Periodic_timeout<Main>> _report_timeout { };
+		Constructible<Expanding_reporter>            _scheduler_reporter { };
+
+		Scheduler::time_us_t _now()
+		{
+			return _timer.constructed() ? _timer->curr_time().trunc_to_plain_us().value : 0;
+		}
+
+		void _report_scheduler(Duration)
+		{
+			_scheduler_reporter->generate([&] (Xml_generator &xml) {
+				_scheduler.report(xml); });
+		}
+
+		void _init_scheduler()
+		{
+			Xml_node const config = _config.xml();
+
+			bool deadlines = false;
+			config.for_each_sub_node([&] (Xml_node const &node) {
+				if (node.has_type("policy") || node.has_type("default-policy"))
+					deadlines |= node.has_attribute("deadline_ms"); });
+
+			bool report = false;
+			config.with_sub_node("report", [&] (Xml_node const &node) {
+				report = node.attribute_value("scheduler", false); });
+
+			if (deadlines || report)
+				_timer.construct(_env);
+
+			if (report) {
+				_scheduler_reporter.construct(_env, "scheduler", "scheduler");
+				_report_timeout.construct(*_timer, *this, &Main::_report_scheduler,
+				                          Microseconds { 1000*1000 });
+			}
+		}
+
+		/**
+		 * Return session a job belongs to, or nullptr for an orphan job
+		 */
+		Session_component *_session(Job const &job)
+		{
+			Session_component *session = _sessions[job.number];
+
+			if (session && job.batch.segments && session->client.id() != job.batch.client)
+				return nullptr;
+
+			return session;
+		}
+
+		/**
+		 * Account the completion of a job that accessed a shared window
+		 */
+		void _release_window(Job const &job)
+		{
+			Session_component *session = _session(job);
+			if (session) {
+				if (session->buffer.shared())
+					session->buffer.window().release();
+				return;
+			}
+
+			_retained_windows.for_each([&] (Registered<Retained_window> &retained) {
+				if (retained.client != job.batch.client || --retained.in_flight)
+					return;
+
+				retained.window.free(_block_alloc);
+				destroy(_heap, &retained);
+			});
+		}
+
+		/**
+		 * Pass queued requests to the back end
+		 */
+		void _schedule()
+		{
+			auto issue = [&] (Scheduler::Batch const &batch) {
+
+				long number = -1;
+				for (long i = 0; i < MAX_SESSIONS && number < 0; i++)
+					if (_sessions[i] && _sessions[i]->client.id() == batch.client)
+						number = i;
+
+				if (number < 0)
+					return false;
+
+				addr_t index = 0;
+				try {
+					index = _job_queue.alloc();
+				} catch (...) { return false; }
+
+				Partition      &partition = _partition_table.partition(number);
+				Session_buffer &buffer    = _sessions[number]->buffer;
+				Request const   request   { batch.operation, false, batch.offset, { 0 } };
+
+				_job_queue.with_job(index, [&](Job_object &job) {
+
+					Operation op     = batch.operation;
+					op.block_number += partition.lba;
+
+					if (buffer.shared()) {
+						job.construct(_block, op, _job_registry, index, number, request,
+						              Job::Buffer_offset { buffer.window().peer_offset(batch.offset) });
+						buffer.window().acquire();
+					} else
+						job.construct(_block, op, _job_registry, index, number, request,
+						              batch.cookie);
+
+					job->batch = batch;
+				});
+				return true;
+			};
+
+			while (_scheduler.in_flight() < _queue_depth
+			    && _scheduler.dispatch(_now(), issue));
+		}
+
 		unsigned _wake_up_index { 0 };
 
 		void _wakeup_clients()
@@ -291,6 +532,8 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 		{
 			_block.sigh(_io_sigh);
 
+			_init_scheduler();
+
 			/* announce at parent */
 			env.parent().announce(env.ep().manage(*this));
 		}
@@ -306,6 +549,8 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			long num = -1;
 			bool writeable = false;
 
+			Scheduler::Policy scheduler_policy { };
+
 			Session_label const label = label_from_args(args.string());
 			try {
 				Session_policy policy(label, _config.xml());
@@ -316,6 +561,8 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				/* sessions are not writeable by default */
 				writeable = policy.attribute_value("writeable", false);
 
+				scheduler_policy = Scheduler::Policy::from_xml(policy);
+
 			} catch (Xml_node::Nonexistent_attribute) {
 				error("policy does not define partition number for for '",
 				      label, "'");
@@ -347,9 +594,19 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			if (!tx_buf_size)
 				throw Service_denied();
 
+			/*
+			 * In zero-copy mode, the client pays for the RM session that
+			 * composes its communication buffer
+			 */
+			if (_zero_copy && cap_quota_from_args(args.string()).value
+			                < Session::CAP_QUOTA + Rm_session::CAP_QUOTA)
+				throw Insufficient_cap_quota();
+
+			size_t const rm_size = _zero_copy ? (size_t)Rm_connection::RAM_QUOTA : 0;
+
 			/* delete ram quota by the memory needed for the session */
 			size_t session_size = max((size_t)4096,
-			                          sizeof(Session_component));
+			                          sizeof(Session_component)) + rm_size;
 			if (ram_quota.value < session_size)
 				throw Insufficient_ram_quota();
 
@@ -364,15 +621,34 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				throw Insufficient_ram_quota();
 			}
 
+			/*
+			 * In zero-copy mode, the payload must be page-aligned to map
+			 * the shared window of the back-end buffer.
+			 */
+			size_t const align_log2 = _zero_copy
+			                        ? max((size_t)12, _block.info().align_log2) : 0;
+
 			Session::Info info {
 				.block_size  = _block.info().block_size,
 				.block_count = _partition_table.partition(num).sectors,
-				.align_log2  = 0,
+				.align_log2  = align_log2,
 				.writeable   = writeable,
 			};
 
-			_sessions[num] = new (_heap) Session_component(_env, num, tx_buf_size,
-			                                               info, *this);
+			Dataspace_capability const block_ds =
+				_zero_copy ? _block.tx()->dataspace() : Dataspace_capability();
+
+			try {
+				_sessions[num] = new (_heap)
+					Session_component(_env, num, _block_alloc, tx_buf_size,
+					                  block_ds, info, *this, _scheduler,
+					                  label, scheduler_policy);
+			}
+			catch (Session_buffer::Window_unavailable) {
+				error("back-end buffer exhausted by zero-copy sessions, "
+				      "increase 'io_buffer' for '", label, "'");
+				throw Service_denied();
+			}
 			return _sessions[num]->cap();
 		}
 
@@ -382,6 +658,18 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				if (!_sessions[number] || !(cap == _sessions[number]->cap()))
 					continue;
 
+				/*
+				 * The back end may still access the window of the session,
+				 * keep it allocated until the pending jobs are completed
+				 */
+				Session_component &session = *_sessions[number];
+				if (session.buffer.shared() && session.buffer.window().in_flight())
+					new (_heap)
+						Registered<Retained_window>(_retained_windows,
+						                            session.buffer.window().retain(),
+						                            session.client.id(),
+						                            session.buffer.window().in_flight());
+
 				destroy(_heap, _sessions[number]);
 				_sessions[number] = nullptr;
 
@@ -398,7 +686,7 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 
 		void consume_read_result(Job &job, off_t offset, char const *src, size_t length)
 		{
-			if (!_sessions[job.number]) return;
+			if (!_session(job)) return;
 
 			memcpy((void *)(job.addr + offset), src, length);
 		}
@@ -412,6 +700,11 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 		{
 			job.request.success = success;
 			job.completed       = true;
+
+			if (job.batch.segments) {
+				_release_window(job);
+				_scheduler.completed(job.batch, success, _now());
+			}
 		}
 
 
@@ -419,7 +712,11 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 		 ** Dispatch **
 		 **************/
 
-		void update() override { _block.update_jobs(*this); }
+		void update() override
+		{
+			_schedule();
+			_block.update_jobs(*this);
+		}
 
 		Response submit(long number, Request const &request, addr_t addr) override
 		{
@@ -429,24 +726,25 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			if (last > partition.sectors)
 				return Response::REJECTED;
 
-			addr_t index = 0;
-			try {
-				index  = _job_queue.alloc();
-			} catch (...) { return Response::RETRY; }
+			Session_component &session = *_sessions[number];
 
-			_job_queue.with_job(index, [&](Job_object &job) {
+			size_t const size = request.operation.count * _block.info().block_size;
 
-				Operation op     = request.operation;
-				op.block_number += partition.lba;
+			if (session.buffer.shared() && !session.buffer.window().contains(request.offset, size))
+				return Response::REJECTED;
 
-				job.construct(_block, op, _job_registry, index, number, request, addr);
-			});
+			if (!session.client.submit(request, addr, _now()))
+				return Response::RETRY;
 
 			return Response::ACCEPTED;
 		}
 
 		Response sync(long number, Request const &request) override
 		{
+			/* the sync must not overtake requests still queued */
+			if (_sessions[number]->client.queued())
+				return Response::RETRY;
+
 			addr_t index = 0;
 			try {
 				index = _job_queue.alloc();
@@ -467,8 +765,12 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 
 				addr_t index = job.index;
 
-				/* free orphans */
-				if (!_sessions[job.number]) {
+				/*
+				 * Free orphans and jobs of scheduled requests, the latter are
+				 * acknowledged via the scheduler
+				 */
+				Session_component *session = _session(job);
+				if (!session || job.batch.segments) {
 					_job_queue.free(index);
 					return;
 				}
@@ -476,9 +778,18 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				if (!all && job.number != number)
 					return;
 
-				if (_sessions[job.number]->acknowledge(job.request))
+				if (session->acknowledge(job.request))
 					_job_queue.free(index);
 			});
+
+			for (long i = 0; i < MAX_SESSIONS; i++) {
+				if (!_sessions[i] || (!all && i != number))
+					continue;
+
+				Session_component &session = *_sessions[i];
+				session.client.with_completed([&] (Request const &request) {
+					return session.acknowledge(request); });
+			}
 		}
 };
 
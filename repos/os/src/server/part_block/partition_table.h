@@ -18,6 +18,7 @@
 #include <base/env.h>
 #include <base/log.h>
 #include <base/registry.h>
+#include <block/scheduler.h>
 #include <block_session/connection.h>
 #include <os/reporter.h>
 
@@ -50,6 +51,9 @@ struct Block::Job : public Block_connection::Job
 	addr_t  const addr;                 /* target payload address */
 	bool          completed { false };
 
+	/* requests covered by the job, no segments for a sync job */
+	Scheduler::Batch batch { };
+
 	Job(Block_connection &connection,
 	    Operation         operation,
 	    Registry<Job>    &registry,
@@ -60,6 +64,25 @@ struct Block::Job : public Block_connection::Job
 	: Block_connection::Job(connection, operation),
 	  registry_element(registry, *this),
 	  index(index), number(number), request(request), addr(addr) { }
+
+	/**
+	 * Position of the payload within the back-end packet-stream buffer
+	 */
+	struct Buffer_offset { off_t value; };
+
+	/**
+	 * Constructor of a job whose payload is shared with the client
+	 */
+	Job(Block_connection &connection,
+	    Operation         operation,
+	    Registry<Job>    &registry,
+	    addr_t const      index,
+	    addr_t const      number,
+	    Request           request,
+	    Buffer_offset     offset)
+	: Block_connection::Job(connection, operation, offset.value),
+	  registry_element(registry, *this),
+	  index(index), number(number), request(request), addr(0) { }
 };
 
 
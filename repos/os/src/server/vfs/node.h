@@ -414,6 +414,7 @@ class Vfs_server::Io_node : public Vfs_server::Node,
 				switch (_handle.fs().write(&_handle, src_ptr, length, out_count)) {
 				case Write_result::WRITE_ERR_AGAIN:
 				case Write_result::WRITE_ERR_WOULD_BLOCK:
+				case Write_result::WRITE_QUEUED:
 					break;
 
 				case Write_result::WRITE_ERR_INVALID:
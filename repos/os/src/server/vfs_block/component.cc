@@ -16,6 +16,7 @@
 #include <base/attached_rom_dataspace.h>
 #include <base/component.h>
 #include <base/heap.h>
+#include <base/registry.h>
 #include <block/request_stream.h>
 #include <os/session_policy.h>
 #include <util/string.h>
@@ -45,6 +46,7 @@ struct Vfs_block::File_info
 	File_path const path;
 	bool      const writeable;
 	size_t    const block_size;
+	unsigned  const queue_depth;
 };
 
 
@@ -59,10 +61,14 @@ Vfs_block::File_info Vfs_block::file_info_from_policy(Session_policy const &poli
 	size_t const block_size =
 		policy.attribute_value("block_size", 512u);
 
+	unsigned const queue_depth =
+		max(policy.attribute_value("queue_depth", 8u), 1u);
+
 	return File_info {
-		.path       = file_path,
-		.writeable  = writeable,
-		.block_size = block_size };
+		.path        = file_path,
+		.writeable   = writeable,
+		.block_size  = block_size,
+		.queue_depth = queue_depth };
 }
 
 
@@ -73,10 +79,25 @@ class Vfs_block::File
 		File(const File&) = delete;
 		File& operator=(const File&) = delete;
 
-		Vfs::File_system &_vfs;
-		Vfs::Vfs_handle  *_vfs_handle;
+		Genode::Allocator &_alloc;
+		Vfs::File_system  &_vfs;
+
+		/*
+		 * Each job slot uses a VFS handle of its own as the seek position
+		 * and a queued read are a property of the handle
+		 */
+		struct Slot
+		{
+			Vfs::Vfs_handle &handle;
+
+			Constructible<Vfs_block::Job> job { };
 
-		Constructible<Vfs_block::Job> _job { };
+			Slot(Vfs::Vfs_handle &handle) : handle(handle) { }
+
+			virtual ~Slot() { }
+		};
+
+		Registry<Registered<Slot>> _slots { };
 
 		struct Io_response_handler : Vfs::Io_response_handler
 		{
@@ -95,6 +116,64 @@ class Vfs_block::File
 
 		Block::Session::Info _block_info { };
 
+		void _close_all()
+		{
+			_slots.for_each([&] (Registered<Slot> &slot) {
+				_vfs.close(&slot.handle);
+				destroy(_alloc, &slot);
+			});
+		}
+
+		template <typename FN>
+		void _for_each_job(FN const &fn)
+		{
+			_slots.for_each([&] (Slot &slot) {
+				if (slot.job.constructed())
+					fn(*slot.job);
+			});
+		}
+
+		bool _sync_in_flight()
+		{
+			bool result = false;
+			_for_each_job([&] (Job const &job) {
+				result |= job.request.operation.type
+				          == Block::Operation::Type::SYNC; });
+			return result;
+		}
+
+		bool _idle()
+		{
+			bool result = true;
+			_for_each_job([&] (Job const &) { result = false; });
+			return result;
+		}
+
+		/*
+		 * Return true if the request must not be executed concurrently
+		 * to a pending job because one of both modifies the same blocks
+		 */
+		bool _conflicts(Block::Operation const &op)
+		{
+			using Type = Block::Operation::Type;
+
+			bool result = false;
+			_for_each_job([&] (Job const &job) {
+
+				Block::Operation const &other = job.request.operation;
+
+				if (op.type != Type::WRITE && other.type != Type::WRITE)
+					return;
+
+				Block::block_number_t const first = other.block_number;
+				Block::block_number_t const last  = first + job.block_count;
+
+				if (op.block_number < last && first < op.block_number + op.count)
+					result = true;
+			});
+			return result;
+		}
+
 	public:
 
 		File(Genode::Allocator         &alloc,
@@ -102,8 +181,8 @@ class Vfs_block::File
 		     Signal_context_capability  sigh,
 		     File_info           const &info)
 		:
-			_vfs        { vfs },
-			_vfs_handle { nullptr }
+			_alloc { alloc },
+			_vfs   { vfs }
 		{
 			using DS = Vfs::Directory_service;
 
@@ -112,18 +191,27 @@ class Vfs_block::File
 				               : DS::OPEN_MODE_RDONLY;
 
 			using Open_result = DS::Open_result;
-			Open_result res = _vfs.open(info.path.string(), mode,
-			                            &_vfs_handle, alloc);
-			if (res != Open_result::OPEN_OK) {
-				error("Could not open '", info.path.string(), "'");
-				throw Genode::Exception();
+			for (unsigned i = 0; i < info.queue_depth; i++) {
+
+				Vfs::Vfs_handle *handle = nullptr;
+
+				Open_result res = _vfs.open(info.path.string(), mode,
+				                            &handle, alloc);
+				if (res != Open_result::OPEN_OK) {
+					error("Could not open '", info.path.string(), "'");
+					_close_all();
+					throw Genode::Exception();
+				}
+
+				handle->handler(&_io_response_handler);
+				new (_alloc) Registered<Slot>(_slots, *handle);
 			}
 
 			using Stat_result = DS::Stat_result;
 			Vfs::Directory_service::Stat stat { };
 			Stat_result stat_res = _vfs.stat(info.path.string(), stat);
 			if (stat_res != Stat_result::STAT_OK) {
-				_vfs.close(_vfs_handle);
+				_close_all();
 				error("Could not stat '", info.path.string(), "'");
 				throw Genode::Exception();
 			}
@@ -139,7 +227,6 @@ class Vfs_block::File
 			};
 
 			_io_response_handler.sigh = sigh;
-			_vfs_handle->handler(&_io_response_handler);
 		}
 
 		~File()
@@ -148,23 +235,18 @@ class Vfs_block::File
 			 * Sync is expected to be done through the Block
 			 * request stream, omit it here.
 			 */
-			_vfs.close(_vfs_handle);
+			_close_all();
 		}
 
 		Block::Session::Info block_info() const { return _block_info; }
 
 		bool execute()
 		{
-			if (!_job.constructed()) {
-				return false;
-			}
+			bool progress = false;
+			_for_each_job([&] (Job &job) {
+				progress |= job.execute(); });
 
-			return _job->execute();
-		}
-
-		bool acceptable() const
-		{
-			return !_job.constructed();
+			return progress;
 		}
 
 		bool valid(Block::Request const &request)
@@ -190,28 +272,75 @@ class Vfs_block::File
 			}
 		}
 
-		void submit(Block::Request req, void *ptr, size_t length)
+		/**
+		 * Submit request
+		 *
+		 * The request is either appended to a not yet started job that
+		 * ends right where the request begins or it occupies a free slot.
+		 *
+		 * \return  false if the request cannot be accepted at the moment
+		 */
+		bool submit(Block::Request req, void *ptr, size_t length)
 		{
+			/* a sync covers all requests acknowledged before */
+			if (req.operation.type == Block::Operation::Type::SYNC) {
+				if (!_idle())
+					return false;
+			} else if (_sync_in_flight() || _conflicts(req.operation)) {
+				return false;
+			}
+
+			char * const data = reinterpret_cast<char*>(ptr);
+
+			bool merged = false;
+			_for_each_job([&] (Job &job) {
+				if (!merged && job.mergeable(req, data, length)) {
+					job.merge(req, length);
+					merged = true;
+				}
+			});
+			if (merged)
+				return true;
+
 			file_offset const base_offset =
 				req.operation.block_number * _block_info.block_size;
 
-			_job.construct(*_vfs_handle, req, base_offset,
-			               reinterpret_cast<char*>(ptr), length);
+			bool submitted = false;
+			_slots.for_each([&] (Slot &slot) {
+				if (submitted || slot.job.constructed())
+					return;
+
+				slot.job.construct(slot.handle, req, base_offset,
+				                   data, length);
+				submitted = true;
+			});
+
+			return submitted;
 		}
 
+		/**
+		 * Call 'fn' with the next request of a completed job
+		 *
+		 * The requests coalesced into one job are handed out one by
+		 * one, the slot is freed after the last one.
+		 */
 		template <typename FN>
 		void with_any_completed_job(FN const &fn)
 		{
-			if (!_job.constructed() || !_job->completed()) {
-				return;
-			}
+			bool found = false;
+			_slots.for_each([&] (Slot &slot) {
+
+				if (found || !slot.job.constructed() || !slot.job->completed())
+					return;
 
-			Block::Request req = _job->request;
-			req.success = _job->succeeded();
+				Block::Request const req = slot.job->next_ack();
 
-			_job.destruct();
+				if (slot.job->acknowledged())
+					slot.job.destruct();
 
-			fn(req);
+				found = true;
+				fn(req);
+			});
 		}
 };
 
@@ -257,10 +386,6 @@ struct Block_session_component : Rpc_object<Block::Session>,
 
 				using Response = Block::Request_stream::Response;
 
-				if (!_file.acceptable()) {
-					return Response::RETRY;
-				}
-
 				if (!_file.valid(request)) {
 					return Response::REJECTED;
 				}
@@ -269,21 +394,24 @@ struct Block_session_component : Rpc_object<Block::Session>,
 				bool const payload =
 					Op::has_payload(request.operation.type);
 
+				Response response = Response::REJECTED;
+
+				auto submit = [&] (void *ptr, size_t size) {
+					response = _file.submit(request, ptr, size)
+					         ? Response::ACCEPTED : Response::RETRY; };
+
 				try {
 					if (payload) {
-						with_content(request,
-						[&] (void *ptr, size_t size) {
-							_file.submit(request, ptr, size);
-						});
+						with_content(request, submit);
 					} else {
-						_file.submit(request, nullptr, 0);
+						submit(nullptr, 0);
 					}
 				} catch (Vfs_block::Job::Unsupported_Operation) {
 					return Response::REJECTED;
 				}
 
-				progress |= true;
-				return Response::ACCEPTED;
+				progress |= (response == Response::ACCEPTED);
+				return response;
 			});
 
 			progress |= _file.execute();
@@ -21,6 +21,12 @@ namespace Vfs_block {
 
 	struct Job
 	{
+		/*
+		 * Upper bounds for coalescing adjacent requests into one VFS
+		 * operation
+		 */
+		enum { MAX_REQUESTS = 64, MAX_MERGE_SIZE = 1u << 20 };
+
 		struct Unsupported_Operation : Genode::Exception { };
 		struct Invalid_state         : Genode::Exception { };
 
@@ -53,6 +59,13 @@ namespace Vfs_block {
 		Vfs::Vfs_handle &_handle;
 
 		Block::Request const request;
+
+		/* requests covered by the job, the first one is 'request' */
+		Block::Request       requests[MAX_REQUESTS];
+		unsigned             num_requests;
+		unsigned             acked;
+		Block::block_count_t block_count;
+
 		char              *data;
 		State              state;
 		file_offset const  base_offset;
@@ -255,6 +268,10 @@ namespace Vfs_block {
 		:
 			_handle        { handle },
 			request        { request },
+			requests       { },
+			num_requests   { 1 },
+			acked          { 0 },
+			block_count    { request.operation.count },
 			data           { data },
 			state          { _initial_state(request.operation.type) },
 			base_offset    { base_offset },
@@ -262,14 +279,58 @@ namespace Vfs_block {
 			current_count  { length },
 			success        { false },
 			complete       { false }
-		{ }
+		{
+			requests[0] = request;
+		}
 
 		bool completed() const { return complete; }
 		bool succeeded()   const { return success; }
 
+		/**
+		 * Return true if 'req' with payload at 'ptr' directly follows the
+		 * job on disk as well as in the packet-stream buffer
+		 */
+		bool mergeable(Block::Request const &req, char const *ptr,
+		               file_size length) const
+		{
+			using Type = Block::Operation::Type;
+
+			Type const type = request.operation.type;
+
+			return (type == Type::READ || type == Type::WRITE)
+			    && req.operation.type == type
+			    && state == State::PENDING && current_offset == 0
+			    && num_requests < MAX_REQUESTS
+			    && current_count + length <= MAX_MERGE_SIZE
+			    && req.operation.block_number
+			       == request.operation.block_number + block_count
+			    && ptr == data + current_count;
+		}
+
+		void merge(Block::Request const &req, file_size length)
+		{
+			requests[num_requests++] = req;
+			block_count   += req.operation.count;
+			current_count += length;
+		}
+
+		bool acknowledged() const { return acked == num_requests; }
+
+		/**
+		 * Return next request of a completed job to be acknowledged
+		 */
+		Block::Request next_ack()
+		{
+			Block::Request req = requests[acked];
+			req.success = success;
+			acked++;
+			return req;
+		}
+
 		void print(Genode::Output &out) const
 		{
 			Genode::print(out, "(", request.operation, ")",
+				" requests: ",       num_requests,
 				" state: ",          _state_to_string(state),
 				" base_offset: ",    base_offset,
 				" current_offset: ", current_offset,
@@ -0,0 +1,164 @@
+/*
+ * \brief  Test for the buddy allocator for packet streams
+ * \author Stefan Kalkowski
+ * \date   2022-08-03
+ *
+ * The test checks the splitting of chunks on allocation, the merging of
+ * buddies on release, and the accounting of free blocks of a fragmented
+ * buffer. The allocator does not touch the buffer it manages, so the test
+ * works with a fictive buffer address.
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <os/buddy_packet_allocator.h>
+
+using namespace Genode;
+
+
+struct Main
+{
+	enum { BLOCK_SIZE = 64, BASE = 0x100000, MAX_PACKETS = 100 };
+
+	Env &env;
+
+	Heap heap { env.ram(), env.rm() };
+
+	unsigned errors { 0 };
+
+	void _check(bool condition, char const *what)
+	{
+		if (condition)
+			return;
+
+		error("check failed: ", what);
+		errors++;
+	}
+
+	static addr_t _alloc(Range_allocator &alloc, size_t size)
+	{
+		return alloc.try_alloc(size).convert<addr_t>(
+			[&] (void *ptr)              { return (addr_t)ptr; },
+			[&] (Allocator::Alloc_error) { return (addr_t)0; });
+	}
+
+	static void _free(Range_allocator &alloc, addr_t addr, size_t size)
+	{
+		alloc.free((void *)addr, size);
+	}
+
+	void _test_split_and_merge()
+	{
+		log("split and merge");
+
+		Buddy_packet_allocator alloc(&heap, BLOCK_SIZE);
+		_check(alloc.add_range(BASE, 64*BLOCK_SIZE).ok(), "add range");
+		_check(alloc.avail() == 64*BLOCK_SIZE, "buffer free initially");
+
+		_check( alloc.valid_addr(BASE),                    "first byte valid");
+		_check( alloc.valid_addr(BASE + 64*BLOCK_SIZE - 1), "last byte valid");
+		_check(!alloc.valid_addr(BASE + 64*BLOCK_SIZE),     "end invalid");
+		_check(!alloc.valid_addr(BASE - 1),                 "below base invalid");
+
+		/* the unused tail of a split chunk is free again */
+		addr_t const three = _alloc(alloc, 3*BLOCK_SIZE);
+		_check(three == BASE, "3-block packet at base");
+		_check(alloc.avail() == 61*BLOCK_SIZE, "tail of split chunk free");
+
+		addr_t const one = _alloc(alloc, BLOCK_SIZE);
+		_check(one == BASE + 3*BLOCK_SIZE, "1-block packet from tail");
+
+		/* releasing both restores the whole buffer as one chunk */
+		_free(alloc, three, 3*BLOCK_SIZE);
+		_free(alloc, one,   BLOCK_SIZE);
+		_check(alloc.avail() == 64*BLOCK_SIZE, "buffer free after release");
+		_check(_alloc(alloc, 64*BLOCK_SIZE) == BASE, "buffer merged");
+		_check(_alloc(alloc, 1) == 0, "buffer exhausted");
+
+		_check(alloc.remove_range(BASE, 64*BLOCK_SIZE).ok(), "remove range");
+	}
+
+	void _test_fragmentation()
+	{
+		log("fragmentation");
+
+		Buddy_packet_allocator alloc(&heap, BLOCK_SIZE);
+		_check(alloc.add_range(BASE, 64*BLOCK_SIZE).ok(), "add range");
+
+		addr_t packets[64];
+		for (unsigned i = 0; i < 64; i++) {
+			packets[i] = _alloc(alloc, BLOCK_SIZE);
+			_check(packets[i] != 0, "1-block packet");
+		}
+		_check(_alloc(alloc, 1) == 0,  "buffer exhausted");
+		_check(alloc.avail() == 0,     "no block free");
+
+		/* every second block free, no two adjacent */
+		for (unsigned i = 0; i < 64; i += 2)
+			_free(alloc, packets[i], BLOCK_SIZE);
+
+		_check(alloc.avail() == 32*BLOCK_SIZE, "half of the blocks free");
+		_check(_alloc(alloc, 2*BLOCK_SIZE) == 0, "no 2-block chunk left");
+
+		for (unsigned i = 1; i < 64; i += 2)
+			_free(alloc, packets[i], BLOCK_SIZE);
+
+		_check(alloc.avail() == 64*BLOCK_SIZE, "buffer free after release");
+		_check(_alloc(alloc, 64*BLOCK_SIZE) == BASE, "buffer merged");
+	}
+
+	void _test_odd_buffer_size()
+	{
+		log("buffer of 100 blocks");
+
+		Buddy_packet_allocator alloc(&heap, BLOCK_SIZE);
+
+		/* the remainder of a partial block remains unused */
+		_check(alloc.add_range(BASE, MAX_PACKETS*BLOCK_SIZE + 10).ok(), "add range");
+		_check(alloc.avail() == MAX_PACKETS*BLOCK_SIZE, "all blocks free");
+
+		addr_t packets[MAX_PACKETS];
+		for (unsigned i = 0; i < MAX_PACKETS; i++) {
+			packets[i] = _alloc(alloc, 1);
+			_check(packets[i] != 0, "1-byte packet");
+		}
+		_check(_alloc(alloc, 1) == 0, "buffer exhausted");
+
+		for (unsigned i = MAX_PACKETS; i > 0; i--)
+			_free(alloc, packets[i - 1], 1);
+
+		_check(_alloc(alloc, 64*BLOCK_SIZE) == BASE,                 "64-block chunk");
+		_check(_alloc(alloc, 32*BLOCK_SIZE) == BASE + 64*BLOCK_SIZE, "32-block chunk");
+		_check(_alloc(alloc,  4*BLOCK_SIZE) == BASE + 96*BLOCK_SIZE, "4-block chunk");
+		_check(alloc.avail() == 0, "no block free");
+	}
+
+	Main(Env &env) : env(env)
+	{
+		log("--- buddy packet allocator test started ---");
+
+		_test_split_and_merge();
+		_test_fragmentation();
+		_test_odd_buffer_size();
+
+		if (errors) {
+			error("--- buddy packet allocator test failed ---");
+			env.parent().exit(-1);
+			return;
+		}
+
+		log("--- buddy packet allocator test finished ---");
+		env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
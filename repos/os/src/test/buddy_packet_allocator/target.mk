@@ -0,0 +1,3 @@
+TARGET = test-buddy_packet_allocator
+SRC_CC = main.cc
+LIBS   = base
@@ -0,0 +1,269 @@
+/*
+ * \brief  Test for the checksum verification of the NIC router
+ * \author Martin Stein
+ * \date   2022-08-09
+ *
+ * The test connects to the NIC router with two sessions that belong to
+ * different domains. Via the sender session, it passes three UDP packets to
+ * the router that are routed to the receiver session by an IP rule. The
+ * second packet has a corrupted IPv4 checksum. With checksum verification
+ * enabled, the router must drop it and forward the other two packets.
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <net/arp.h>
+#include <net/ethernet.h>
+#include <net/ipv4.h>
+#include <net/udp.h>
+#include <nic/packet_allocator.h>
+#include <nic_session/connection.h>
+
+namespace Test {
+
+	using namespace Net;
+	using namespace Genode;
+
+	struct Nic_client;
+	struct Main;
+}
+
+
+struct Test::Nic_client : Noncopyable
+{
+	struct Handler : Interface
+	{
+		virtual void handle_eth(Nic_client &, Ethernet_frame &, Size_guard &) = 0;
+	};
+
+	enum { BUF_SIZE = 100 * ::Nic::Packet_allocator::DEFAULT_PACKET_SIZE };
+
+	Env &env;
+
+	Handler &handler;
+
+	::Nic::Packet_allocator pkt_alloc;
+	::Nic::Connection       nic;
+
+	Mac_address const mac { nic.mac_address() };
+
+	void _handle_signal()
+	{
+		while (nic.tx()->ack_avail())
+			nic.tx()->release_packet(nic.tx()->get_acked_packet());
+
+		while (nic.rx()->packet_avail() && nic.rx()->ready_to_ack()) {
+
+			::Nic::Packet_descriptor const pkt = nic.rx()->get_packet();
+
+			Size_guard size_guard(pkt.size());
+			try {
+				handler.handle_eth(*this, Ethernet_frame::cast_from(
+					nic.rx()->packet_content(pkt), size_guard), size_guard);
+			}
+			catch (Size_guard::Exceeded) { }
+
+			nic.rx()->acknowledge_packet(pkt);
+		}
+	}
+
+	Signal_handler<Nic_client> signal_handler {
+		env.ep(), *this, &Nic_client::_handle_signal };
+
+	template <typename FN>
+	void send(size_t size, FN const &fn)
+	{
+		::Nic::Packet_descriptor const pkt = nic.tx()->alloc_packet(size);
+
+		Size_guard size_guard(size);
+		fn(Ethernet_frame::construct_at(nic.tx()->packet_content(pkt), size_guard),
+		   size_guard);
+
+		nic.tx()->submit_packet(pkt);
+	}
+
+	Nic_client(Env &env, Allocator &alloc, Handler &handler, char const *label)
+	:
+		env(env), handler(handler), pkt_alloc(&alloc),
+		nic(env, &pkt_alloc, BUF_SIZE, BUF_SIZE, label)
+	{
+		nic.rx_channel()->sigh_ready_to_ack(signal_handler);
+		nic.rx_channel()->sigh_packet_avail(signal_handler);
+		nic.tx_channel()->sigh_ack_avail(signal_handler);
+		nic.tx_channel()->sigh_ready_to_submit(signal_handler);
+	}
+};
+
+
+struct Test::Main : Nic_client::Handler
+{
+	enum { PORT = 50000 };
+
+	enum Packet_id : uint8_t { FIRST = 1, CORRUPTED = 2, LAST = 3 };
+
+	Env &env;
+
+	Heap heap { env.ram(), env.rm() };
+
+	Ipv4_address const router_ip   { Ipv4_packet::ip_from_string("10.0.1.1") };
+	Ipv4_address const sender_ip   { Ipv4_packet::ip_from_string("10.0.1.2") };
+	Ipv4_address const receiver_ip { Ipv4_packet::ip_from_string("10.0.2.2") };
+
+	Nic_client sender   { env, heap, *this, "sender" };
+	Nic_client receiver { env, heap, *this, "receiver" };
+
+	bool first_received { false };
+
+	void _exit(int code)
+	{
+		if (code)
+			error("--- nic_router checksum test failed ---");
+		else
+			log("--- nic_router checksum test finished ---");
+
+		env.parent().exit(code);
+	}
+
+	void _request_router_mac()
+	{
+		sender.send(sizeof(Ethernet_frame) + sizeof(Arp_packet),
+		            [&] (Ethernet_frame &eth, Size_guard &size_guard)
+		{
+			eth.dst(Ethernet_frame::broadcast());
+			eth.src(sender.mac);
+			eth.type(Ethernet_frame::Type::ARP);
+
+			Arp_packet &arp = eth.construct_at_data<Arp_packet>(size_guard);
+			arp.hardware_address_type(Arp_packet::ETHERNET);
+			arp.protocol_address_type(Arp_packet::IPV4);
+			arp.hardware_address_size(sizeof(Mac_address));
+			arp.protocol_address_size(sizeof(Ipv4_address));
+			arp.opcode(Arp_packet::REQUEST);
+			arp.src_mac(sender.mac);
+			arp.src_ip(sender_ip);
+			arp.dst_mac(Ethernet_frame::broadcast());
+			arp.dst_ip(router_ip);
+		});
+	}
+
+	void _send_udp(Mac_address const &router_mac, Packet_id id)
+	{
+		enum { SIZE = sizeof(Ethernet_frame) + sizeof(Ipv4_packet) +
+		              sizeof(Udp_packet) + sizeof(uint8_t) };
+
+		sender.send(SIZE, [&] (Ethernet_frame &eth, Size_guard &size_guard)
+		{
+			eth.dst(router_mac);
+			eth.src(sender.mac);
+			eth.type(Ethernet_frame::Type::IPV4);
+
+			size_t const ip_off = size_guard.head_size();
+			Ipv4_packet &ip = eth.construct_at_data<Ipv4_packet>(size_guard);
+			ip.header_length(sizeof(Ipv4_packet) / 4);
+			ip.version(4);
+			ip.time_to_live(64);
+			ip.protocol(Ipv4_packet::Protocol::UDP);
+			ip.src(sender_ip);
+			ip.dst(receiver_ip);
+
+			size_t const udp_off = size_guard.head_size();
+			Udp_packet &udp = ip.construct_at_data<Udp_packet>(size_guard);
+			udp.src_port(Port(PORT));
+			udp.dst_port(Port(PORT));
+			uint8_t const payload = id;
+			udp.memcpy_to_data(&payload, sizeof(payload), size_guard);
+			udp.length((uint16_t)(size_guard.head_size() - udp_off));
+			udp.update_checksum(ip.src(), ip.dst());
+
+			ip.total_length(size_guard.head_size() - ip_off);
+			ip.update_checksum();
+
+			if (id == CORRUPTED)
+				ip.checksum((uint16_t)(ip.checksum() + 1));
+		});
+	}
+
+	void _handle_sender_eth(Ethernet_frame &eth, Size_guard &size_guard)
+	{
+		if (eth.type() != Ethernet_frame::Type::ARP)
+			return;
+
+		Arp_packet &arp = eth.data<Arp_packet>(size_guard);
+		if (arp.opcode() != Arp_packet::REPLY || arp.src_ip() != router_ip)
+			return;
+
+		_send_udp(arp.src_mac(), FIRST);
+		_send_udp(arp.src_mac(), CORRUPTED);
+		_send_udp(arp.src_mac(), LAST);
+	}
+
+	void _handle_receiver_eth(Ethernet_frame &eth, Size_guard &size_guard)
+	{
+		if (eth.type() != Ethernet_frame::Type::IPV4)
+			return;
+
+		Ipv4_packet &ip = eth.data<Ipv4_packet>(size_guard);
+		if (ip.protocol() != Ipv4_packet::Protocol::UDP || ip.dst() != receiver_ip)
+			return;
+
+		Udp_packet &udp = ip.data<Udp_packet>(size_guard);
+		if (udp.dst_port().value != PORT)
+			return;
+
+		uint8_t const id = udp.data<uint8_t>(size_guard);
+
+		log("received packet ", id);
+
+		if (ip.checksum_error()) {
+			error("forwarded packet ", id, " has a bad IPv4 checksum");
+			_exit(-1);
+			return;
+		}
+
+		switch (id) {
+		case FIRST:
+			first_received = true;
+			return;
+
+		case CORRUPTED:
+			error("packet with bad IPv4 checksum was forwarded");
+			_exit(-1);
+			return;
+
+		case LAST:
+			if (!first_received) {
+				error("valid packet was not forwarded");
+				_exit(-1);
+				return;
+			}
+			_exit(0);
+			return;
+		}
+	}
+
+	void handle_eth(Nic_client &nic, Ethernet_frame &eth, Size_guard &size_guard) override
+	{
+		if (&nic == &sender)
+			_handle_sender_eth(eth, size_guard);
+		else
+			_handle_receiver_eth(eth, size_guard);
+	}
+
+	Main(Env &env) : env(env)
+	{
+		log("--- nic_router checksum test started ---");
+
+		_request_router_mac();
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
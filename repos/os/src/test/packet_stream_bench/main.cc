@@ -0,0 +1,537 @@
+/*
+ * \brief  Throughput and latency benchmark for the packet-stream transport
+ * \author Martin Stein
+ * \date   2022-07-04
+ *
+ * The benchmark connects a packet-stream source and a packet-stream sink
+ * through a shared communication buffer. The source is driven by the
+ * initial entrypoint, the sink by an entrypoint of its own. Hence, the
+ * measured costs comprise the queues, the signalling, and the bulk-buffer
+ * management but no session-specific request processing. The packet
+ * streams are instantiated with the policies of the NIC, block, and
+ * file-system sessions.
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/allocator_avl.h>
+#include <base/attached_rom_dataspace.h>
+#include <os/reporter.h>
+#include <timer_session/connection.h>
+#include <nic_session/nic_session.h>
+#include <block_session/block_session.h>
+#include <file_system_session/file_system_session.h>
+
+namespace Packet_stream_bench {
+
+	using namespace Genode;
+
+	struct Parameters;
+	struct Result;
+	class  Latency_histogram;
+	class  Test_base;
+	template <typename> class Test;
+	class  Main;
+
+	enum { MAX_BATCH = 64 };
+}
+
+
+struct Packet_stream_bench::Parameters
+{
+	using Session = String<16>;
+
+	Session       const session;
+	size_t        const packet_size;
+	unsigned      const depth;
+	unsigned      const batch;
+	unsigned long const packets;
+	unsigned      const poll_spins;
+	bool          const touch;
+
+	Parameters(Xml_node const &node)
+	:
+		session     { node.attribute_value("session",     Session("nic")) },
+		packet_size { max(node.attribute_value("packet_size", (size_t)1500),
+		                  sizeof(uint64_t)) },
+		depth       { max(node.attribute_value("depth",       64U), 1U) },
+		batch       { min(max(node.attribute_value("batch",   1U), 1U),
+		                  (unsigned)MAX_BATCH) },
+		packets     { max(node.attribute_value("packets", 100000UL), 1UL) },
+		poll_spins  { node.attribute_value("poll_spins",  0U) },
+		touch       { node.attribute_value("touch",       true) }
+	{ }
+};
+
+
+struct Packet_stream_bench::Result
+{
+	Parameters::Session session        { };
+	size_t              packet_size    { 0 };
+	unsigned            depth          { 0 };
+	unsigned            batch          { 0 };
+	unsigned            poll_spins     { 0 };
+	unsigned long       packets        { 0 };
+	uint64_t            duration_us    { 0 };
+	uint64_t            packets_per_s  { 0 };
+	uint64_t            mb_per_s       { 0 };
+	uint64_t            rtt_p50_us     { 0 };
+	uint64_t            rtt_p99_us     { 0 };
+	unsigned long       source_signals { 0 };
+	unsigned long       sink_signals   { 0 };
+
+	void generate(Xml_generator &xml) const
+	{
+		xml.node("result", [&] () {
+			xml.attribute("session",        session);
+			xml.attribute("packet_size",    packet_size);
+			xml.attribute("depth",          depth);
+			xml.attribute("batch",          batch);
+			xml.attribute("poll_spins",     poll_spins);
+			xml.attribute("packets",        packets);
+			xml.attribute("duration_us",    duration_us);
+			xml.attribute("packets_per_s",  packets_per_s);
+			xml.attribute("mb_per_s",       mb_per_s);
+			xml.attribute("rtt_p50_us",     rtt_p50_us);
+			xml.attribute("rtt_p99_us",     rtt_p99_us);
+			xml.attribute("source_signals", source_signals);
+			xml.attribute("sink_signals",   sink_signals);
+		});
+	}
+
+	void print(Output &output) const
+	{
+		Genode::print(output, "session=",        session,
+		                      " packet_size=",    packet_size,
+		                      " depth=",          depth,
+		                      " batch=",          batch,
+		                      " poll_spins=",     poll_spins,
+		                      " packets=",        packets,
+		                      " duration_us=",    duration_us,
+		                      " packets_per_s=",  packets_per_s,
+		                      " mb_per_s=",       mb_per_s,
+		                      " rtt_p50_us=",     rtt_p50_us,
+		                      " rtt_p99_us=",     rtt_p99_us,
+		                      " source_signals=", source_signals,
+		                      " sink_signals=",   sink_signals);
+	}
+};
+
+
+/**
+ * Round-trip latencies in steps of one microsecond
+ *
+ * A fixed histogram keeps the memory footprint independent of the number of
+ * packets. Latencies beyond the last bucket are accounted to the last bucket.
+ */
+class Packet_stream_bench::Latency_histogram
+{
+	private:
+
+		enum { MAX_US = 8191 };
+
+		unsigned long _buckets[MAX_US + 1] { };
+		unsigned long _samples             { 0 };
+
+	public:
+
+		void record(uint64_t us, unsigned long count)
+		{
+			_buckets[min(us, (uint64_t)MAX_US)] += count;
+			_samples += count;
+		}
+
+		uint64_t percentile(unsigned percent) const
+		{
+			unsigned long const target  { (_samples * percent + 99) / 100 };
+			unsigned long       samples { 0 };
+			for (uint64_t us = 0; us <= MAX_US; us++) {
+				samples += _buckets[us];
+				if (samples >= target && samples) {
+					return us; }
+			}
+			return MAX_US;
+		}
+};
+
+
+class Packet_stream_bench::Test_base : Noncopyable
+{
+	public:
+
+		virtual ~Test_base() { }
+
+		/**
+		 * Submit the initial packets
+		 */
+		virtual void start() = 0;
+
+		/**
+		 * Process acknowledgements and submit packets, called by the source
+		 */
+		virtual void handle_source() = 0;
+
+		/**
+		 * Acknowledge submitted packets, called by the sink
+		 */
+		virtual void handle_sink() = 0;
+
+		virtual bool done() const = 0;
+
+		virtual Result result() const = 0;
+};
+
+
+template <typename POLICY>
+class Packet_stream_bench::Test : public Test_base
+{
+	private:
+
+		using Source            = Packet_stream_source<POLICY>;
+		using Sink              = Packet_stream_sink<POLICY>;
+		using Packet_descriptor = typename POLICY::Packet_descriptor;
+
+		enum { QUEUE_SIZE = sizeof(typename POLICY::Submit_queue) /
+		                    sizeof(Packet_descriptor) };
+
+		/*
+		 * Dataspace shared by source and sink, which must outlive both
+		 */
+		struct Buffer : Genode::Noncopyable
+		{
+			Ram_allocator                  &ram;
+			Ram_dataspace_capability const  ds;
+
+			Buffer(Ram_allocator &ram, size_t size)
+			: ram { ram }, ds { ram.alloc(size) } { }
+
+			~Buffer() { ram.free(ds); }
+		};
+
+		Timer::Connection         &_timer;
+		Parameters          const  _params;
+		unsigned            const  _depth;
+		unsigned            const  _batch;
+		Allocator_avl              _packet_alloc;
+		size_t              const  _ds_size;
+		Buffer                     _buffer;
+		Source                     _source;
+		Sink                       _sink;
+		Latency_histogram          _latency        { };
+		unsigned long              _submitted      { 0 };
+		unsigned long              _acked          { 0 };
+		unsigned long              _source_signals { 0 };
+		unsigned long              _sink_signals   { 0 };
+		uint64_t                   _start_us       { 0 };
+		uint64_t                   _end_us         { 0 };
+		uint64_t                   _checksum       { 0 };
+
+		uint64_t _now_us() { return _timer.curr_time().trunc_to_plain_us().value; }
+
+		size_t _buffer_size() const
+		{
+			/* leave room for the fragmentation of the bulk buffer */
+			return 2 * _depth * align_addr(_params.packet_size, 6);
+		}
+
+		void _submit()
+		{
+			Packet_descriptor pkts[MAX_BATCH];
+			while (_submitted < _params.packets) {
+
+				unsigned long const in_flight { _submitted - _acked };
+				if (in_flight >= _depth) {
+					return; }
+
+				unsigned const count {
+					(unsigned)min(min((unsigned long)_batch, _depth - in_flight),
+					              _params.packets - _submitted) };
+
+				uint64_t const now_us { _now_us() };
+				for (unsigned i = 0; i < count; i++) {
+					pkts[i] = _source.alloc_packet(_params.packet_size);
+					memcpy(_source.packet_content(pkts[i]), &now_us, sizeof(now_us));
+				}
+				unsigned const submitted { _source.submit_packets(pkts, count) };
+				for (unsigned i = submitted; i < count; i++) {
+					_source.release_packet(pkts[i]); }
+
+				_submitted += submitted;
+				if (submitted < count) {
+					return; }
+			}
+		}
+
+		void _touch(Packet_descriptor const &pkt)
+		{
+			uint64_t const *word { (uint64_t const *)_sink.packet_content(pkt) };
+			for (size_t i = 0; i < pkt.size() / sizeof(uint64_t); i++) {
+				_checksum += word[i]; }
+		}
+
+	public:
+
+		Test(Env                       &env,
+		     Allocator                 &alloc,
+		     Timer::Connection         &timer,
+		     Parameters          const &params,
+		     Signal_context_capability  source_sigh,
+		     Signal_context_capability  sink_sigh)
+		:
+			_timer        { timer },
+			_params       { params },
+			_depth        { min(params.depth, (unsigned)QUEUE_SIZE - 1) },
+			_batch        { min(params.batch, _depth) },
+			_packet_alloc { &alloc },
+			_ds_size      { sizeof(typename POLICY::Submit_queue) +
+			                sizeof(typename POLICY::Ack_queue) +
+			                _buffer_size() },
+			_buffer       { env.ram(), _ds_size },
+			_source       { _buffer.ds, env.rm(), _packet_alloc },
+			_sink         { _buffer.ds, env.rm() }
+		{
+			_source.register_sigh_packet_avail(sink_sigh);
+			_source.register_sigh_ready_to_ack(sink_sigh);
+			_sink.register_sigh_ack_avail(source_sigh);
+			_sink.register_sigh_ready_to_submit(source_sigh);
+
+			_source.adaptive_polling(_params.poll_spins);
+			_sink.adaptive_polling(_params.poll_spins);
+		}
+
+
+
+		/***************
+		 ** Test_base **
+		 ***************/
+
+		void start() override
+		{
+			_start_us = _now_us();
+			_submit();
+		}
+
+		void handle_source() override
+		{
+			_source_signals++;
+
+			Packet_descriptor pkts[MAX_BATCH];
+			while (_source.ack_avail() || _source.poll_ack_avail()) {
+
+				unsigned const count { _source.get_acked_packets(pkts, _batch) };
+				uint64_t const now_us { _now_us() };
+				for (unsigned i = 0; i < count; i++) {
+
+					uint64_t sent_us;
+					memcpy(&sent_us, _source.packet_content(pkts[i]), sizeof(sent_us));
+					_latency.record(now_us - sent_us, 1);
+					_source.release_packet(pkts[i]);
+				}
+				_acked += count;
+				_submit();
+
+				if (done()) {
+					_source.stop_polling();
+					_end_us = now_us;
+					break;
+				}
+			}
+		}
+
+		void handle_sink() override
+		{
+			_sink_signals++;
+
+			Packet_descriptor pkts[MAX_BATCH];
+			while (_sink.packet_avail() || _sink.poll_packet_avail()) {
+
+				unsigned const count { _sink.get_packets(pkts, _batch) };
+				if (_params.touch) {
+					for (unsigned i = 0; i < count; i++) {
+						_touch(pkts[i]); } }
+
+				/* the ack queue is as large as the submit queue */
+				if (_sink.acknowledge_packets(pkts, count) != count) {
+					error("failed to acknowledge packets"); }
+			}
+		}
+
+		bool done() const override { return _acked == _params.packets; }
+
+		Result result() const override
+		{
+			Result result { };
+			uint64_t const duration_us { max(_end_us - _start_us, (uint64_t)1) };
+			uint64_t const bytes       { (uint64_t)_acked * _params.packet_size };
+
+			result.session        = _params.session;
+			result.packet_size    = _params.packet_size;
+			result.depth          = _depth;
+			result.batch          = _batch;
+			result.poll_spins     = _params.poll_spins;
+			result.packets        = _acked;
+			result.duration_us    = duration_us;
+			result.packets_per_s  = (uint64_t)_acked * 1000 * 1000 / duration_us;
+			result.mb_per_s       = bytes / duration_us;
+			result.rtt_p50_us     = _latency.percentile(50);
+			result.rtt_p99_us     = _latency.percentile(99);
+			result.source_signals = _source_signals;
+			result.sink_signals   = _sink_signals;
+			return result;
+		}
+};
+
+
+class Packet_stream_bench::Main
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Main(Main const &);
+		Main &operator = (Main const &);
+
+		enum { MAX_RESULTS = 64 };
+		enum { SINK_STACK_SIZE = 4 * 1024 * sizeof(long) };
+
+		Env                               &_env;
+		Attached_rom_dataspace             _config         { _env, "config" };
+		Heap                               _heap           { _env.ram(), _env.rm() };
+		Timer::Connection                  _timer          { _env };
+		Entrypoint                         _sink_ep        { _env, SINK_STACK_SIZE, "sink", Affinity::Location() };
+		Signal_handler<Main>               _source_handler { _env.ep(), *this, &Main::_handle_source };
+		Signal_handler<Main>               _sink_handler   { _sink_ep, *this, &Main::_handle_sink };
+		Mutex                              _sink_mutex     { };
+		Test_base                         *_test           { nullptr };
+		unsigned                           _test_idx       { 0 };
+		Result                             _results[MAX_RESULTS] { };
+		unsigned                           _nr_of_results  { 0 };
+		Constructible<Expanding_reporter>  _reporter       { };
+
+		template <typename POLICY>
+		Test_base &_new_test(Parameters const &params)
+		{
+			return *new (_heap)
+				Test<POLICY>(_env, _heap, _timer, params, _source_handler,
+				             _sink_handler);
+		}
+
+		void _start_next_test();
+
+		void _finish_test();
+
+		void _handle_source();
+
+		/*
+		 * The sink handler runs at the sink entrypoint, which may still be
+		 * busy with the current test when the source completed it.
+		 * Therefore, the test is exchanged only under the sink mutex.
+		 */
+		void _handle_sink()
+		{
+			Mutex::Guard guard { _sink_mutex };
+			if (_test) {
+				_test->handle_sink(); }
+		}
+
+	public:
+
+		Main(Env &env);
+};
+
+
+void Packet_stream_bench::Main::_start_next_test()
+{
+	unsigned idx { 0 };
+	bool     started { false };
+	_config.xml().for_each_sub_node("test", [&] (Xml_node const &node) {
+
+		if (started || idx++ != _test_idx) {
+			return; }
+
+		started = true;
+		Parameters const params { node };
+		Test_base *test { nullptr };
+		if (params.session == "nic") {
+			test = &_new_test<Nic::Session::Policy>(params);
+		} else if (params.session == "block") {
+			test = &_new_test<Block::Session::Tx_policy>(params);
+		} else if (params.session == "fs") {
+			test = &_new_test<File_system::Session::Tx_policy>(params);
+		} else {
+			error("unknown session type \"", params.session, "\"");
+			_test_idx++;
+			started = false;
+			return;
+		}
+		{
+			Mutex::Guard guard { _sink_mutex };
+			_test = test;
+		}
+		_test->start();
+	});
+	if (started) {
+		return; }
+
+	if (_reporter.constructed()) {
+		_reporter->generate([&] (Xml_generator &xml) {
+			for (unsigned i = 0; i < _nr_of_results; i++) {
+				_results[i].generate(xml); }
+		});
+	}
+	log("--- packet-stream benchmark finished ---");
+	_env.parent().exit(0);
+}
+
+
+void Packet_stream_bench::Main::_finish_test()
+{
+	Result const result { _test->result() };
+	log("result: ", result);
+	if (_nr_of_results < MAX_RESULTS) {
+		_results[_nr_of_results++] = result; }
+
+	{
+		Mutex::Guard guard { _sink_mutex };
+		destroy(_heap, _test);
+		_test = nullptr;
+	}
+	_test_idx++;
+	_start_next_test();
+}
+
+
+void Packet_stream_bench::Main::_handle_source()
+{
+	if (!_test) {
+		return; }
+
+	_test->handle_source();
+	if (_test->done()) {
+		_finish_test(); }
+}
+
+
+Packet_stream_bench::Main::Main(Env &env) : _env { env }
+{
+	if (_config.xml().attribute_value("report", false)) {
+		_reporter.construct(_env, "results", "results"); }
+
+	log("--- packet-stream benchmark started ---");
+	_start_next_test();
+}
+
+
+void Component::construct(Genode::Env &env)
+{
+	static Packet_stream_bench::Main main { env };
+}
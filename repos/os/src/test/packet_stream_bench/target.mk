@@ -0,0 +1,4 @@
+TARGET     = test-packet_stream_bench
+SRC_CC     = main.cc
+LIBS       = base
+CONFIG_XSD = config.xsd
@@ -0,0 +1,180 @@
+/*
+ * \brief  Test for the sharing of payload between packet-stream buffers
+ * \author Stefan Kalkowski
+ * \date   2022-08-08
+ *
+ * The test composes client buffers from windows of a peer buffer and checks
+ * that payload written via the client buffer appears at the translated
+ * offset in the peer buffer and vice versa, that the windows of different
+ * clients are disjoint, and that windows are freed at the peer's packet
+ * allocator on destruction unless they are retained.
+ */
+
+/*
+ * Copyright (C) 2022 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_dataspace.h>
+#include <base/attached_ram_dataspace.h>
+#include <base/allocator_avl.h>
+#include <base/component.h>
+#include <base/heap.h>
+#include <os/packet_stream_window.h>
+
+using namespace Genode;
+
+
+struct Main
+{
+	enum { PAGE = 4096, QUEUES = PAGE, PEER_SIZE = 64*PAGE, CLIENT_SIZE = 16*PAGE };
+
+	Env &env;
+
+	Heap heap { env.ram(), env.rm() };
+
+	unsigned errors { 0 };
+
+	/* buffer of the peer stream, the first page holds its queues */
+	Attached_ram_dataspace peer_ds    { env.ram(), env.rm(), PEER_SIZE };
+	Allocator_avl          peer_alloc { &heap };
+
+	void _check(bool condition, char const *what)
+	{
+		if (condition)
+			return;
+
+		error("check failed: ", what);
+		errors++;
+	}
+
+	char *_peer(off_t offset) { return peer_ds.local_addr<char>() + offset; }
+
+	static char _pattern(unsigned client, size_t i) {
+		return (char)(client*31 + i*7 + 1); }
+
+	void _test_shared_payload()
+	{
+		log("shared payload");
+
+		size_t const avail = peer_alloc.avail();
+
+		Packet_stream_window window_1(env, peer_alloc, peer_ds.cap(),
+		                              CLIENT_SIZE, QUEUES, 12);
+		Packet_stream_window window_2(env, peer_alloc, peer_ds.cap(),
+		                              CLIENT_SIZE, QUEUES, 12);
+
+		_check(peer_alloc.avail() == avail - 2*(CLIENT_SIZE - QUEUES),
+		       "windows allocated at peer");
+
+		_check(!window_1.contains(0, 1),                         "queues not shared");
+		_check(!window_1.contains(QUEUES - 1, 2),                "queues not shared");
+		_check( window_1.contains(QUEUES, CLIENT_SIZE - QUEUES), "payload shared");
+		_check(!window_1.contains(QUEUES, CLIENT_SIZE),          "end of buffer");
+		_check(!window_1.contains(CLIENT_SIZE, 0),               "end of buffer");
+
+		off_t const first = QUEUES, last = CLIENT_SIZE - 1;
+
+		_check(window_1.peer_offset(first) >= QUEUES
+		    && window_1.peer_offset(last)  <  PEER_SIZE, "window within peer buffer");
+		_check(window_1.peer_offset(last)  < window_2.peer_offset(first)
+		    || window_2.peer_offset(last)  < window_1.peer_offset(first),
+		       "windows disjoint");
+
+		Attached_dataspace client_1(env.rm(), window_1.dataspace());
+		Attached_dataspace client_2(env.rm(), window_2.dataspace());
+
+		/* client to peer */
+		for (size_t i = QUEUES; i < CLIENT_SIZE; i++) {
+			client_1.local_addr<char>()[i] = _pattern(1, i);
+			client_2.local_addr<char>()[i] = _pattern(2, i);
+		}
+
+		bool equal = true;
+		for (size_t i = QUEUES; i < CLIENT_SIZE; i++) {
+			equal &= (*_peer(window_1.peer_offset((off_t)i)) == _pattern(1, i));
+			equal &= (*_peer(window_2.peer_offset((off_t)i)) == _pattern(2, i));
+		}
+		_check(equal, "payload of clients at peer");
+
+		/* peer to client */
+		for (size_t i = QUEUES; i < CLIENT_SIZE; i++)
+			*_peer(window_1.peer_offset((off_t)i)) = _pattern(3, i);
+
+		equal = true;
+		for (size_t i = QUEUES; i < CLIENT_SIZE; i++) {
+			equal &= (client_1.local_addr<char>()[i] == _pattern(3, i));
+			equal &= (client_2.local_addr<char>()[i] == _pattern(2, i));
+		}
+		_check(equal, "payload of peer at client");
+
+		/* the queues are backed by RAM of their own */
+		memset(client_1.local_addr<char>(), 0xff, QUEUES);
+		_check(*_peer(0) == 0, "queues of client separate from peer buffer");
+	}
+
+	void _test_window_lifetime()
+	{
+		log("window lifetime");
+
+		size_t const avail = peer_alloc.avail();
+
+		{
+			Packet_stream_window window(env, peer_alloc, peer_ds.cap(),
+			                            CLIENT_SIZE, QUEUES, 12);
+		}
+		_check(peer_alloc.avail() == avail, "window freed on destruction");
+
+		try {
+			Packet_stream_window window(env, peer_alloc, peer_ds.cap(),
+			                            PEER_SIZE, QUEUES, 12);
+			_check(false, "window larger than peer buffer");
+		}
+		catch (Packet_stream_window::Window_unavailable) { }
+		_check(peer_alloc.avail() == avail, "no window allocated on failure");
+
+		Packet_stream_window::Window retained { 0, 0 };
+		{
+			Packet_stream_window window(env, peer_alloc, peer_ds.cap(),
+			                            CLIENT_SIZE, QUEUES, 12);
+			window.acquire();
+			window.acquire();
+			window.release();
+			_check(window.in_flight() == 1, "packets in flight");
+
+			retained = window.retain();
+		}
+		_check(retained.size == CLIENT_SIZE - QUEUES, "size of retained window");
+		_check(peer_alloc.avail() == avail - retained.size,
+		       "retained window kept allocated");
+
+		retained.free(peer_alloc);
+		_check(peer_alloc.avail() == avail, "retained window freed");
+	}
+
+	Main(Env &env) : env(env)
+	{
+		log("--- packet stream window test started ---");
+
+		memset(peer_ds.local_addr<char>(), 0, PEER_SIZE);
+		peer_alloc.add_range(QUEUES, PEER_SIZE - QUEUES);
+
+		_test_shared_payload();
+		_test_window_lifetime();
+
+		if (errors) {
+			error("--- packet stream window test failed ---");
+			env.parent().exit(-1);
+			return;
+		}
+
+		log("--- packet stream window test finished ---");
+		env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Env &env) { static Main main(env); }
@@ -0,0 +1,3 @@
+TARGET = test-packet_stream_window
+SRC_CC = main.cc
+LIBS   = base
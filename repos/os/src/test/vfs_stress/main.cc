@@ -99,6 +99,8 @@ inline void assert_write(Vfs::File_io_service::Write_result r)
 		error("WRITE_ERR_AGAIN"); break;
 	case Result::WRITE_ERR_WOULD_BLOCK:
 		error("WRITE_ERR_WOULD_BLOCK"); break;
+	case Result::WRITE_QUEUED:
+		error("WRITE_QUEUED"); break;
 	case Result::WRITE_ERR_INVALID:
 		error("WRITE_ERR_INVALID"); break;
 	case Result::WRITE_ERR_IO: